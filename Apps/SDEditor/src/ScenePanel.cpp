@@ -393,14 +393,7 @@ void ScenePanel::DrawComponents(Entity &entity, const TextureCache &textures)
             ImGui::SliderFloat("Quadratic", &light.quadratic, 0.0002f, 0.1f,
                                "%.4f");
 
-            if (ImGui::Checkbox("Cast Shadow", &lightComp.is_cast_shadow)) {
-                if (lightComp.is_cast_shadow) {
-                    lightComp.shadow.CreateShadowMap();
-                }
-                else {
-                    lightComp.shadow.DestroyShadowMap();
-                }
-            }
+            ImGui::Checkbox("Cast Shadow", &lightComp.is_cast_shadow);
             float far_z = lightComp.shadow.GetFarZ();
             if (ImGui::SliderFloat("Shadow Far Z", &far_z, 1.0f, 500.f)) {
                 lightComp.shadow.SetFarZ(far_z);
@@ -7,6 +7,8 @@
 #include "Renderer/SkyboxRenderPass.hpp"
 #include "Renderer/PostProcessRenderPass.hpp"
 #include "Renderer/SpriteRenderPass.hpp"
+#include "Renderer/RenderGraph.hpp"
+#include "Renderer/DynamicResolution.hpp"
 #include "Resource/ResourceManager.hpp"
 #include "ECS/SceneManager.hpp"
 #include "Utility/Timing.hpp"
@@ -22,6 +24,8 @@ class SD_CORE_API GraphicsLayer : public Layer {
     void OnRender() override;
     void OnTick(float dt) override;
 
+    // Cheap to call every frame of a resize, the buffers are reallocated
+    // only when the size outgrows them or once it has settled.
     void SetRenderSize(int32_t width, int32_t height);
     void SetCamera(Camera* camera);
     void SetDebug(bool debug) { m_debug = debug; }
@@ -34,12 +38,21 @@ class SD_CORE_API GraphicsLayer : public Layer {
 
    private:
     void InitBuffers();
+    void ResizeBuffers(int32_t width, int32_t height);
 
     ResourceManager* m_resources;
     SceneManager* m_scenes;
     Device* m_device;
+    // Output size.
     int32_t m_width;
     int32_t m_height;
+    // Size the buffers are allocated at, rounded up from the output size.
+    // While the output is resized they are larger than needed and only
+    // refitted once its size has settled.
+    int32_t m_buffer_width;
+    int32_t m_buffer_height;
+    // Frames since the output was last resized.
+    int32_t m_resize_frames;
     MultiSampleLevel m_msaa;
     bool m_debug;
 
@@ -51,12 +64,21 @@ class SD_CORE_API GraphicsLayer : public Layer {
 
     Ref<Renderbuffer> m_depth_buffer;
 
+    // The frame is drawn at the render size to the bottom left of the
+    // buffers, then upscaled to the output.
+    DynamicResolution m_resolution;
+    int32_t m_render_width;
+    int32_t m_render_height;
+    // Multisampled buffers are resolved before they are upscaled.
+    Ref<Framebuffer> m_resolve_target;
+    Ref<Texture> m_resolve_buffer;
+
     TextureHandle m_light_icon;
 
     Camera* m_camera;
     FPSCounter m_fps;
-    float m_deferred_time;
-    float m_post_rendering_time;
+
+    RenderGraph m_graph;
 };
 
 }  // namespace SD
@@ -31,10 +31,18 @@ struct SD_ECS_API TagComponent {
     SERIALIZE(tag)
 };
 
+// Setting a local value only marks the world transform of the node and of
+// its descendants out of date; a world getter brings it up to date with its
+// ancestors', and Scene::UpdateTransforms updates every node left out of
+// date once per frame. A node out of date only has descendants out of date,
+// so marking stops at them.
 struct SD_ECS_API TransformComponent {
     std::set<EntityId> children;
     EntityId parent;
     entt::registry* ecs{nullptr};
+    // Ancestors of the node, set by Scene::UpdateTransforms to sort the
+    // transforms parent before child.
+    uint32_t depth{0};
 
     TransformComponent();
 
@@ -66,18 +74,22 @@ struct SD_ECS_API TransformComponent {
     Vector3f GetWorldUp() const;
     Vector3f GetWorldFront() const;
 
-    void UpdateGlobalPosition();
-    void UpdateGlobalRotation();
-    void UpdateGlobalScale();
+    void MarkDirty();
+    bool IsDirty() const { return m_dirty; }
 
-    void UpdateLocalPosition();
-    void UpdateLocalRotation();
-    void UpdateLocalScale();
+    // Bring the world transform up to date, the ancestors' first.
+    void UpdateWorldTransform() const;
+    // Keep the world transform and derive the local one from the parent's,
+    // e.g. after changing the parent.
+    void UpdateLocalTransform();
 
     SERIALIZE(parent, children, m_local_transform, m_world_transform)
    private:
-    Transform m_world_transform;
+    void MarkChildrenDirty();
+
+    mutable Transform m_world_transform;
     Transform m_local_transform;
+    mutable bool m_dirty{false};
 };
 
 struct SD_ECS_API MeshComponent {
@@ -173,16 +185,6 @@ inline void OnComponentAdded<DirectionalLightComponent>(entt::registry& reg,
     }
 }
 
-template <>
-inline void OnComponentAdded<PointLightComponent>(entt::registry& reg,
-                                                  entt::entity ent)
-{
-    auto& light = reg.get<PointLightComponent>(ent);
-    if (light.is_cast_shadow) {
-        light.shadow.CreateShadowMap();
-    }
-}
-
 }  // namespace SD
 
 #endif /* SD_COMPONENT_HPP */
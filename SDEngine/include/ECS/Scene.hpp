@@ -39,6 +39,13 @@ class SD_ECS_API Scene : public entt::registry {
 
     Entity CloneEntity(EntityId from);
 
+    // Sort the transforms parent before child if the hierarchy changed,
+    // then update the world transforms out of date in one pass over them.
+    // Called once per frame.
+    void UpdateTransforms();
+    // The transforms are sorted again on the next UpdateTransforms.
+    void MarkHierarchyChanged() { m_hierarchy_changed = true; }
+
     // Registering a component enables serialization as well as duplication
     // functionality in & out editor.
     template <typename T>
@@ -53,6 +60,11 @@ class SD_ECS_API Scene : public entt::registry {
     }
 
    private:
+    void OnTransformChanged(entt::registry &, entt::entity)
+    {
+        m_hierarchy_changed = true;
+    }
+
     template <typename T>
     static void SerializeComponent(entt::snapshot &snapshot,
                                    cereal::PortableBinaryOutputArchive &archive)
@@ -78,6 +90,8 @@ class SD_ECS_API Scene : public entt::registry {
     std::unordered_map<EntityIdType, std::pair<ComponentSerializeFunction,
                                                ComponentDeserializeFunction>>
         m_serialize_functions;
+    // Adding and removing transforms moves others in their storage too.
+    bool m_hierarchy_changed{true};
 };
 
 }  // namespace SD
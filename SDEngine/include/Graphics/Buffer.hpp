@@ -62,6 +62,19 @@ class SD_GRAPHICS_API UniformBuffer : virtual public Buffer {
     UniformBuffer() = default;
 };
 
+class SD_GRAPHICS_API ShaderStorageBuffer : virtual public Buffer {
+   public:
+    static Ref<ShaderStorageBuffer> Create(const void *data, size_t size,
+                                           BufferIOType io);
+
+    virtual ~ShaderStorageBuffer() = default;
+
+    virtual uint32_t GetBindingPoint() const = 0;
+
+   protected:
+    ShaderStorageBuffer() = default;
+};
+
 }  // namespace SD
 
 #endif /* SD_BUFFER_HPP */
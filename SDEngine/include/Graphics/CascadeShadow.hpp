@@ -29,17 +29,46 @@ class SD_GRAPHICS_API CascadeShadow {
         return m_cascade_planes;
     }
 
+    // Only the levels in the mask are recomputed, the others keep the
+    // matrix their map layer was last drawn with.
     void ComputeCascadeLightMatrix(const Transform &transform,
-                                   const Camera &camera);
+                                   const Camera &camera,
+                                   uint32_t level_mask = ~0u);
 
     Texture *GetShadowMap() const { return m_cascade_map.get(); }
     Framebuffer *GetShadowTarget() const { return m_cascade_fb.get(); }
 
+    // Map holding only the static casters, created on demand. Dynamic
+    // casters are drawn over a copy of it, so static ones are not redrawn.
+    void CreateStaticShadowMap();
+    Texture *GetStaticShadowMap() const { return m_static_map.get(); }
+    Framebuffer *GetStaticShadowTarget() const { return m_static_fb.get(); }
+
+    // Versions of the light and casters each layer of the maps was drawn
+    // with, 0 if it must be redrawn.
+    uint64_t GetVersion(uint32_t layer) const { return m_versions[layer]; }
+    void SetVersion(uint32_t layer, uint64_t version)
+    {
+        m_versions[layer] = version;
+    }
+    uint64_t GetStaticVersion(uint32_t layer) const
+    {
+        return m_static_versions[layer];
+    }
+    void SetStaticVersion(uint32_t layer, uint64_t version)
+    {
+        m_static_versions[layer] = version;
+    }
+
    private:
     int32_t m_width;
     int32_t m_height;
     Ref<Framebuffer> m_cascade_fb;
     Ref<Texture> m_cascade_map;
+    Ref<Framebuffer> m_static_fb;
+    Ref<Texture> m_static_map;
+    std::vector<uint64_t> m_versions;
+    std::vector<uint64_t> m_static_versions;
     std::vector<Matrix4f> m_projection_views;
     std::vector<float> m_cascade_planes;
 };
@@ -4,12 +4,29 @@
 #include "Utility/Base.hpp"
 #include "Graphics/Graphics.hpp"
 
+#include <string>
+
 namespace SD {
 
 class VertexArray;
 class Shader;
 class Framebuffer;
 
+// Counters of the work sent to the driver, and of state calls skipped
+// because the cached state was already the same.
+struct SD_GRAPHICS_API DeviceStatistics {
+    size_t draw_calls{0};
+    size_t triangles{0};
+    // Bytes of buffer and texture data sent after creation.
+    size_t uploaded_bytes{0};
+    size_t state_issued{0};
+    size_t state_elided{0};
+    size_t uniform_hits{0};
+    size_t uniform_misses{0};
+    size_t texture_hits{0};
+    size_t texture_misses{0};
+};
+
 class SD_GRAPHICS_API Device {
    public:
     enum class API { OpenGL, Vulkan, Direct3D };
@@ -19,6 +36,11 @@ class SD_GRAPHICS_API Device {
 
     static Scope<Device> Create();
 
+    static DeviceStatistics &GetStatistics();
+    // Add the statistics to the "device." counters of the frame metrics and
+    // restart them.
+    static void PublishStatistics();
+
     Device() = default;
     virtual ~Device() = default;
 
@@ -32,8 +54,10 @@ class SD_GRAPHICS_API Device {
 
     virtual void DrawElements(MeshTopology topology, int count,
                               size_t offset) = 0;
+    // Instanced attributes start at base_instance.
     virtual void DrawElementsInstanced(MeshTopology topology, int count,
-                                       size_t offset, size_t amount) = 0;
+                                       size_t offset, size_t amount,
+                                       size_t base_instance) = 0;
 
     virtual void DrawArrays(MeshTopology topology, int first, int count) = 0;
 
@@ -51,6 +75,11 @@ class SD_GRAPHICS_API Device {
 
     virtual void SetViewport(int x, int y, int width, int height) = 0;
 
+    // One of the viewports a geometry shader selects with its viewport
+    // index output. SetViewport sets all of them.
+    virtual void SetViewportIndexed(int index, int x, int y, int width,
+                                    int height) = 0;
+
     virtual void SetFramebuffer(const Framebuffer *framebuffer) = 0;
 
     virtual void SetPolygonMode(PolygonMode mode, Face face) = 0;
@@ -22,6 +22,8 @@ class SD_GRAPHICS_API Framebuffer {
     virtual uint32_t Handle() const = 0;
     virtual void Attach(Texture &texture, int attachment, int level) = 0;
     virtual void Attach(Renderbuffer &buffer, int attachment) = 0;
+    // Remove a color attachment, it is no longer drawn to.
+    virtual void Detach(int attachment) = 0;
     virtual Texture *GetAttachment(int attachment) = 0;
     virtual void Prepare() = 0;
 
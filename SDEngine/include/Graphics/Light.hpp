@@ -22,6 +22,11 @@ struct SD_GRAPHICS_API PointLight {
     float constant{1.0};
     float linear{0.1};
     float quadratic{0.01};
+
+    // Distance at which the attenuated light falls below the threshold
+    // (in color units), infinite if it never attenuates.
+    float GetRadius(float threshold = 5.f / 256.f) const;
+
     SERIALIZE(ambient, diffuse, specular, constant, linear, quadratic)
 };
 
@@ -0,0 +1,87 @@
+#ifndef SD_LIGHT_CLUSTER_HPP
+#define SD_LIGHT_CLUSTER_HPP
+
+#include "Graphics/Export.hpp"
+#include "Utility/Base.hpp"
+#include "Utility/Math.hpp"
+
+#include <vector>
+
+namespace SD {
+
+// Bins light volumes into a grid of view space clusters (froxels): the
+// screen is split into x * y tiles and the view depth into z slices,
+// exponentially for perspective projections and linearly otherwise.
+//
+// The result is a light index list and, for every cluster, the range of
+// indices that touch it. Nothing here depends on the graphics API.
+class SD_GRAPHICS_API LightCluster {
+   public:
+    struct Cluster {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    LightCluster(uint32_t x = 16, uint32_t y = 9, uint32_t z = 24);
+
+    // Rebuild the cluster bounds if the projection changed. near_z and
+    // far_z are positive view distances.
+    void SetProjection(const Matrix4f &projection, float near_z, float far_z);
+
+    // Assign world space light volumes to the clusters, light i is referred
+    // as index i in the light index list.
+    void Assign(const Matrix4f &view,
+                const std::vector<Math::BoundingSphere> &lights);
+
+    // Slice of a positive view distance, clamped to the grid.
+    uint32_t GetSlice(float depth) const;
+    uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        return (z * m_size_y + y) * m_size_x + x;
+    }
+
+    uint32_t GetSizeX() const { return m_size_x; }
+    uint32_t GetSizeY() const { return m_size_y; }
+    uint32_t GetSizeZ() const { return m_size_z; }
+    float GetNearZ() const { return m_near_z; }
+    float GetFarZ() const { return m_far_z; }
+    bool IsPerspective() const { return m_perspective; }
+
+    const Math::AABB &GetBound(uint32_t index) const
+    {
+        return m_bounds[index];
+    }
+    const std::vector<Cluster> &GetClusters() const { return m_clusters; }
+    const std::vector<uint32_t> &GetLightIndices() const
+    {
+        return m_light_indices;
+    }
+
+   private:
+    float GetSliceDepth(uint32_t slice) const;
+
+    uint32_t m_size_x;
+    uint32_t m_size_y;
+    uint32_t m_size_z;
+
+    Matrix4f m_projection;
+    float m_near_z;
+    float m_far_z;
+    bool m_perspective;
+
+    std::vector<Math::AABB> m_bounds;
+    // Union of the bounds of a column (x) or a row (y) within a slice, used
+    // to narrow down the clusters to test a light against.
+    std::vector<Math::AABB> m_column_bounds;
+    std::vector<Math::AABB> m_row_bounds;
+
+    std::vector<Cluster> m_clusters;
+    std::vector<uint32_t> m_light_indices;
+    // (cluster, light) pairs of the last assignment, before the counting
+    // sort by cluster.
+    std::vector<std::pair<uint32_t, uint32_t>> m_pairs;
+};
+
+}  // namespace SD
+
+#endif /* SD_LIGHT_CLUSTER_HPP */
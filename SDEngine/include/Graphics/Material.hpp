@@ -6,8 +6,8 @@
 #include "Graphics/Export.hpp"
 #include "Graphics/Texture.hpp"
 #include "Utility/Math.hpp"
+#include <array>
 #include <string>
-#include <unordered_map>
 
 namespace SD {
 
@@ -21,13 +21,20 @@ enum class MaterialType {
     Shininess
 };
 
+inline constexpr size_t MATERIAL_TYPE_COUNT =
+    static_cast<size_t>(MaterialType::Shininess) + 1;
+
 const std::string SD_GRAPHICS_API GetMaterialName(MaterialType type);
 
 class SD_GRAPHICS_API Material {
    public:
+    using TextureArray = std::array<Texture *, MATERIAL_TYPE_COUNT>;
+
     Material();
     void SetTexture(MaterialType type, Texture *texture);
     const Texture *GetTexture(MaterialType type) const;
+    // Materials with the same textures can share texture bindings.
+    const TextureArray &GetTextures() const { return m_textures; }
 
     void SetAmbientColor(const Vector3f &color) { m_ambient_base = color; }
     void SetDiffuseColor(const Vector3f &color) { m_diffuse_base = color; }
@@ -36,9 +43,12 @@ class SD_GRAPHICS_API Material {
     const Vector3f &GetDiffuseColor() const { return m_diffuse_base; }
     const Vector3f &GetEmissiveColor() const { return m_emissive_base; }
 
+    bool operator==(const Material &other) const;
+    bool operator!=(const Material &other) const { return !(*this == other); }
+
     SERIALIZE(m_diffuse_base, m_ambient_base, m_emissive_base)
    private:
-    std::unordered_map<MaterialType, Texture *> m_textures;
+    TextureArray m_textures;
     Vector3f m_diffuse_base;
     Vector3f m_ambient_base;
     Vector3f m_emissive_base;
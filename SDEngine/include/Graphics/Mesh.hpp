@@ -42,6 +42,16 @@ class SD_GRAPHICS_API Mesh {
     const std::vector<Vertex> &GetVertices() const;
     std::vector<Vertex> &GetVertices();
 
+    // Local space bounds, a mesh without valid bounds is never culled.
+    void SetBoundingBox(const Math::AABB &aabb) { m_aabb = aabb; }
+    const Math::AABB &GetBoundingBox() const { return m_aabb; }
+
+    void SetBoundingSphere(const Math::BoundingSphere &sphere)
+    {
+        m_sphere = sphere;
+    }
+    const Math::BoundingSphere &GetBoundingSphere() const { return m_sphere; }
+
    private:
     std::vector<Vertex> m_vertices;
     std::vector<uint32_t> m_indices;
@@ -49,6 +59,8 @@ class SD_GRAPHICS_API Mesh {
     Ref<VertexBuffer> m_vertexBuffer;
     Ref<IndexBuffer> m_indexBuffer;
     PolygonMode m_polygonMode;
+    Math::AABB m_aabb;
+    Math::BoundingSphere m_sphere;
 };
 
 }  // namespace SD
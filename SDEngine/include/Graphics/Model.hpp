@@ -5,6 +5,8 @@
 #include "Graphics/Material.hpp"
 #include "Graphics/ModelNode.hpp"
 
+#include <unordered_map>
+
 namespace SD {
 
 class SD_GRAPHICS_API Model {
@@ -56,6 +56,20 @@ class SD_GRAPHICS_API GLUniformBuffer : public UniformBuffer, public GLBuffer {
     static uint32_t s_count;
 };
 
+class SD_GRAPHICS_API GLShaderStorageBuffer : public ShaderStorageBuffer,
+                                              public GLBuffer {
+   public:
+    GLShaderStorageBuffer(const void *data, size_t size, BufferIOType io);
+
+    ~GLShaderStorageBuffer() = default;
+
+    uint32_t GetBindingPoint() const override;
+
+   private:
+    uint32_t m_base;
+    static uint32_t s_count;
+};
+
 }  // namespace SD
 
 #endif /* SD_GL_BUFFER_HPP */
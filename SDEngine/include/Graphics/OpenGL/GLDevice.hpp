@@ -3,11 +3,15 @@
 
 #include "Graphics/Device.hpp"
 
+#include <array>
+#include <vector>
+
 namespace SD {
 
 class GLDevice : public Device {
    public:
     GLDevice();
+    ~GLDevice();
 
     void DispatchCompute(int32_t num_group_x, int32_t num_group_y,
                          int32_t num_group_z) override;
@@ -17,7 +21,7 @@ class GLDevice : public Device {
     void DrawElements(MeshTopology topology, int count, size_t offset) override;
 
     void DrawElementsInstanced(MeshTopology topology, int count, size_t offset,
-                               size_t amount) override;
+                               size_t amount, size_t base_instance) override;
 
     void DrawArrays(MeshTopology topology, int first, int count) override;
 
@@ -33,6 +37,9 @@ class GLDevice : public Device {
 
     void SetViewport(int x, int y, int width, int height) override;
 
+    void SetViewportIndexed(int index, int x, int y, int width,
+                            int height) override;
+
     void SetFramebuffer(const Framebuffer *framebuffer) override;
 
     void SetPolygonMode(PolygonMode mode, Face face) override;
@@ -60,6 +67,31 @@ class GLDevice : public Device {
 
     void ReadPixels(int x, int y, int width, int height, DataFormat format,
                     void *data) override;
+
+    // Texture units are context state shared by every shader, binding the
+    // same texture to a unit twice is skipped.
+    static void BindTextureUnit(int32_t unit, uint32_t texture);
+    // Must be called before a texture is deleted, GL unbinds it silently and
+    // a new texture may reuse the handle.
+    static void ReleaseTexture(uint32_t texture);
+    // The same for the objects whose binding the devices cache.
+    static void ReleaseFramebuffer(uint32_t framebuffer);
+    static void ReleaseVertexArray(uint32_t vertex_array);
+    static void ReleaseProgram(uint32_t program);
+
+   private:
+    // Shadow of the GL context state, a call is skipped when the value is
+    // unchanged. -1 marks a state that is not known yet.
+    int64_t m_program;
+    int64_t m_vertex_array;
+    int64_t m_framebuffer;
+    std::array<int, 4> m_viewport;
+    std::array<int8_t, 5> m_operations;
+    int8_t m_depth_mask;
+    int32_t m_depth_func;
+    int32_t m_cull_face;
+    std::array<int32_t, 2> m_polygon_mode;
+    std::vector<uint32_t> m_default_draw_buffers;
 };
 
 }  // namespace SD
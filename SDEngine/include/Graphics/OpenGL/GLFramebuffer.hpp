@@ -16,12 +16,16 @@ class GLFramebuffer : public Framebuffer {
 
     void Attach(Texture &texture, int attachment, int level) override;
     void Attach(Renderbuffer &buffer, int attachment) override;
+    void Detach(int attachment) override;
     Texture *GetAttachment(int attachment) override
     {
         return m_textures.at(attachment);
     }
     void Prepare() override;
 
+    // Skipped when the draw buffers are unchanged.
+    void SetDrawBuffers(const std::vector<GLenum> &buffers);
+
     void ClearDepth(const float depth) override;
 
     void ClearAttachment(uint32_t attachment_id, const int *value) override;
@@ -35,6 +39,7 @@ class GLFramebuffer : public Framebuffer {
     GLuint m_id;
     std::vector<Texture *> m_textures;
     std::vector<GLenum> m_drawables;
+    std::vector<GLenum> m_draw_buffers;
 };
 
 }  // namespace SD
@@ -6,7 +6,8 @@
 #include "Graphics/Shader.hpp"
 #include <GL/glew.h>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace SD {
 
@@ -21,7 +22,7 @@ class SD_GRAPHICS_API GLShader : public Shader {
     uint32_t Handle() const override { return m_id; }
 
     ShaderParam* GetParam(int32_t index) override;
-    ShaderParam* GetParam(const std::string& name) override;
+    ShaderParam* GetParam(UniformId id) override;
 
     void CompileShader(ShaderType type, const std::string& code) override;
 
@@ -30,6 +31,9 @@ class SD_GRAPHICS_API GLShader : public Shader {
     void SetUniformBuffer(const std::string& name,
                           const UniformBuffer& buffer) override;
 
+    void SetStorageBuffer(const std::string& name,
+                          const ShaderStorageBuffer& buffer) override;
+
     uint32_t GetUint(const std::string& name) const override;
 
     Vector3i GetLocalGroupSize() const override;
@@ -48,7 +52,8 @@ class SD_GRAPHICS_API GLShader : public Shader {
     GLuint m_geometryId;
     GLuint m_computeId;
 
-    std::unordered_map<std::string, ShaderParam*> m_params;
+    // Flat table sorted by id, filled at LinkShaders.
+    std::vector<std::pair<UniformId, ShaderParam*>> m_params;
     uint32_t m_texture_cnt;
     uint32_t m_image_cnt;
 };
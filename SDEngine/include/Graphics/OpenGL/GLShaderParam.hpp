@@ -3,6 +3,8 @@
 
 #include "Graphics/ShaderParam.hpp"
 
+#include <array>
+
 namespace SD {
 
 class GLShaderParam : public ShaderParam {
@@ -40,6 +42,14 @@ class GLShaderParam : public ShaderParam {
                     int32_t layer, Access access) override;
 
    private:
+    // Compare with the last uploaded value, return true if the upload can
+    // be skipped. Values larger than the cache are always uploaded.
+    bool IsCached(const void* value, size_t size);
+
+    static constexpr size_t CACHE_SIZE = 64;
+    std::array<uint8_t, CACHE_SIZE> m_cache;
+    size_t m_cache_size;
+
     uint32_t m_program;
     int32_t m_location;
     int32_t m_texture_binding;
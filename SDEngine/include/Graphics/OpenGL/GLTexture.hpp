@@ -29,6 +29,15 @@ class GLTexture : public Texture {
     void ReadPixels(int level, int x, int y, int z, int w, int h, int d,
                     size_t size, void *data) const override;
 
+    void ClearPixels(int level, int x, int y, int z, int w, int h, int d,
+                     const void *value) override;
+
+    void CopyFrom(const Texture &src, int first_layer,
+                  int layer_count) override;
+
+    void CopyPixels(const Texture &src, int level, int x, int y, int z, int w,
+                    int h, int d) override;
+
     int GetWidth() const override { return m_width; };
     int GetHeight() const override { return m_height; };
     MultiSampleLevel GetSamples() const override { return m_samples; };
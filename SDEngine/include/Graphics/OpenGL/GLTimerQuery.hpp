@@ -0,0 +1,27 @@
+#ifndef SD_GL_TIMER_QUERY_HPP
+#define SD_GL_TIMER_QUERY_HPP
+
+#include "Graphics/TimerQuery.hpp"
+#include <GL/glew.h>
+
+namespace SD {
+
+class GLTimerQuery : public TimerQuery {
+   public:
+    GLTimerQuery();
+    ~GLTimerQuery();
+
+    void Begin() override;
+    void End() override;
+
+    bool IsReady() const override;
+    float GetElapsedMS() const override;
+
+   private:
+    // GL_TIME_ELAPSED queries cannot nest, two timestamps can.
+    GLuint m_ids[2];
+};
+
+}  // namespace SD
+
+#endif /* SD_GL_TIMER_QUERY_HPP */
@@ -14,7 +14,8 @@ class SD_GRAPHICS_API GLVertexArray : public VertexArray {
 
     ~GLVertexArray();
 
-    void BindVertexBuffer(const VertexBuffer &buffer, int32_t index) override;
+    void BindVertexBuffer(const VertexBuffer &buffer, int32_t index,
+                          size_t offset = 0) override;
     void AddBufferLayout(const VertexBufferLayout &layout) override;
 
     void BindIndexBuffer(const IndexBuffer &buffer) override;
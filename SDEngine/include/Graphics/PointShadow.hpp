@@ -1,21 +1,20 @@
 #ifndef SD_POINT_SHADOW_HPP
 #define SD_POINT_SHADOW_HPP
 
-#include "Graphics/Framebuffer.hpp"
 #include "Graphics/Export.hpp"
 #include "Utility/Math.hpp"
 #include "Utility/Serialize.hpp"
 
+#include <array>
+
 namespace SD {
 
+// Cube projection of a point light's shadow. The faces are drawn to tiles
+// of a ShadowAtlas shared by every point light, sized by the renderer each
+// frame.
 class SD_GRAPHICS_API PointShadow {
    public:
     PointShadow();
-    void CreateShadowMap(int32_t width = 4096, int32_t height = 4096);
-    void DestroyShadowMap();
-
-    Texture *GetShadowMap() { return m_shadow_map.get(); }
-    Framebuffer *GetShadowTarget() { return m_framebuffer.get(); }
 
     const std::array<Matrix4f, 6> &GetProjectionMatrix(
         const Vector3f &light_pos)
@@ -49,10 +48,7 @@ class SD_GRAPHICS_API PointShadow {
     void ComputeShadowMatirx()
     {
         m_projection =
-            glm::perspective(glm::radians(90.f),
-                             static_cast<float>(m_shadow_map->GetWidth()) /
-                                 m_shadow_map->GetHeight(),
-                             m_near_z, m_far_z);
+            glm::perspective(glm::radians(90.f), 1.0f, m_near_z, m_far_z);
         m_shadow_matrix[0] =
             m_projection * glm::lookAt(m_last_pos,
                                        m_last_pos + glm::vec3(1.0f, 0.0f, 0.0f),
@@ -79,8 +75,6 @@ class SD_GRAPHICS_API PointShadow {
                         glm::vec3(0.0f, -1.0f, 0.0f));
         m_outdated = false;
     }
-    Ref<Framebuffer> m_framebuffer;
-    Ref<Texture> m_shadow_map;
     Matrix4f m_projection;
     std::array<Matrix4f, 6> m_shadow_matrix;
 
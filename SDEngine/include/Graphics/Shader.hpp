@@ -6,6 +6,7 @@
 #include "Graphics/ShaderParam.hpp"
 #include "Utility/Math.hpp"
 
+#include <array>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -15,6 +16,7 @@ namespace SD {
 
 class Texture;
 class UniformBuffer;
+class ShaderStorageBuffer;
 
 enum class ShaderType { Invalid, Vertex, Fragment, Geometry, Compute };
 
@@ -26,7 +28,7 @@ class SD_GRAPHICS_API Shader {
 
     virtual uint32_t Handle() const = 0;
     virtual ShaderParam* GetParam(int32_t index) = 0;
-    virtual ShaderParam* GetParam(const std::string& name) = 0;
+    virtual ShaderParam* GetParam(UniformId id) = 0;
 
     Shader(const Shader&) = delete;
 
@@ -39,6 +41,9 @@ class SD_GRAPHICS_API Shader {
     virtual void SetUniformBuffer(const std::string& name,
                                   const UniformBuffer& buffer) = 0;
 
+    virtual void SetStorageBuffer(const std::string& name,
+                                  const ShaderStorageBuffer& buffer) = 0;
+
     virtual uint32_t GetUint(const std::string& name) const = 0;
 
     virtual Vector3i GetLocalGroupSize() const = 0;
@@ -47,6 +52,39 @@ class SD_GRAPHICS_API Shader {
     Shader() = default;
 };
 
+// A fixed set of parameters resolved once per shader and reused until a
+// different shader is bound, index it with an enum of the pass:
+//     static ShaderParamBlock<2> block({"u_a", "u_b"});
+//     block.Bind(shader);
+//     block[A]->SetAsFloat(a);
+template <size_t N>
+class ShaderParamBlock {
+   public:
+    explicit ShaderParamBlock(const std::array<UniformId, N>& ids)
+        : m_ids(ids), m_shader(nullptr), m_handle(0), m_params{}
+    {
+    }
+
+    void Bind(Shader& shader)
+    {
+        if (m_shader == &shader && m_handle == shader.Handle()) return;
+
+        m_shader = &shader;
+        m_handle = shader.Handle();
+        for (size_t i = 0; i < N; ++i) {
+            m_params[i] = shader.GetParam(m_ids[i]);
+        }
+    }
+
+    ShaderParam* operator[](size_t i) const { return m_params[i]; }
+
+   private:
+    std::array<UniformId, N> m_ids;
+    const Shader* m_shader;
+    uint32_t m_handle;
+    std::array<ShaderParam*, N> m_params;
+};
+
 }  // namespace SD
 
 #endif /* SD_SHADER_HPP */
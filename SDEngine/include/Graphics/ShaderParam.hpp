@@ -20,6 +20,43 @@ enum class UniformType {
     Image
 };
 
+// FNV-1a hash of a uniform name. Declare hot path ids as constants so the
+// hash is computed at compile time:
+//     static constexpr UniformId u_model("u_model");
+class UniformId {
+   public:
+    constexpr UniformId(const char* name) : m_hash(Hash(name)) {}
+    UniformId(const std::string& name) : m_hash(Hash(name.c_str())) {}
+
+    constexpr uint32_t GetHash() const { return m_hash; }
+
+    constexpr bool operator==(const UniformId& other) const
+    {
+        return m_hash == other.m_hash;
+    }
+    constexpr bool operator!=(const UniformId& other) const
+    {
+        return m_hash != other.m_hash;
+    }
+    constexpr bool operator<(const UniformId& other) const
+    {
+        return m_hash < other.m_hash;
+    }
+
+   private:
+    static constexpr uint32_t Hash(const char* str)
+    {
+        uint32_t hash = 2166136261u;
+        while (*str) {
+            hash ^= static_cast<uint8_t>(*str++);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    uint32_t m_hash;
+};
+
 class SD_GRAPHICS_API ShaderParam {
    public:
     ShaderParam(UniformType type, const std::string& name, int32_t index)
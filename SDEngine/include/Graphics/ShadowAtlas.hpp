@@ -0,0 +1,75 @@
+#ifndef SD_SHADOW_ATLAS_HPP
+#define SD_SHADOW_ATLAS_HPP
+
+#include "Graphics/Export.hpp"
+#include "Graphics/Framebuffer.hpp"
+#include "Utility/Base.hpp"
+
+#include <vector>
+
+namespace SD {
+
+// A square depth texture shared by many shadows, split into power of two
+// tiles by a quad tree: a node is either free, in use, or split into four
+// children of half its size. Freeing the last used child of a node merges
+// it back.
+//
+// The allocator does not touch the graphics API, the textures are created
+// on demand with CreateShadowMap.
+class SD_GRAPHICS_API ShadowAtlas {
+   public:
+    struct Tile {
+        int32_t x;
+        int32_t y;
+        int32_t size;
+    };
+
+    // size and min_tile_size are powers of two.
+    ShadowAtlas(int32_t size = 4096, int32_t min_tile_size = 64);
+
+    // Free every tile and change the layout, the maps are recreated on the
+    // next CreateShadowMap.
+    void Reset(int32_t size, int32_t min_tile_size);
+
+    // Node of a free tile of the size, -1 if the atlas is too full or the
+    // size is not one of its tile sizes.
+    int32_t Allocate(int32_t tile_size);
+    void Free(int32_t tile);
+
+    Tile GetTile(int32_t tile) const;
+
+    int32_t GetSize() const { return m_size; }
+    int32_t GetMinTileSize() const { return m_min_tile_size; }
+    // Texels of the atlas in use.
+    int64_t GetUsedArea() const { return m_used_area; }
+
+    void CreateShadowMap();
+    Texture *GetShadowMap() { return m_shadow_map.get(); }
+    Framebuffer *GetShadowTarget() { return m_framebuffer.get(); }
+
+    // Same layout, holding only the static casters of each tile.
+    void CreateStaticShadowMap();
+    Texture *GetStaticShadowMap() { return m_static_map.get(); }
+    Framebuffer *GetStaticShadowTarget() { return m_static_framebuffer.get(); }
+
+   private:
+    enum class NodeState : uint8_t { Free, Split, Used };
+
+    int32_t GetLevel(int32_t tile_size) const;
+    int32_t Find(int32_t node, int32_t level, int32_t target);
+
+    int32_t m_size;
+    int32_t m_min_tile_size;
+    int64_t m_used_area;
+    // Complete quad tree, the children of node i are 4i+1 to 4i+4.
+    std::vector<NodeState> m_nodes;
+
+    Ref<Framebuffer> m_framebuffer;
+    Ref<Texture> m_shadow_map;
+    Ref<Framebuffer> m_static_framebuffer;
+    Ref<Texture> m_static_map;
+};
+
+}  // namespace SD
+
+#endif /* SD_SHADOW_ATLAS_HPP */
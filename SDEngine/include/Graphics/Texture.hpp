@@ -41,6 +41,21 @@ class SD_GRAPHICS_API Texture {
     virtual void ReadPixels(int level, int x, int y, int z, int w, int h, int d,
                             size_t size, void *data) const = 0;
 
+    // Fill a region of a level with a single value in the texture's format.
+    virtual void ClearPixels(int level, int x, int y, int z, int w, int h,
+                             int d, const void *value) = 0;
+
+    // Copy every level of a texture of the same size, type and format.
+    // Layers (or cube faces) [first_layer, first_layer + layer_count) are
+    // copied, all of them if layer_count is 0.
+    virtual void CopyFrom(const Texture &src, int first_layer = 0,
+                          int layer_count = 0) = 0;
+
+    // Copy a region of a level from a texture of the same type and format
+    // to the same place in this one.
+    virtual void CopyPixels(const Texture &src, int level, int x, int y, int z,
+                            int w, int h, int d) = 0;
+
     virtual void GenerateMipmap() = 0;
 
     bool operator==(const Texture &other) const;
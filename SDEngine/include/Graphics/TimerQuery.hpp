@@ -0,0 +1,31 @@
+#ifndef SD_TIMER_QUERY_HPP
+#define SD_TIMER_QUERY_HPP
+
+#include "Utility/Base.hpp"
+#include "Graphics/Export.hpp"
+
+namespace SD {
+
+// GPU time between Begin and End. Both ends are timestamps, so the queries
+// of nested scopes can overlap. The result is only known a few frames
+// later, poll IsReady instead of stalling on it.
+class SD_GRAPHICS_API TimerQuery {
+   public:
+    static Ref<TimerQuery> Create();
+    TimerQuery() = default;
+    virtual ~TimerQuery() = default;
+
+    TimerQuery(const TimerQuery &) = delete;
+    TimerQuery &operator=(const TimerQuery &) = delete;
+
+    virtual void Begin() = 0;
+    virtual void End() = 0;
+
+    // The GPU has reached End.
+    virtual bool IsReady() const = 0;
+    virtual float GetElapsedMS() const = 0;
+};
+
+}  // namespace SD
+
+#endif /* SD_TIMER_QUERY_HPP */
@@ -19,7 +19,8 @@ class SD_GRAPHICS_API VertexArray {
 
     virtual uint32_t Handle() const = 0;
 
-    virtual void BindVertexBuffer(const VertexBuffer &buffer, int index) = 0;
+    virtual void BindVertexBuffer(const VertexBuffer &buffer, int index,
+                                  size_t offset = 0) = 0;
     virtual void AddBufferLayout(const VertexBufferLayout &layout) = 0;
 
     virtual void BindIndexBuffer(const IndexBuffer &buffer) = 0;
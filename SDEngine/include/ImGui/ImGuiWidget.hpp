@@ -5,11 +5,14 @@
 #include "Utility/Math.hpp"
 #include "ImGui/Export.hpp"
 #include "Graphics/Texture.hpp"
+#include "Utility/Profiler.hpp"
+#include "Utility/Metrics.hpp"
 
 #include "imgui.h"
 #include "imgui_internal.h"
 
 #include <string>
+#include <vector>
 
 namespace ImGui {
 
@@ -30,6 +33,14 @@ void IMGUI_API DrawTileTexture(const SD::Texture &texture,
 bool IMGUI_API BeginCenterPopupModal(const char *name, bool *p_open = nullptr,
                                      ImGuiWindowFlags flags = 0);
 
+// Scopes of one thread as nested bars, over the last root scope (depth 0)
+// of the records.
+void IMGUI_API DrawFlameGraph(const std::vector<SD::ProfileRecord> &records);
+
+// The value of each metric in the last frame, and the percentiles of its
+// window for counters and histograms.
+void IMGUI_API DrawMetrics(const std::vector<SD::Metric> &metrics);
+
 // bool IMGUI_API DrawTextureAssetSelection(
 //     const SD::ResourceRegistry::TextureCache &cache, SD::ResourceId *id);
 
@@ -9,28 +9,52 @@
 #include "Graphics/VertexArray.hpp"
 #include "Graphics/CascadeShadow.hpp"
 #include "Graphics/PointShadow.hpp"
+#include "Renderer/RenderGraph.hpp"
 #include "Resource/Resource.hpp"
 
 namespace SD {
 
+struct PointShadowTiles;
+
+// Positions are rebuilt from the depth buffer, normals are octahedral,
+// ambient and emissive are packed as two RGB565 in one R32UI.
 enum class GeometryBufferType {
-    Position = 0,
-    Normal,
+    Normal = 0,
     Albedo,
-    Ambient,
-    Emissive,
+    AmbientEmissive,
     EntityId,
     GBufferCount
 };
 
+// Resolution SSAO is computed at, halved once per step.
+enum class SSAOResolution { Full = 0, Half, Quarter };
+
 struct DeferredRenderSettings {
     int32_t width;
     int32_t height;
     MultiSampleLevel msaa;
+    // Write the entity id of each pixel, read back for picking.
+    bool entity_id_state{true};
     bool ssao_state{true};
     float ssao_radius{2.0f};
     float ssao_bias{0.5};
     int ssao_power{3};
+    SSAOResolution ssao_resolution{SSAOResolution::Full};
+    // Cascades below this index are redrawn every frame, the farther ones
+    // every cascade_update_interval frames, one after another.
+    int cascade_every_frame_count{2};
+    int cascade_update_interval{4};
+    // Shade the point lights without shadow in one pass over a cluster grid
+    // instead of one fullscreen pass each.
+    bool clustered_lighting{true};
+    // Point light shadows are tiles of one atlas. A light's tiles are sized
+    // from the pixels its range covers on screen times the scale, lights
+    // covering fewer than point_shadow_min_pixels get no shadow.
+    int point_shadow_atlas_size{4096};
+    int point_shadow_min_tile_size{64};
+    int point_shadow_max_tile_size{1024};
+    float point_shadow_resolution_scale{1.0f};
+    float point_shadow_min_pixels{16.f};
 };
 
 DataFormat SD_RENDERER_API GetTextureFormat(GeometryBufferType type);
@@ -40,30 +64,44 @@ class SD_RENDERER_API DeferredRenderPass {
     static void Init(DeferredRenderSettings settings, Device *device,
                      ShaderCache &shaders, ModelCache &models);
 
-    static void Render(Scene &scene);
+    // Record the geometry, SSAO and lighting passes shading into color.
+    static void AddPasses(RenderGraph &graph, Scene &scene,
+                          RenderGraph::Resource color);
 
     static void ImGui();
 
+    // Size of the textures, the viewport is reset to all of them.
     static void SetRenderSize(int32_t width, int32_t height);
+    // Draw to the bottom left of the textures only, at most the render size.
+    static void SetViewportSize(int32_t width, int32_t height);
 
     static Texture *GetEntityBuffer();
 
    private:
     static void InitShaders(ShaderCache &cache);
-    static void InitSSAOBuffers();
+    static void InitEntityBuffer();
     static void InitSSAOKernel();
-    static void InitLightingBuffers();
 
     static void RenderGBuffer(const Scene &scene);
-    static void BlitGeometryBuffers();
+    static void ResolveGeometryBuffer(GeometryBufferType type, Texture &dst);
+    static void ResolveDepth(Texture &dst);
 
+    static void DownsampleSSAOInput();
     static void RenderSSAO();
+    static void UpsampleSSAO();
 
+    static void UpdateCasterStates(const Scene &scene);
     static void RenderShadowMap(const Scene &scene, CascadeShadow &shadow,
                                 const Camera &camera,
                                 const Transform &transform);
+    static void UpdatePointShadowTiles(const Scene &scene,
+                                       const Camera &camera);
     static void RenderPointShadowMap(const Scene &scene, PointShadow &shadow,
+                                     PointShadowTiles &tiles,
                                      const Transform &transform);
+    static uint32_t UpdateLightCluster(const Scene &scene,
+                                       const Camera &camera);
+    static void RenderLighting(Scene &scene);
     static void RenderDeferred(Scene &scene);
     static void RenderEmissive();
 };
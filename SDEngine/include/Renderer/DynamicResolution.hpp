@@ -0,0 +1,73 @@
+#ifndef SD_DYNAMIC_RESOLUTION_HPP
+#define SD_DYNAMIC_RESOLUTION_HPP
+
+#include "Renderer/Export.hpp"
+#include "Graphics/TimerQuery.hpp"
+#include "Utility/Math.hpp"
+#include "Utility/Timing.hpp"
+
+#include <array>
+
+namespace SD {
+
+struct DynamicResolutionSettings {
+    bool enabled{false};
+    // Frame time to hold, in milliseconds.
+    float target_frame_time{16.6f};
+    // Bounds of the render size over the output size, on each axis.
+    float min_scale{0.5f};
+    float max_scale{1.0f};
+};
+
+// Picks the size a frame is rendered at from the time the last frames took:
+// the larger of the CPU time between BeginFrame and EndFrame and the GPU
+// time, read back a few frames late from a ring of timer queries.
+//
+// Over the target the scale drops at once by the ratio of pixels that would
+// have met it, well under the target it climbs back in small steps. After
+// each change it waits for the measurements to catch up, so it does not
+// oscillate around the target.
+class SD_RENDERER_API DynamicResolution {
+   public:
+    DynamicResolution();
+
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+    void BeginFrame();
+    void EndFrame();
+
+    // Size to render an output of the size at: the size itself when the
+    // scale is 1 or the setting is off, otherwise a multiple of 8 texels
+    // no larger than it.
+    Vector2i GetRenderSize(int32_t width, int32_t height) const;
+
+    float GetScale() const { return m_scale; }
+    DynamicResolutionSettings &GetSettings() { return m_settings; }
+
+    void ImGui();
+
+   private:
+    static const int32_t QUERY_COUNT = 4;
+
+    void Update();
+
+    DynamicResolutionSettings m_settings;
+
+    std::array<Ref<TimerQuery>, QUERY_COUNT> m_queries;
+    std::array<bool, QUERY_COUNT> m_pending;
+    int32_t m_query_index;
+    Clock m_clock;
+
+    float m_cpu_time;
+    float m_gpu_time;
+    // Moving average of the larger of the two.
+    float m_frame_time;
+    float m_scale;
+    // Frames left before the scale can change again.
+    int32_t m_cooldown;
+};
+
+}  // namespace SD
+
+#endif /* SD_DYNAMIC_RESOLUTION_HPP */
@@ -0,0 +1,56 @@
+#ifndef SD_GPU_PROFILER_HPP
+#define SD_GPU_PROFILER_HPP
+
+#include "Renderer/Export.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SD {
+
+// GPU time of nested scopes, e.g. a render pass and the draws in it. Each
+// scope is a pair of timestamp queries taken from a ring of FRAME_COUNT
+// frames, a frame is read back when the ring comes around to it so reading
+// never waits on the GPU. A frame not done by then is dropped.
+class SD_RENDERER_API GPUProfiler {
+   public:
+    struct Scope {
+        std::string name;
+        int32_t depth;
+        float time;
+    };
+
+    // The frame is the root scope, scopes outside of it are ignored.
+    static void BeginFrame();
+    static void EndFrame();
+
+    static void BeginScope(const std::string &name);
+    static void EndScope();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // Scopes of the last frame read back, in the order they began.
+    static const std::vector<Scope> &GetResults();
+
+    // Write the last frame read back as CSV, one scope per line with its
+    // depth, name and milliseconds.
+    static void Export(const std::string &path);
+
+    static void ImGui();
+};
+
+// Profiles the enclosing block.
+class SD_RENDERER_API GPUProfileScope {
+   public:
+    GPUProfileScope(const std::string &name) { GPUProfiler::BeginScope(name); }
+    ~GPUProfileScope() { GPUProfiler::EndScope(); }
+
+    GPUProfileScope(const GPUProfileScope &) = delete;
+    GPUProfileScope &operator=(const GPUProfileScope &) = delete;
+};
+
+}  // namespace SD
+
+#endif /* SD_GPU_PROFILER_HPP */
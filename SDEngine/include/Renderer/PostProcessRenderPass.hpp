@@ -7,6 +7,7 @@
 #include "Graphics/Shader.hpp"
 #include "Graphics/Framebuffer.hpp"
 #include "Resource/Resource.hpp"
+#include "Renderer/RenderGraph.hpp"
 
 namespace SD {
 
@@ -18,6 +19,8 @@ struct PostProcessSettings {
     float bloom_soft_threshold{0.8};
 
     bool is_bloom{true};
+    // Build the downsample chain in one dispatch with a box filter.
+    bool bloom_single_pass_downsample{false};
     float exposure{1.0};
     float gamma_correction{1.5};
 };
@@ -28,19 +31,22 @@ class SD_RENDERER_API PostProcessRenderPass {
                      ShaderCache &shaders);
 
     static void SetRenderSize(int32_t width, int32_t height);
+    // Process the bottom left of the textures only.
+    static void SetViewportSize(int32_t width, int32_t height);
 
     static void ImGui();
 
-    static void Render();
+    // Record the bloom and tone mapping passes, from color back into it.
+    static void AddPasses(RenderGraph &graph, RenderGraph::Resource color);
 
    private:
     static void RenderPost();
 
-    static void RenderBloom();
     static void Downsample(Texture &src, Texture &dst);
+    static void DownsampleSinglePass(Texture &dst);
     static void Upsample(Texture &src, Texture &dst);
-
-    static void InitBuffers();
+    static void ComputeMipLevel(const Shader &shader, const Texture &dst,
+                                int level);
 };
 
 }  // namespace SD
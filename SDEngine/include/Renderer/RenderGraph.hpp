@@ -0,0 +1,133 @@
+#ifndef SD_RENDER_GRAPH_HPP
+#define SD_RENDER_GRAPH_HPP
+
+#include "Renderer/Export.hpp"
+#include "Graphics/Texture.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SD {
+
+struct SD_RENDERER_API RenderGraphTextureDesc {
+    int32_t width;
+    int32_t height;
+    MultiSampleLevel samples{MultiSampleLevel::None};
+    DataFormat format{DataFormat::RGBA8};
+    TextureParameter params{};
+    int32_t mipmap_levels{0};
+    TextureType type{TextureType::Normal2D};
+
+    bool operator==(const RenderGraphTextureDesc &other) const;
+    bool operator!=(const RenderGraphTextureDesc &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// The passes of a frame declare the textures they create, read and write
+// before any of them runs. Compile drops the passes whose results are never
+// used and backs the transient textures with a pool: resources whose
+// lifetimes do not overlap share the same texture, and pooled textures not
+// used for a few frames are released. Pooled textures are keyed by their
+// whole description, size included: keep the sizes to a few classes, e.g.
+// rounded up and drawn to in part, for them to be reused across resizes.
+//
+// The passes are recorded again every frame and run in the order they were
+// added. A transient texture holds garbage when its first pass starts.
+class SD_RENDERER_API RenderGraph {
+   public:
+    using Resource = int32_t;
+
+    class SD_RENDERER_API PassBuilder {
+       public:
+        Resource Create(const std::string &name,
+                        const RenderGraphTextureDesc &desc);
+        Resource Read(Resource resource);
+        Resource Write(Resource resource);
+
+       private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph &graph, int32_t pass)
+            : m_graph(graph), m_pass(pass)
+        {
+        }
+
+        RenderGraph &m_graph;
+        int32_t m_pass;
+    };
+
+    using SetupFunc = std::function<void(PassBuilder &)>;
+    using ExecuteFunc = std::function<void(const RenderGraph &)>;
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    // Drop the passes and resources of the last frame.
+    void Reset();
+
+    // A texture owned outside of the graph, passes writing to it are never
+    // culled.
+    Resource Import(const std::string &name, Texture *texture);
+    void AddPass(const std::string &name, const SetupFunc &setup,
+                 ExecuteFunc execute);
+    // Keep the passes producing a transient resource even if no pass reads
+    // it, e.g. for a debug view drawn after the frame.
+    void MarkOutput(Resource resource);
+
+    void Compile();
+    // Each pass runs in a CPU and a GPU profiler scope of its name.
+    void Execute();
+
+    // Texture backing the resource in this frame, nullptr if every pass
+    // using it was culled.
+    Texture *GetTexture(Resource resource) const;
+
+    // Bytes held by the pool, and by the transient resources if each of
+    // them had its own texture.
+    size_t GetPoolSize() const;
+    size_t GetTransientSize() const;
+
+    void ImGui();
+
+   private:
+    struct ResourceNode {
+        std::string name;
+        RenderGraphTextureDesc desc;
+        Texture *imported;
+        bool is_output;
+        // Index in the pool, -1 if not allocated.
+        int32_t physical;
+        int32_t first_pass;
+        int32_t last_pass;
+    };
+
+    struct PassNode {
+        std::string name;
+        ExecuteFunc execute;
+        std::vector<Resource> creates;
+        std::vector<Resource> reads;
+        std::vector<Resource> writes;
+        bool culled;
+    };
+
+    struct PooledTexture {
+        RenderGraphTextureDesc desc;
+        Ref<Texture> texture;
+        bool in_use;
+        uint64_t last_used_frame;
+    };
+
+    int32_t Acquire(const RenderGraphTextureDesc &desc);
+
+    std::vector<ResourceNode> m_resources;
+    std::vector<PassNode> m_passes;
+    std::vector<PooledTexture> m_pool;
+    uint64_t m_frame{0};
+};
+
+}  // namespace SD
+
+#endif /* SD_RENDER_GRAPH_HPP */
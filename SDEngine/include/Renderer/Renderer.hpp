@@ -15,6 +15,13 @@ namespace SD {
 struct SD_RENDERER_API CameraData {
     Matrix4f projection;
     Matrix4f view;
+    // Rebuilds world positions from the depth buffer.
+    Matrix4f inv_view_projection;
+    // Render size over the size of the textures drawn to. A frame at a
+    // reduced resolution covers their bottom left.
+    Vector2f render_scale{1.f};
+    // std140 rounds the block up to a multiple of 16 bytes.
+    Vector2f padding{0.f};
 };
 
 struct RenderOperation {
@@ -71,6 +78,10 @@ class SD_RENDERER_API Renderer {
     static void Submit(const Shader &shader, const VertexArray &vao,
                        MeshTopology topology, size_t count, size_t offset,
                        bool index = true);
+    static void SubmitInstanced(const Shader &shader, const VertexArray &vao,
+                                MeshTopology topology, size_t count,
+                                size_t offset, size_t instance_count,
+                                size_t base_instance = 0);
     static void ComputeImage(const Shader &shader, int32_t width,
                              int32_t height, int32_t depth);
 
@@ -81,6 +92,8 @@ class SD_RENDERER_API Renderer {
     static bool IsEmptyStack();
 
     static void SetCamera(Camera &camera);
+    // Uploaded with the camera by SetCamera.
+    static void SetRenderScale(const Vector2f &scale);
     static Camera *GetCamera();
 
     static void BindCamera(Shader &shader);
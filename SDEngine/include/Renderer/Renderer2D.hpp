@@ -8,13 +8,11 @@ namespace SD {
 
 class SD_RENDERER_API Renderer2D : protected Renderer {
    public:
+    // Registers the "renderer2d." counters of the frame metrics.
     static void Init(ShaderCache &shaders);
     static void Begin();
     static void End();
 
-    static void Reset();
-    static std::string GetDebugInfo();
-
     static void SetTextOrigin(int x, int y);
     static Vector2i GetTextCursor();
 
@@ -12,16 +12,56 @@ struct SD_RENDERER_API ShadowData {
     Matrix4f projection_view[16];
 };
 
+// std140 layout of one entry of the MaterialData block in material.glsl.
+struct SD_RENDERER_API MaterialData {
+    Vector4f diffuse_color;
+    Vector4f ambient_color;
+    Vector4f emissive_color;
+};
+
+inline constexpr uint32_t MAX_MATERIAL_COUNT = 256;
+
+// Per instance vertex attributes, see mesh.vert and shadow.vert.
+struct SD_RENDERER_API InstanceData {
+    Matrix4f model;
+    uint32_t entity_id;
+    // Shadow layers (cascades or cube faces) the instance is drawn to.
+    uint32_t layer_mask;
+    // Filled by AddInstance, index in the MaterialData block.
+    uint32_t material_index;
+};
+
 class SD_RENDERER_API Renderer3D : protected Renderer {
    public:
+    // Registers the "renderer3d." counters of the frame metrics.
     static void Init();
-    static void Reset();
-    static std::string GetDebugInfo();
     static void SetCascadeShadow(const CascadeShadow &shadow);
     static void BindCascadeShadow(Shader &shader);
+    static void BindMaterials(Shader &shader);
+
+    // Test the world bounds of the mesh against the frustum, the result is
+    // counted in the frame metrics.
+    static bool IsVisible(const Math::Frustum &frustum, const Mesh &mesh,
+                          const Matrix4f &transform);
 
-    static void DrawMesh(const Shader &shader, const Mesh &mesh);
-    static void SetMaterial(Shader &shader, const Material &material);
+    // Instances are queued with a 64 bit sort key (material page, material
+    // textures, mesh, depth) and DrawInstances issues one instanced draw call
+    // per group of equal state. Base colors are read from the material
+    // buffer, so materials that only differ in color share a draw. A null
+    // material leaves the shader's material untouched, e.g. for the shadow
+    // passes.
+    //
+    // With an eye position, the instances of a group are drawn front to back
+    // to reduce overdraw.
+    //
+    // The first DrawInstances of a queue sorts it and uploads its instances
+    // once, the groups then start at their offset in the buffer. Drawing the
+    // queue again, e.g. with another shader, reuses them.
+    static void BeginInstances();
+    static void BeginInstances(const Vector3f &eye);
+    static void AddInstance(const Mesh &mesh, const Material *material,
+                            const InstanceData &instance);
+    static void DrawInstances(Shader &shader);
 };
 
 }  // namespace SD
@@ -0,0 +1,162 @@
+#ifndef SD_JOB_SYSTEM_HPP
+#define SD_JOB_SYSTEM_HPP
+
+#include "Utility/Base.hpp"
+#include "Utility/Export.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace SD {
+
+// A function and its captures stored inline, with the counters linking it
+// to the other jobs. Jobs come from a pool of the creating thread and are
+// reused without being freed, once finished and no longer waited on: a
+// pointer to a job is only valid until then. The pool grows by
+// JOB_POOL_SIZE jobs when all of its jobs are alive.
+struct alignas(64) Job {
+    static const uint32_t MAX_CONTINUATIONS = 4;
+    static const size_t DATA_SIZE = 64;
+
+    using Function = void (*)(Job *job, void *data);
+
+    Function function;
+    // Finishes after this job and its children.
+    Job *parent;
+    // The job itself and its unfinished children.
+    std::atomic<int32_t> unfinished{0};
+    // Run call and dependencies left before the job can start.
+    std::atomic<int32_t> pending{0};
+    // Threads in Wait on the job.
+    mutable std::atomic<int32_t> waiters{0};
+    uint32_t continuation_count;
+    // Jobs depending on this one.
+    Job *continuations[MAX_CONTINUATIONS];
+    alignas(std::max_align_t) unsigned char data[DATA_SIZE];
+};
+
+// Work-stealing scheduler. Each worker, and the thread calling Init, owns a
+// Chase-Lev deque: it pushes and pops jobs at the bottom without locking,
+// and idle threads steal from the top of the others. A thread waiting for
+// a job runs the other jobs meanwhile.
+//
+// A job runs once Run was called on it and its dependencies finished, and
+// finishes after its children. Children and dependencies are added before
+// the job finishes and before the dependency runs, respectively.
+class SD_UTILITY_API JobSystem {
+   public:
+    static const uint32_t JOB_POOL_SIZE = 4096;
+    static const uint32_t MAX_PARALLEL_FOR_JOBS = JOB_POOL_SIZE / 2;
+
+    // Start the workers, the calling thread becomes the thread 0.
+    static void Init(uint32_t workers);
+    // Stop the workers, jobs still queued are dropped.
+    static void Shutdown();
+
+    // Workers and the thread calling Init.
+    static uint32_t GetThreadCount();
+
+    template <typename F>
+    static Job *CreateJob(F &&function);
+    template <typename F>
+    static Job *CreateChildJob(Job *parent, F &&function);
+
+    static void AddDependency(Job *job, Job *dependency);
+
+    // Threads without a deque, or with a full one, run the job right away.
+    static void Run(Job *job);
+    static void Wait(const Job *job);
+    static bool IsFinished(const Job *job);
+
+    // Call function(i) for i in [0, count) and wait. The range is split in
+    // halves down to chunk indices, by default enough chunks for every
+    // thread to steal a few. The chunk is raised so that the split creates
+    // at most MAX_PARALLEL_FOR_JOBS jobs.
+    template <typename F>
+    static void ParallelFor(uint32_t count, const F &function,
+                            uint32_t chunk = 0);
+
+   private:
+    static Job *Allocate(Job::Function function, Job *parent);
+
+    template <typename F>
+    struct Range {
+        const F *function;
+        uint32_t begin;
+        uint32_t end;
+        uint32_t chunk;
+    };
+
+    template <typename F>
+    static void RunRange(Job *job, void *data);
+};
+
+template <typename F>
+Job *JobSystem::CreateJob(F &&function)
+{
+    return CreateChildJob(nullptr, std::forward<F>(function));
+}
+
+template <typename F>
+Job *JobSystem::CreateChildJob(Job *parent, F &&function)
+{
+    using Callable = std::decay_t<F>;
+    static_assert(sizeof(Callable) <= Job::DATA_SIZE,
+                  "Job captures too large!");
+    static_assert(alignof(Callable) <= alignof(std::max_align_t),
+                  "Job captures over-aligned!");
+
+    Job *job = Allocate(
+        [](Job *, void *data) {
+            Callable &callable = *static_cast<Callable *>(data);
+            callable();
+            callable.~Callable();
+        },
+        parent);
+    new (job->data) Callable(std::forward<F>(function));
+    return job;
+}
+
+template <typename F>
+void JobSystem::RunRange(Job *job, void *data)
+{
+    Range<F> range = *static_cast<Range<F> *>(data);
+    // Hand the upper half to a child for another thread to steal.
+    while (range.end - range.begin > range.chunk) {
+        const uint32_t middle = range.begin + (range.end - range.begin) / 2;
+        Job *half = Allocate(&RunRange<F>, job);
+        new (half->data) Range<F>{range.function, middle, range.end,
+                                  range.chunk};
+        Run(half);
+        range.end = middle;
+    }
+    for (uint32_t i = range.begin; i < range.end; ++i) {
+        (*range.function)(i);
+    }
+}
+
+template <typename F>
+void JobSystem::ParallelFor(uint32_t count, const F &function, uint32_t chunk)
+{
+    if (count == 0) return;
+
+    if (chunk == 0) {
+        chunk = std::max(count / (GetThreadCount() * 4), 1u);
+    }
+    // Halving down to chunk makes less than 2 * count / chunk jobs.
+    const uint32_t max_leaves = MAX_PARALLEL_FOR_JOBS / 2;
+    chunk = std::max(chunk, (count - 1) / max_leaves + 1);
+    Job *root = Allocate(&RunRange<F>, nullptr);
+    new (root->data) Range<F>{&function, 0, count, chunk};
+    Run(root);
+    Wait(root);
+}
+
+}  // namespace SD
+
+#endif /* SD_JOB_SYSTEM_HPP */
@@ -0,0 +1,364 @@
+#ifndef SD_MPMC_QUEUE_HPP
+#define SD_MPMC_QUEUE_HPP
+
+#include "Utility/Base.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace SD {
+
+// Bounded multi-producer multi-consumer queue after Dmitry Vyukov's: a ring
+// of cells, each with a sequence number telling whether it is free for the
+// push at its position or full for the pop. Pushes and pops claim their
+// position with one compare-and-swap and never lock. The cells and the two
+// positions are on their own cache lines.
+//
+// With BLOCKING, Push and Pop wait for room or an item: they spin a little,
+// then sleep on a condition variable that the other side only notifies
+// when a thread sleeps. Without it, the Try calls skip that check.
+template <typename T, bool BLOCKING = true>
+class MPMCQueue {
+   public:
+    // T is default constructible and movable. The capacity is rounded up
+    // to a power of two.
+    explicit MPMCQueue(size_t capacity);
+    ~MPMCQueue();
+
+    MPMCQueue(const MPMCQueue &) = delete;
+    MPMCQueue &operator=(const MPMCQueue &) = delete;
+
+    template <typename U>
+    bool TryPush(U &&item);
+    bool TryPop(T &item);
+
+    // Move items to the queue with a single claim, return how many fit.
+    size_t TryPush(T *items, size_t count);
+    // Move up to count items out with a single claim, return how many.
+    size_t TryPop(T *items, size_t count);
+
+    template <typename U>
+    void Push(U &&item);
+    T Pop();
+
+    size_t GetCapacity() const { return m_mask + 1; }
+    // Only exact when no other thread uses the queue.
+    size_t GetSize() const;
+
+   private:
+    static const uint32_t SPINS = 64;
+
+    // The Try calls without the notification.
+    template <typename U>
+    bool PushItem(U &&item);
+    bool PopItem(T &item);
+
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T *Get() { return std::launder(reinterpret_cast<T *>(&storage)); }
+    };
+
+    // Free cells from position, up to count.
+    size_t CountFree(size_t position, size_t count) const;
+    // Full cells from position, up to count.
+    size_t CountFull(size_t position, size_t count) const;
+
+    void NotifyPushed();
+    void NotifyPopped();
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+    alignas(64) std::atomic<size_t> m_push_position;
+    alignas(64) std::atomic<size_t> m_pop_position;
+
+    // Threads sleeping in Push and in Pop.
+    alignas(64) std::atomic<int32_t> m_push_waiters;
+    std::atomic<int32_t> m_pop_waiters;
+    std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+};
+
+template <typename T, bool BLOCKING>
+MPMCQueue<T, BLOCKING>::MPMCQueue(size_t capacity)
+    : m_push_position(0), m_pop_position(0), m_push_waiters(0), m_pop_waiters(0)
+{
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_cells.reset(new Cell[size]);
+    m_mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, bool BLOCKING>
+MPMCQueue<T, BLOCKING>::~MPMCQueue()
+{
+    T item;
+    while (PopItem(item)) {
+    }
+}
+
+template <typename T, bool BLOCKING>
+size_t MPMCQueue<T, BLOCKING>::CountFree(size_t position, size_t count) const
+{
+    size_t free = 0;
+    while (free < count) {
+        const Cell &cell = m_cells[(position + free) & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != position + free) {
+            break;
+        }
+        ++free;
+    }
+    return free;
+}
+
+template <typename T, bool BLOCKING>
+size_t MPMCQueue<T, BLOCKING>::CountFull(size_t position, size_t count) const
+{
+    size_t full = 0;
+    while (full < count) {
+        const Cell &cell = m_cells[(position + full) & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) !=
+            position + full + 1) {
+            break;
+        }
+        ++full;
+    }
+    return full;
+}
+
+template <typename T, bool BLOCKING>
+template <typename U>
+bool MPMCQueue<T, BLOCKING>::PushItem(U &&item)
+{
+    size_t position = m_push_position.load(std::memory_order_relaxed);
+    while (true) {
+        Cell &cell = m_cells[position & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) -
+                              static_cast<intptr_t>(position);
+        if (diff == 0) {
+            if (m_push_position.compare_exchange_weak(
+                    position, position + 1, std::memory_order_relaxed)) {
+                new (&cell.storage) T(std::forward<U>(item));
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The cell still holds the item of the previous lap: full.
+            return false;
+        }
+        else {
+            position = m_push_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T, bool BLOCKING>
+bool MPMCQueue<T, BLOCKING>::PopItem(T &item)
+{
+    size_t position = m_pop_position.load(std::memory_order_relaxed);
+    while (true) {
+        Cell &cell = m_cells[position & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) -
+                              static_cast<intptr_t>(position + 1);
+        if (diff == 0) {
+            if (m_pop_position.compare_exchange_weak(
+                    position, position + 1, std::memory_order_relaxed)) {
+                item = std::move(*cell.Get());
+                cell.Get()->~T();
+                cell.sequence.store(position + m_mask + 1,
+                                    std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The cell was not pushed yet: empty.
+            return false;
+        }
+        else {
+            position = m_pop_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T, bool BLOCKING>
+template <typename U>
+bool MPMCQueue<T, BLOCKING>::TryPush(U &&item)
+{
+    if (!PushItem(std::forward<U>(item))) return false;
+
+    NotifyPushed();
+    return true;
+}
+
+template <typename T, bool BLOCKING>
+bool MPMCQueue<T, BLOCKING>::TryPop(T &item)
+{
+    if (!PopItem(item)) return false;
+
+    NotifyPopped();
+    return true;
+}
+
+template <typename T, bool BLOCKING>
+size_t MPMCQueue<T, BLOCKING>::TryPush(T *items, size_t count)
+{
+    if (count == 0) return 0;
+
+    size_t position = m_push_position.load(std::memory_order_relaxed);
+    size_t claimed = 0;
+    // A free cell past the position can only be claimed by moving the
+    // position over it, so the cells counted are ours if the swap succeeds.
+    while (true) {
+        claimed = CountFree(position, count);
+        if (claimed > 0) {
+            if (m_push_position.compare_exchange_weak(
+                    position, position + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        const size_t sequence =
+            m_cells[position & m_mask].sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence - position) < 0) return 0;
+
+        position = m_push_position.load(std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < claimed; ++i) {
+        Cell &cell = m_cells[(position + i) & m_mask];
+        new (&cell.storage) T(std::move(items[i]));
+        cell.sequence.store(position + i + 1, std::memory_order_release);
+    }
+    NotifyPushed();
+    return claimed;
+}
+
+template <typename T, bool BLOCKING>
+size_t MPMCQueue<T, BLOCKING>::TryPop(T *items, size_t count)
+{
+    if (count == 0) return 0;
+
+    size_t position = m_pop_position.load(std::memory_order_relaxed);
+    size_t claimed = 0;
+    while (true) {
+        claimed = CountFull(position, count);
+        if (claimed > 0) {
+            if (m_pop_position.compare_exchange_weak(
+                    position, position + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        const size_t sequence =
+            m_cells[position & m_mask].sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence - (position + 1)) < 0) return 0;
+
+        position = m_pop_position.load(std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < claimed; ++i) {
+        Cell &cell = m_cells[(position + i) & m_mask];
+        items[i] = std::move(*cell.Get());
+        cell.Get()->~T();
+        cell.sequence.store(position + i + m_mask + 1,
+                            std::memory_order_release);
+    }
+    NotifyPopped();
+    return claimed;
+}
+
+template <typename T, bool BLOCKING>
+template <typename U>
+void MPMCQueue<T, BLOCKING>::Push(U &&item)
+{
+    static_assert(BLOCKING, "Push waits on a non-blocking queue!");
+    for (uint32_t i = 0; i < SPINS; ++i) {
+        if (TryPush(std::forward<U>(item))) return;
+
+        std::this_thread::yield();
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_push_waiters;
+        m_not_full.wait(lock, [&] { return PushItem(std::forward<U>(item)); });
+        --m_push_waiters;
+    }
+    NotifyPushed();
+}
+
+template <typename T, bool BLOCKING>
+T MPMCQueue<T, BLOCKING>::Pop()
+{
+    static_assert(BLOCKING, "Pop waits on a non-blocking queue!");
+    T item;
+    for (uint32_t i = 0; i < SPINS; ++i) {
+        if (TryPop(item)) return item;
+
+        std::this_thread::yield();
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_pop_waiters;
+        m_not_empty.wait(lock, [&] { return PopItem(item); });
+        --m_pop_waiters;
+    }
+    NotifyPopped();
+    return item;
+}
+
+template <typename T, bool BLOCKING>
+size_t MPMCQueue<T, BLOCKING>::GetSize() const
+{
+    const size_t push = m_push_position.load(std::memory_order_relaxed);
+    const size_t pop = m_pop_position.load(std::memory_order_relaxed);
+    return push > pop ? push - pop : 0;
+}
+
+// A sleeper counts itself before its last try, and the other side checks
+// the count after its change, so one of the two sees the other. Notifying
+// under the mutex keeps a sleeper from missing it between its try and its
+// wait.
+template <typename T, bool BLOCKING>
+void MPMCQueue<T, BLOCKING>::NotifyPushed()
+{
+    if constexpr (BLOCKING) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_pop_waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_not_empty.notify_all();
+        }
+    }
+}
+
+template <typename T, bool BLOCKING>
+void MPMCQueue<T, BLOCKING>::NotifyPopped()
+{
+    if constexpr (BLOCKING) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_push_waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_not_full.notify_all();
+        }
+    }
+}
+
+}  // namespace SD
+
+#endif /* SD_MPMC_QUEUE_HPP */
@@ -46,6 +46,58 @@ struct SD_UTILITY_API Plane {
     Vector3f point;
 };
 
+struct BoundingSphere;
+
+struct SD_UTILITY_API AABB {
+    // An empty box, invalid until a point is merged into it.
+    AABB();
+    AABB(const Vector3f &min, const Vector3f &max) : min(min), max(max) {}
+
+    bool IsValid() const;
+    void Merge(const Vector3f &point);
+
+    Vector3f GetCenter() const { return (min + max) * 0.5f; }
+    Vector3f GetExtent() const { return (max - min) * 0.5f; }
+
+    // Bound of the transformed box.
+    AABB Transform(const Matrix4f &transform) const;
+
+    bool Intersects(const BoundingSphere &sphere) const;
+
+    Vector3f min;
+    Vector3f max;
+};
+
+struct SD_UTILITY_API BoundingSphere {
+    BoundingSphere() : center(0), radius(-1) {}
+    BoundingSphere(const Vector3f &center, float radius)
+        : center(center), radius(radius)
+    {
+    }
+
+    bool IsValid() const { return radius >= 0; }
+
+    // Bound of the transformed sphere, scaled by the largest axis scale.
+    BoundingSphere Transform(const Matrix4f &transform) const;
+
+    Vector3f center;
+    float radius;
+};
+
+// Six planes (ax + by + cz + d = 0) pointing inward, extracted from a
+// projection view matrix.
+struct SD_UTILITY_API Frustum {
+    enum Side { Left = 0, Right, Bottom, Top, Near, Far, SideCount };
+
+    Frustum() = default;
+    explicit Frustum(const Matrix4f &projection_view);
+
+    bool Intersects(const AABB &aabb) const;
+    bool Intersects(const BoundingSphere &sphere) const;
+
+    Vector4f planes[SideCount];
+};
+
 template <typename T>
 inline T Lerp(T a, T b, float f)
 {
@@ -99,6 +151,7 @@ struct SD_UTILITY_API Rect {
     float width;
     float height;
     bool Contains(const Rect &other) const;
+    bool Contains(const Vector2f &point) const;
     bool Intersects(const Rect &other) const;
     float GetLeft() const;
     float GetTop() const;
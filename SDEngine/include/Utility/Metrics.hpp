@@ -0,0 +1,96 @@
+#ifndef SD_METRICS_HPP
+#define SD_METRICS_HPP
+
+#include "Utility/Base.hpp"
+#include "Utility/Export.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SD {
+
+// Counts of values in fixed buckets growing by a constant ratio, so the
+// relative error of a percentile is the same from the smallest to the
+// largest value and recording never allocates. Values up to min fall in an
+// underflow bucket that reports the smallest value recorded, so a counter
+// at 0 on most frames reports 0; values over max fall in the last bucket.
+class SD_UTILITY_API Histogram {
+   public:
+    Histogram(double min = 1e-2, double max = 1e4,
+              int32_t buckets_per_octave = 8);
+
+    void Record(double value);
+    void Reset();
+
+    // Value under which p (0 to 1) of the values fall, the geometric middle
+    // of its bucket clamped to the recorded range, or the smallest value
+    // recorded for the underflow bucket.
+    double GetPercentile(double p) const;
+
+    uint64_t GetCount() const { return m_count; }
+    double GetMean() const;
+    double GetMin() const { return m_min_value; }
+    double GetMax() const { return m_max_value; }
+
+   private:
+    double m_min;
+    double m_buckets_per_octave;
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count;
+    double m_sum;
+    double m_min_value;
+    double m_max_value;
+};
+
+enum class MetricType { Counter, Gauge, Histogram };
+
+struct SD_UTILITY_API Metric {
+    std::string name;
+    MetricType type;
+    // Total of the last frame for a counter, last value set for a gauge.
+    double value;
+    // Counted so far in the current frame.
+    uint64_t frame_count;
+    // Values recorded in the window, the frame totals of a counter.
+    Histogram histogram;
+};
+
+enum class MetricsFormat { CSV, JSON };
+
+// Named counters, gauges and histograms of the frame, looked up by the id
+// returned when they are registered so updating one is an index and an
+// add. Counters restart every frame; histograms restart every window of
+// frames, after the window is written to the dump file if there is one.
+//
+// Metrics are updated and read from the main thread.
+class SD_UTILITY_API Metrics {
+   public:
+    using Id = uint32_t;
+
+    // Registering a name again returns its first id.
+    static Id RegisterCounter(const std::string &name);
+    static Id RegisterGauge(const std::string &name);
+    static Id RegisterHistogram(const std::string &name, double min,
+                                double max);
+
+    static void Add(Id counter, uint64_t value = 1);
+    static void Set(Id gauge, double value);
+    static void Record(Id histogram, double value);
+
+    // Close the frame of the counters, and the window every window frames.
+    static void EndFrame();
+
+    static void SetWindow(uint32_t frames);
+    static uint32_t GetWindow();
+
+    // Write each window to the file, truncated here. An empty path stops
+    // dumping. CSV has a row per metric, JSON an object per line.
+    static void SetDump(const std::string &path, MetricsFormat format);
+
+    static const std::vector<Metric> &GetMetrics();
+};
+
+}  // namespace SD
+
+#endif /* SD_METRICS_HPP */
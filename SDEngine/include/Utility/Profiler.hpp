@@ -0,0 +1,106 @@
+#ifndef SD_PROFILER_HPP
+#define SD_PROFILER_HPP
+
+#include "Utility/Base.hpp"
+#include "Utility/Export.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SD {
+
+// One ended scope.
+struct SD_UTILITY_API ProfileRecord {
+    // Nanoseconds since the profiler started.
+    uint64_t begin;
+    uint64_t end;
+    uint32_t thread;
+    // Scopes open on the thread when it began.
+    uint32_t depth;
+    // Truncated copy of the name.
+    char name[48];
+};
+
+// Timing of named CPU scopes. Each thread writes the scopes it ends to its
+// own ring buffer and publishes them with an atomic store of its count, so
+// recording never takes a lock; only the first scope of a thread registers
+// its buffer. Each slot of a ring is a sequence lock copied as atomic
+// words: a reader keeps a record only if its slot held it before and after
+// the copy, and never blocks the writer. Records overwritten before or
+// while they are read are lost, a ring wrapping loses the oldest.
+class SD_UTILITY_API Profiler {
+   public:
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    static uint64_t Now();
+    // Small id of the calling thread, in the order threads first profile.
+    static uint32_t GetThreadId();
+
+    // Records of every thread, in the order they ended per thread.
+    static std::vector<ProfileRecord> Collect();
+    // Records of a thread ended at or after since.
+    static std::vector<ProfileRecord> Collect(uint32_t thread,
+                                              uint64_t since);
+
+    // Write the records as Chrome trace_event JSON, for chrome://tracing
+    // or Perfetto.
+    static void ExportChromeTrace(const std::string &path);
+
+    // "Class::Function" out of a compiler function signature.
+    static std::string GetFunctionName(const std::string &signature);
+};
+
+class SD_UTILITY_API ProfileScope {
+   public:
+    // The name is copied, it can be a temporary.
+    ProfileScope(const char *name);
+    ProfileScope(const std::string &name) : ProfileScope(name.c_str()) {}
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+   private:
+    // Not recording if the profiler was disabled when the scope began.
+    bool m_active;
+    uint64_t m_begin;
+    char m_name[sizeof(ProfileRecord::name)];
+};
+
+}  // namespace SD
+
+#ifdef DEBUG_BUILD
+#define SD_ENABLE_PROFILING
+#endif
+
+#ifdef SD_ENABLE_PROFILING
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SD_FUNCTION_SIGNATURE __PRETTY_FUNCTION__
+#elif defined(_MSC_VER)
+#define SD_FUNCTION_SIGNATURE __FUNCSIG__
+#else
+#define SD_FUNCTION_SIGNATURE __func__
+#endif
+
+#define SD_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SD_PROFILE_CONCAT(a, b) SD_PROFILE_CONCAT_IMPL(a, b)
+
+#define SD_PROFILE_SCOPE(name) \
+    ::SD::ProfileScope SD_PROFILE_CONCAT(sd_profile_scope_, __LINE__)(name)
+#define SD_PROFILE_FUNCTION()                                             \
+    static const std::string SD_PROFILE_CONCAT(sd_profile_function_,      \
+                                               __LINE__) =                \
+        ::SD::Profiler::GetFunctionName(SD_FUNCTION_SIGNATURE);           \
+    SD_PROFILE_SCOPE(SD_PROFILE_CONCAT(sd_profile_function_, __LINE__))
+
+#else
+
+#define SD_PROFILE_SCOPE(name)
+#define SD_PROFILE_FUNCTION()
+
+#endif
+
+#endif /* SD_PROFILER_HPP */
@@ -5,6 +5,7 @@
 #include "Utility/Math.hpp"
 
 #include <any>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <array>
@@ -23,38 +24,110 @@ struct SD_UTILITY_API Collidable {
 
    private:
     QuadTree *qt;
+    int32_t node;
+    int32_t element;
 
     friend class QuadTree;
 };
 
+// A quad tree whose nodes and object links live in two contiguous
+// pools. Children are allocated as blocks of four consecutive nodes and
+// released blocks are recycled through a free list, so once the pools have
+// grown to the working set size no further allocation happens.
+//
+// Query functions clear and fill the output vector passed in, reuse the same
+// vector across frames to keep them allocation-free. They are not safe to
+// call concurrently on the same tree.
 class SD_UTILITY_API QuadTree {
    public:
+    struct Node {
+        Rect bound;
+        int32_t parent;
+        // Index of the first of the four children, -1 if it is a leaf.
+        // For a released block, it links to the next free block instead.
+        int32_t first_child;
+        int32_t first_element;
+        uint32_t count;
+        uint32_t level;
+
+        bool IsLeaf() const { return first_child < 0; }
+    };
+
+    struct RayHit {
+        Collidable *object;
+        float distance;
+    };
+
     QuadTree();
     QuadTree(const Rect &bound, uint32_t capacity, uint32_t maxLevel);
     ~QuadTree();
 
+    QuadTree(const QuadTree &) = delete;
+    QuadTree &operator=(const QuadTree &) = delete;
+
     bool Insert(Collidable *obj);
     bool Remove(Collidable *obj);
     bool Update(Collidable *obj);
     void Clear();
 
+    // Objects whose bound intersects the range.
+    void QueryRange(const Rect &range, std::vector<Collidable *> &result) const;
+    // Objects whose bound contains the point.
+    void QueryPoint(const Vector2f &point,
+                    std::vector<Collidable *> &result) const;
+    // Objects hit by the ray within max_distance (in units of direction's
+    // length), sorted from near to far.
+    void QueryRay(const Vector2f &origin, const Vector2f &direction,
+                  float max_distance, std::vector<RayHit> &result) const;
+    // The k objects closest to the point, sorted from near to far.
+    void QueryNearest(const Vector2f &point, uint32_t k,
+                      std::vector<Collidable *> &result) const;
+
+    size_t Size() const { return m_size; }
+
     bool IsLeaf() const;
-    const std::array<QuadTree *, 4> &GetChildren() const;
+    const Node &GetRoot() const { return m_nodes.front(); }
+    const std::vector<Node> &GetNodes() const { return m_nodes; }
 
    private:
-    void Subdivide();
-    void DiscardEmptyBuckets();
-    QuadTree *GetChild(const Rect &bound) const;
+    struct Element {
+        Collidable *obj;
+        int32_t prev;
+        int32_t next;
+    };
+
+    void InsertAt(int32_t node, Collidable *obj);
+    void Subdivide(int32_t node);
+    void DiscardEmptyBuckets(int32_t node);
+    int32_t GetChild(int32_t node, const Rect &bound) const;
+
+    int32_t AllocateChildren();
+    void FreeChildren(int32_t node);
+    int32_t AllocateElement(Collidable *obj);
+    void FreeElement(int32_t element);
+    void Link(int32_t node, int32_t element);
+    void Unlink(int32_t node, int32_t element);
+
+    void QueryRange(int32_t node, const Rect &range,
+                    std::vector<Collidable *> &result) const;
+    void QueryPoint(int32_t node, const Vector2f &point,
+                    std::vector<Collidable *> &result) const;
+    void QueryRay(int32_t node, const Vector2f &origin,
+                  const Vector2f &direction, float max_distance,
+                  std::vector<RayHit> &result) const;
+    void QueryNearest(int32_t node, const Vector2f &point, uint32_t k) const;
 
-    bool m_isLeaf;
-    Rect m_bound;
-    uint32_t m_level;
     uint32_t m_capacity;
     uint32_t m_maxLevel;
-    QuadTree *m_parent;
-    std::array<QuadTree *, 4> m_children;
-    std::vector<Collidable *> m_objects;
-    std::vector<Collidable *> m_foundObjects;
+    size_t m_size;
+
+    std::vector<Node> m_nodes;
+    int32_t m_free_node;
+    std::vector<Element> m_elements;
+    int32_t m_free_element;
+
+    // scratch max-heap for QueryNearest
+    mutable std::vector<std::pair<float, Collidable *>> m_foundObjects;
 };
 
 }  // namespace SD
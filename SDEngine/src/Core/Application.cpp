@@ -2,6 +2,9 @@
 #include "Core/InputLayer.hpp"
 #include "Core/ScriptLayer.hpp"
 #include "Utility/Timing.hpp"
+#include "Utility/Profiler.hpp"
+#include "Utility/Metrics.hpp"
+#include "Utility/JobSystem.hpp"
 #include "Utility/Random.hpp"
 
 #if defined(SD_PLATFORM_LINUX)
@@ -44,6 +47,9 @@ Application::Application(const std::string &title, Device::API api)
     Log::Init(debug_path);
     SD_CORE_INFO("Debug info is output to: {}", debug_path);
 
+    // One thread per core, this one included.
+    JobSystem::Init(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
     // Setting up which api to use
     Device::SetAPI(api);
 
@@ -82,7 +88,7 @@ Application::Application(const std::string &title, Device::API api)
     }
 }
 
-Application::~Application() {}
+Application::~Application() { JobSystem::Shutdown(); }
 
 void Application::OnInit()
 {
@@ -171,10 +177,18 @@ void Application::Run()
     const float min_fps = 30;
     const float ms_per_frame = 1000.f / min_fps;
     uint32_t ms_elapsed = 0;
+    const Metrics::Id frame_time =
+        Metrics::RegisterHistogram("frame_time_ms", 0.1, 1e4);
     while (!m_window->ShouldClose()) {
-        m_window->PollEvents(m_layers);
+        SD_PROFILE_SCOPE("Frame");
+        {
+            SD_PROFILE_SCOPE("PollEvents");
+            m_window->PollEvents(m_layers);
+        }
 
-        ms_elapsed = clock.Restart();
+        const float frame_ms = clock.Restart();
+        Metrics::Record(frame_time, frame_ms);
+        ms_elapsed = frame_ms;
         while (ms_elapsed > ms_per_frame) {
             ms_elapsed -= ms_per_frame;
             Tick(ms_per_frame * 1e-3);
@@ -182,6 +196,9 @@ void Application::Run()
         Tick(ms_elapsed * 1e-3);
 
         Render();
+
+        Device::PublishStatistics();
+        Metrics::EndFrame();
     }
 }
 
@@ -189,25 +206,31 @@ void Application::Shutdown() { m_window->SetShouldClose(true); }
 
 void Application::Tick(float dt)
 {
+    SD_PROFILE_FUNCTION();
     for (auto iter = m_layers.rbegin(); iter != m_layers.rend(); ++iter) {
+        SD_PROFILE_SCOPE((*iter)->GetName() + "::OnTick");
         (*iter)->OnTick(dt);
     }
 }
 
 void Application::Render()
 {
+    SD_PROFILE_FUNCTION();
     for (auto &layer : m_layers) {
+        SD_PROFILE_SCOPE(layer->GetName() + "::OnRender");
         layer->OnRender();
     }
 
     if (m_imgui_layer) {
         m_imgui_layer->Begin();
         for (auto &layer : m_layers) {
+            SD_PROFILE_SCOPE(layer->GetName() + "::OnImGui");
             layer->OnImGui();
         }
         m_imgui_layer->End();
     }
 
+    SD_PROFILE_SCOPE("SwapBuffer");
     m_window->SwapBuffer();
 }
 
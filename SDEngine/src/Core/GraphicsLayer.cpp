@@ -3,6 +3,10 @@
 #include "ImGui/ImGuiWidget.hpp"
 #include "Renderer/Renderer2D.hpp"
 #include "Renderer/Renderer3D.hpp"
+#include "Renderer/GPUProfiler.hpp"
+#include "Utility/Profiler.hpp"
+#include "Utility/Metrics.hpp"
+#include "Utility/Exception.hpp"
 #include "ECS/Component.hpp"
 #include "Resource/Resource.hpp"
 
@@ -10,6 +14,19 @@ namespace SD {
 
 inline const Vector2f icon_size(5.f);
 
+// Buffers are allocated in steps of this many pixels, so small changes of
+// the output size fit in them.
+static const int32_t BUFFER_SIZE_STEP = 128;
+// Frames the output size has to stay the same before the buffers are
+// refitted to it.
+static const int32_t RESIZE_SETTLE_FRAMES = 30;
+
+static int32_t GetBufferSize(int32_t size)
+{
+    return (std::max(size, 1) + BUFFER_SIZE_STEP - 1) / BUFFER_SIZE_STEP *
+           BUFFER_SIZE_STEP;
+}
+
 GraphicsLayer::GraphicsLayer(ResourceManager *resources, SceneManager *scenes,
                              Device *device, int32_t width, int32_t height,
                              MultiSampleLevel msaa)
@@ -19,35 +36,50 @@ GraphicsLayer::GraphicsLayer(ResourceManager *resources, SceneManager *scenes,
       m_device(device),
       m_width(width),
       m_height(height),
+      m_buffer_width(GetBufferSize(width)),
+      m_buffer_height(GetBufferSize(height)),
+      m_resize_frames(RESIZE_SETTLE_FRAMES),
       m_msaa(msaa),
       m_color_output(nullptr),
       m_color_output_attachment(0),
+      m_render_width(width),
+      m_render_height(height),
       m_fps(20)
 {
     m_main_target = Framebuffer::Create();
+    m_resolve_target = Framebuffer::Create();
     InitBuffers();
     Renderer::Init(m_device);
     Renderer2D::Init(m_resources->shaders);
     Renderer3D::Init();
     SkyboxRenderPass::Init(m_resources->shaders,
                            m_resources->textures.Get("skybox/default").Get());
-    PostProcessRenderPass::Init(PostProcessSettings{m_width, m_height},
-                                m_device, m_resources->shaders);
-    DeferredRenderPass::Init(DeferredRenderSettings{m_width, m_height, m_msaa},
-                             m_device, m_resources->shaders,
-                             m_resources->models);
+    PostProcessRenderPass::Init(
+        PostProcessSettings{m_buffer_width, m_buffer_height}, m_device,
+        m_resources->shaders);
+    DeferredRenderPass::Init(
+        DeferredRenderSettings{m_buffer_width, m_buffer_height, m_msaa},
+        m_device, m_resources->shaders, m_resources->models);
     SpriteRenderPass::Init(m_resources->textures);
     m_light_icon = m_resources->textures.Get("icon/light");
 }
 
 void GraphicsLayer::InitBuffers()
 {
-    m_color_buffer = Texture::Create(m_width, m_height, 1, m_msaa,
-                                     TextureType::Normal2D, DataFormat::RGBA8);
-    m_depth_buffer =
-        Renderbuffer::Create(m_width, m_height, m_msaa, DataFormat::Depth24);
+    m_color_buffer =
+        Texture::Create(m_buffer_width, m_buffer_height, 1, m_msaa,
+                        TextureType::Normal2D, DataFormat::RGBA8);
+    m_depth_buffer = Renderbuffer::Create(m_buffer_width, m_buffer_height,
+                                          m_msaa, DataFormat::Depth24);
     m_main_target->Attach(*m_color_buffer, 0, 0);
     m_main_target->Attach(*m_depth_buffer, 0);
+    if (m_msaa != MultiSampleLevel::None) {
+        m_resolve_buffer =
+            Texture::Create(m_buffer_width, m_buffer_height, 1,
+                            MultiSampleLevel::None, TextureType::Normal2D,
+                            DataFormat::RGBA8);
+        m_resolve_target->Attach(*m_resolve_buffer, 0, 0);
+    }
 }
 
 void GraphicsLayer::OutputColorBuffer(Framebuffer *framebuffer, int attachment)
@@ -73,6 +105,20 @@ void GraphicsLayer::SetRenderSize(int32_t width, int32_t height)
 {
     m_width = width;
     m_height = height;
+    m_resize_frames = 0;
+    // Grow past the size while it is changing, the frame is drawn to the
+    // bottom left of the buffers until they are refitted.
+    if (width > m_buffer_width || height > m_buffer_height) {
+        ResizeBuffers(
+            std::max(GetBufferSize(width + width / 4), m_buffer_width),
+            std::max(GetBufferSize(height + height / 4), m_buffer_height));
+    }
+}
+
+void GraphicsLayer::ResizeBuffers(int32_t width, int32_t height)
+{
+    m_buffer_width = width;
+    m_buffer_height = height;
     InitBuffers();
 
     DeferredRenderPass::SetRenderSize(width, height);
@@ -84,33 +130,59 @@ void GraphicsLayer::SetCamera(Camera *camera) { m_camera = camera; }
 void GraphicsLayer::OnRender()
 {
     Scene *scene = m_scenes->GetCurrentScene();
+    scene->UpdateTransforms();
     // update camera transform
     auto view = scene->view<CameraComponent, TransformComponent>();
     view.each([](CameraComponent &camComp, TransformComponent &trans) {
         camComp.camera.SetWorldTransform(trans.GetWorldTransform().GetMatrix());
     });
 
-    Renderer::BeginRenderPass({m_main_target.get(), m_width, m_height});
+    if (m_resize_frames < RESIZE_SETTLE_FRAMES &&
+        ++m_resize_frames == RESIZE_SETTLE_FRAMES) {
+        const int32_t width = GetBufferSize(m_width);
+        const int32_t height = GetBufferSize(m_height);
+        if (width != m_buffer_width || height != m_buffer_height) {
+            ResizeBuffers(width, height);
+        }
+    }
+
+    // Scale the frame from the time the last ones took, the buffers keep
+    // their size.
+    GPUProfiler::BeginFrame();
+    m_resolution.BeginFrame();
+    const Vector2i render_size = m_resolution.GetRenderSize(m_width, m_height);
+    m_render_width = render_size.x;
+    m_render_height = render_size.y;
+    DeferredRenderPass::SetViewportSize(m_render_width, m_render_height);
+    PostProcessRenderPass::SetViewportSize(m_render_width, m_render_height);
+    Renderer::SetRenderScale(Vector2f(render_size) /
+                             Vector2f(m_buffer_width, m_buffer_height));
+
+    Renderer::BeginRenderPass(
+        {m_main_target.get(), m_render_width, m_render_height});
     Renderer::SetCamera(*m_camera);
     uint32_t id = static_cast<uint32_t>(entt::null);
     m_main_target->ClearAttachment(1, &id);
 
     // main render pipeline
-    m_deferred_time = 0;
-    m_post_rendering_time = 0;
-    Clock clock;
-
-    SkyboxRenderPass::Render();
-    clock.Restart();
-
-    DeferredRenderPass::Render(*scene);
-    m_deferred_time += clock.Restart();
-
-    SpriteRenderPass::Render(*scene);
-    clock.Restart();
-
-    PostProcessRenderPass::Render();
-    m_post_rendering_time += clock.Restart();
+    m_graph.Reset();
+    const RenderGraph::Resource color =
+        m_graph.Import("SceneColor", m_color_buffer.get());
+    m_graph.AddPass(
+        "Skybox",
+        [&](RenderGraph::PassBuilder &builder) { builder.Write(color); },
+        [](const RenderGraph &) { SkyboxRenderPass::Render(); });
+    DeferredRenderPass::AddPasses(m_graph, *scene, color);
+    m_graph.AddPass(
+        "Sprite",
+        [&](RenderGraph::PassBuilder &builder) {
+            builder.Read(color);
+            builder.Write(color);
+        },
+        [scene](const RenderGraph &) { SpriteRenderPass::Render(*scene); });
+    PostProcessRenderPass::AddPasses(m_graph, color);
+    m_graph.Compile();
+    m_graph.Execute();
 
     if (m_debug) {
         const int index[] = {0, 1};
@@ -137,23 +209,42 @@ void GraphicsLayer::OnRender()
     SD_CORE_ASSERT(Renderer::IsEmptyStack(),
                    "DEBUG: RenderPass Begin/End not pair!")
 
-    // Blit output
-    m_device->ReadBuffer(m_main_target.get(), 0);
+    // Blit output, upscaled from the render size
+    const bool is_scaled =
+        m_render_width != m_width || m_render_height != m_height;
+    const Framebuffer *src = m_main_target.get();
+    if (is_scaled && m_resolve_buffer) {
+        // Multisampled framebuffers only blit at the same size.
+        m_device->ReadBuffer(src, 0);
+        m_device->DrawBuffer(m_resolve_target.get(), 0);
+        m_device->BlitFramebuffer(src, 0, 0, m_render_width, m_render_height,
+                                  m_resolve_target.get(), 0, 0,
+                                  m_render_width, m_render_height,
+                                  BufferBitMask::ColorBufferBit,
+                                  BlitFilter::Nearest);
+        src = m_resolve_target.get();
+    }
+    m_device->ReadBuffer(src, 0);
     if (m_color_output ||
         (m_color_output == nullptr && m_color_output_attachment == 0)) {
         m_device->DrawBuffer(m_color_output, m_color_output_attachment);
-        m_device->BlitFramebuffer(m_main_target.get(), 0, 0, m_width, m_height,
-                                  m_color_output, 0, 0, m_width, m_height,
-                                  BufferBitMask::ColorBufferBit,
-                                  BlitFilter::Nearest);
+        m_device->BlitFramebuffer(
+            src, 0, 0, m_render_width, m_render_height, m_color_output, 0, 0,
+            m_width, m_height, BufferBitMask::ColorBufferBit,
+            is_scaled ? BlitFilter::Linear : BlitFilter::Nearest);
     }
+    m_resolution.EndFrame();
+    GPUProfiler::EndFrame();
 }
 
 uint32_t GraphicsLayer::ReadEntityId(int x, int y) const
 {
     uint32_t id = -1;
+    // The ids are drawn at the render size.
+    x = x * m_render_width / m_width;
+    y = y * m_render_height / m_height;
     const Texture *entity_buffer = DeferredRenderPass::GetEntityBuffer();
-    if (x >= 0 && y >= 0 && x < entity_buffer->GetWidth() &&
+    if (entity_buffer && x >= 0 && y >= 0 && x < entity_buffer->GetWidth() &&
         y < entity_buffer->GetHeight()) {
         entity_buffer->ReadPixels(0, x, y, 0, 1, 1, 1, sizeof(id), &id);
     }
@@ -171,31 +262,82 @@ void GraphicsLayer::OnImGui()
         {
             if (ImGui::TreeNodeEx("Profiles",
                                   flags | ImGuiTreeNodeFlags_DefaultOpen)) {
-                ImGui::TextUnformatted("Renderer2D Debug Info:");
-                ImGui::TextWrapped("%s", Renderer2D::GetDebugInfo().c_str());
-                ImGui::TextUnformatted("Renderer3D Debug Info:");
-                ImGui::TextWrapped("%s", Renderer3D::GetDebugInfo().c_str());
                 ImGui::Text("FPS:%.2f(%.2f ms)", m_fps.GetFPS(),
                             m_fps.GetFrameTime());
+                int window = Metrics::GetWindow();
+                if (ImGui::InputInt("Window (frames)", &window)) {
+                    Metrics::SetWindow(std::max(window, 1));
+                }
+                const std::pair<const char *, MetricsFormat> dumps[] = {
+                    {"metrics.csv", MetricsFormat::CSV},
+                    {"metrics.json", MetricsFormat::JSON}};
+                for (const auto &[path, format] : dumps) {
+                    if (ImGui::Button(path)) {
+                        try {
+                            Metrics::SetDump(path, format);
+                            SD_CORE_INFO("Dumping metrics to {}", path);
+                        }
+                        catch (const Exception &e) {
+                            SD_CORE_ERROR("{}", e.what());
+                        }
+                    }
+                    ImGui::SameLine();
+                }
+                if (ImGui::Button("Stop Dump")) {
+                    Metrics::SetDump("", MetricsFormat::CSV);
+                }
+                ImGui::DrawMetrics(Metrics::GetMetrics());
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNodeEx("GPU Profiler", flags)) {
+                GPUProfiler::ImGui();
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNodeEx("CPU Profiler", flags)) {
+                bool enabled = Profiler::IsEnabled();
+                if (ImGui::Checkbox("Enabled", &enabled)) {
+                    Profiler::SetEnabled(enabled);
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Export Trace")) {
+                    const std::string path = "cpu_trace.json";
+                    try {
+                        Profiler::ExportChromeTrace(path);
+                        SD_CORE_INFO("CPU trace exported to {}", path);
+                    }
+                    catch (const Exception &e) {
+                        SD_CORE_ERROR("{}", e.what());
+                    }
+                }
+                // Last second of the main thread.
+                const uint64_t now = Profiler::Now();
+                const uint64_t window = 1'000'000'000;
+                ImGui::DrawFlameGraph(Profiler::Collect(
+                    Profiler::GetThreadId(), now > window ? now - window : 0));
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNodeEx("Dynamic Resolution", flags)) {
+                m_resolution.ImGui();
+                ImGui::Text("Render Size: %dx%d of %dx%d", m_render_width,
+                            m_render_height, m_width, m_height);
+                ImGui::Text("Buffer Size: %dx%d", m_buffer_width,
+                            m_buffer_height);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNodeEx("Render Graph", flags)) {
+                m_graph.ImGui();
                 ImGui::TreePop();
             }
             if (ImGui::TreeNodeEx("Deferred Render Pass", flags)) {
-                ImGui::TextUnformatted("Deferred Rendering Time:");
-                ImGui::TextWrapped("%.2f ms", m_deferred_time);
                 DeferredRenderPass::ImGui();
                 ImGui::TreePop();
             }
             if (ImGui::TreeNodeEx("Post Process Render Pass", flags)) {
-                ImGui::TextUnformatted("Post Process Rendering Time:");
-                ImGui::TextWrapped("%.2f ms", m_post_rendering_time);
                 PostProcessRenderPass::ImGui();
                 ImGui::TreePop();
             }
         }
         ImGui::End();
-        // Reset debug info
-        Renderer2D::Reset();
-        Renderer3D::Reset();
     }
 }
 
@@ -7,45 +7,25 @@ TransformComponent::TransformComponent() : parent(entt::null) {}
 void TransformComponent::SetLocalPosition(const Vector3f &position)
 {
     m_local_transform.SetPosition(position);
-    UpdateGlobalPosition();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-    }
+    MarkDirty();
 }
 
 void TransformComponent::SetLocalRotation(const Quaternion &rotation)
 {
     m_local_transform.SetRotation(rotation);
-    UpdateGlobalRotation();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalRotation();
-
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-    }
+    MarkDirty();
 }
 
 void TransformComponent::SetLocalScale(const Vector3f &scale)
 {
     m_local_transform.SetScale(scale);
-    UpdateGlobalScale();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalScale();
-
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-    }
+    MarkDirty();
 }
 
 void TransformComponent::SetLocalTransform(const Matrix4f &trans)
 {
     m_local_transform.SetTransform(trans);
-    UpdateGlobalScale();
-    UpdateGlobalRotation();
-    UpdateGlobalPosition();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalScale();
-        ecs->get<TransformComponent>(child).UpdateGlobalRotation();
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-    }
+    MarkDirty();
 }
 
 Vector3f TransformComponent::GetLocalPosition() const
@@ -70,65 +50,54 @@ const Transform &TransformComponent::GetLocalTransform() const
 
 void TransformComponent::SetWorldPosition(const Vector3f &position)
 {
+    UpdateWorldTransform();
     m_world_transform.SetPosition(position);
-    UpdateLocalPosition();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-    }
+    UpdateLocalTransform();
+    MarkChildrenDirty();
 }
 
 void TransformComponent::SetWorldRotation(const Quaternion &rotation)
 {
+    UpdateWorldTransform();
     m_world_transform.SetRotation(rotation);
-    UpdateLocalRotation();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalRotation();
-
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-    }
+    UpdateLocalTransform();
+    MarkChildrenDirty();
 }
 
 void TransformComponent::SetWorldScale(const Vector3f &scale)
 {
+    UpdateWorldTransform();
     m_world_transform.SetScale(scale);
-    UpdateLocalScale();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalScale();
-
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-    }
+    UpdateLocalTransform();
+    MarkChildrenDirty();
 }
 
 void TransformComponent::SetWorldTransform(const Matrix4f &trans)
 {
+    UpdateWorldTransform();
     m_world_transform.SetTransform(trans);
-    UpdateLocalPosition();
-    UpdateLocalRotation();
-    UpdateLocalScale();
-    for (auto child : children) {
-        ecs->get<TransformComponent>(child).UpdateGlobalPosition();
-        ecs->get<TransformComponent>(child).UpdateGlobalRotation();
-        ecs->get<TransformComponent>(child).UpdateGlobalScale();
-    }
+    UpdateLocalTransform();
+    MarkChildrenDirty();
 }
 
 Vector3f TransformComponent::GetWorldPosition() const
 {
-    return m_world_transform.GetPosition();
+    return GetWorldTransform().GetPosition();
 }
 
 Quaternion TransformComponent::GetWorldRotation() const
 {
-    return m_world_transform.GetRotation();
+    return GetWorldTransform().GetRotation();
 }
 
 Vector3f TransformComponent::GetWorldScale() const
 {
-    return m_world_transform.GetScale();
+    return GetWorldTransform().GetScale();
 }
 
 const Transform &TransformComponent::GetWorldTransform() const
 {
+    UpdateWorldTransform();
     return m_world_transform;
 }
 
@@ -149,106 +118,69 @@ Vector3f TransformComponent::GetLocalFront() const
 
 Vector3f TransformComponent::GetWorldRight() const
 {
-    return m_world_transform.GetRotation() * Vector3f(1.f, 0.f, 0.f);
+    return GetWorldRotation() * Vector3f(1.f, 0.f, 0.f);
 }
 
 Vector3f TransformComponent::GetWorldUp() const
 {
-    return m_world_transform.GetRotation() * Vector3f(0.f, 1.f, 0.f);
+    return GetWorldRotation() * Vector3f(0.f, 1.f, 0.f);
 }
 
 Vector3f TransformComponent::GetWorldFront() const
 {
-    return m_world_transform.GetRotation() * Vector3f(0.f, 0.f, 1.f);
+    return GetWorldRotation() * Vector3f(0.f, 0.f, 1.f);
 }
 
-void TransformComponent::UpdateGlobalPosition()
+void TransformComponent::MarkDirty()
 {
-    if (parent == entt::null)
-        m_world_transform.SetPosition(m_local_transform.GetPosition());
-    else {
-        Matrix4f global =
-            ecs->get<TransformComponent>(parent).m_world_transform.GetMatrix() *
-            m_local_transform.GetMatrix();
-        m_world_transform.SetPosition(global[3]);
-    }
-    for (auto child : children) {
-        auto &t = ecs->get<TransformComponent>(child);
-        t.UpdateGlobalPosition();
-    }
-}
+    if (m_dirty) return;
 
-void TransformComponent::UpdateGlobalRotation()
-{
-    if (parent == entt::null)
-        m_world_transform.SetRotation(m_local_transform.GetRotation());
-    else {
-        Matrix4f global = glm::toMat4(ecs->get<TransformComponent>(parent)
-                                          .m_world_transform.GetRotation() *
-                                      m_local_transform.GetRotation());
-        m_world_transform.SetRotation(Quaternion(global));
-    }
-    for (auto child : children) {
-        auto &t = ecs->get<TransformComponent>(child);
-        t.UpdateGlobalRotation();
-    }
+    m_dirty = true;
+    MarkChildrenDirty();
 }
 
-void TransformComponent::UpdateGlobalScale()
+void TransformComponent::MarkChildrenDirty()
 {
-    if (parent == entt::null)
-        m_world_transform.SetScale(m_local_transform.GetScale());
-    else {
-        Matrix4f global =
-            glm::scale(Matrix4f(1.0f), ecs->get<TransformComponent>(parent)
-                                           .m_world_transform.GetScale()) *
-            glm::scale(Matrix4f(1.0f), m_local_transform.GetScale());
-        m_world_transform.SetScale(
-            Vector3f(global[0][0], global[1][1], global[2][2]));
-    }
     for (auto child : children) {
-        auto &t = ecs->get<TransformComponent>(child);
-        t.UpdateGlobalScale();
+        ecs->get<TransformComponent>(child).MarkDirty();
     }
 }
 
-void TransformComponent::UpdateLocalPosition()
+void TransformComponent::UpdateWorldTransform() const
 {
-    if (parent == entt::null)
-        m_local_transform.SetPosition(m_world_transform.GetPosition());
-    else {
-        Matrix4f global = glm::inverse(ecs->get<TransformComponent>(parent)
-                                           .m_world_transform.GetMatrix()) *
-                          m_world_transform.GetMatrix();
-        m_local_transform.SetPosition(global[3]);
-    }
-}
+    if (!m_dirty) return;
 
-void TransformComponent::UpdateLocalRotation()
-{
-    if (parent == entt::null)
-        m_local_transform.SetRotation(m_world_transform.GetRotation());
-    else {
-        Matrix4f global =
-            glm::inverse(glm::toMat4(ecs->get<TransformComponent>(parent)
-                                         .m_world_transform.GetRotation())) *
-            glm::toMat4(m_world_transform.GetRotation());
-        m_local_transform.SetRotation(Quaternion(global));
+    m_dirty = false;
+    if (parent == entt::null) {
+        m_world_transform = m_local_transform;
+        return;
     }
+    const Transform &parent_world =
+        ecs->get<TransformComponent>(parent).GetWorldTransform();
+    m_world_transform.SetPosition(Vector3f(
+        parent_world.GetMatrix() *
+        Vector4f(m_local_transform.GetPosition(), 1.f)));
+    m_world_transform.SetRotation(parent_world.GetRotation() *
+                                  m_local_transform.GetRotation());
+    m_world_transform.SetScale(parent_world.GetScale() *
+                               m_local_transform.GetScale());
 }
 
-void TransformComponent::UpdateLocalScale()
+void TransformComponent::UpdateLocalTransform()
 {
-    if (parent == entt::null)
-        m_local_transform.SetScale(m_local_transform.GetScale());
-    else {
-        Matrix4f global =
-            glm::inverse(
-                glm::scale(Matrix4f(1.0f), ecs->get<TransformComponent>(parent)
-                                               .m_world_transform.GetScale())) *
-            glm::scale(Matrix4f(1.0f), m_world_transform.GetScale());
-        m_local_transform.SetScale(
-            Vector3f(global[0][0], global[1][1], global[2][2]));
+    if (parent == entt::null) {
+        m_local_transform = m_world_transform;
+        return;
     }
+    const Transform &parent_world =
+        ecs->get<TransformComponent>(parent).GetWorldTransform();
+    m_local_transform.SetPosition(Vector3f(
+        glm::inverse(parent_world.GetMatrix()) *
+        Vector4f(m_world_transform.GetPosition(), 1.f)));
+    m_local_transform.SetRotation(glm::inverse(parent_world.GetRotation()) *
+                                  m_world_transform.GetRotation());
+    m_local_transform.SetScale(m_world_transform.GetScale() /
+                               parent_world.GetScale());
 }
+
 }  // namespace SD
@@ -50,11 +50,12 @@ void Entity::AddChild(Entity &child)
     if (old_parent) {
         old_parent.RemoveChild(child);
     }
+    // The child keeps its world transform.
+    child_data.UpdateWorldTransform();
     data.children.emplace(child);
     child_data.parent = *this;
-    child_data.UpdateLocalPosition();
-    child_data.UpdateLocalRotation();
-    child_data.UpdateLocalScale();
+    child_data.UpdateLocalTransform();
+    m_scene->MarkHierarchyChanged();
 }
 
 void Entity::RemoveChild(Entity &child)
@@ -68,10 +69,10 @@ void Entity::RemoveChild(Entity &child)
         SD_CORE_WARN("Entity cannot find specified child!");
     }
     auto &child_data = child.GetComponent<TransformComponent>();
+    child_data.UpdateWorldTransform();
     child_data.parent = Entity();
-    child_data.UpdateLocalPosition();
-    child_data.UpdateLocalRotation();
-    child_data.UpdateLocalScale();
+    child_data.UpdateLocalTransform();
+    m_scene->MarkHierarchyChanged();
 }
 
 Entity::operator bool() const
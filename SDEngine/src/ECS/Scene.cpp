@@ -17,6 +17,11 @@ Scene::Scene(std::string name) : name(std::move(name))
     RegisterComponent<CameraComponent>();
     RegisterComponent<SpriteComponent>();
     RegisterComponent<SpriteAnimationComponent>();
+
+    on_construct<TransformComponent>()
+        .connect<&Scene::OnTransformChanged>(*this);
+    on_destroy<TransformComponent>()
+        .connect<&Scene::OnTransformChanged>(*this);
 }
 
 Entity Scene::CreateEntity(const std::string &name)
@@ -47,6 +52,40 @@ Entity Scene::CloneEntity(EntityId from)
     return to_entity;
 }
 
+static void SetDepth(Scene &scene, EntityId entity, uint32_t depth)
+{
+    auto &transform = scene.get<TransformComponent>(entity);
+    transform.depth = depth;
+    for (EntityId child : transform.children) {
+        SetDepth(scene, child, depth + 1);
+    }
+}
+
+void Scene::UpdateTransforms()
+{
+    auto transforms = view<TransformComponent>();
+    if (m_hierarchy_changed) {
+        m_hierarchy_changed = false;
+        for (EntityId entity : transforms) {
+            if (transforms.get<TransformComponent>(entity).parent ==
+                entt::null) {
+                SetDepth(*this, entity, 0);
+            }
+        }
+        sort<TransformComponent>(
+            [](const TransformComponent &lhs, const TransformComponent &rhs) {
+                return lhs.depth < rhs.depth;
+            });
+    }
+    // Parents come first, so each update reads an up to date parent.
+    for (EntityId entity : transforms) {
+        const auto &transform = transforms.get<TransformComponent>(entity);
+        if (transform.IsDirty()) {
+            transform.UpdateWorldTransform();
+        }
+    }
+}
+
 void Scene::Serialize(cereal::PortableBinaryOutputArchive &archive) const
 {
     entt::snapshot loader{*this};
@@ -50,6 +50,22 @@ Ref<UniformBuffer> UniformBuffer::Create(const void *data, size_t size,
     return ub;
 }
 
+Ref<ShaderStorageBuffer> ShaderStorageBuffer::Create(const void *data,
+                                                     size_t size,
+                                                     BufferIOType io)
+{
+    Ref<ShaderStorageBuffer> sb;
+    switch (Device::GetAPI()) {
+        case Device::API::OpenGL:
+            sb = CreateRef<GLShaderStorageBuffer>(data, size, io);
+            break;
+        default:
+            SD_CORE_ERROR("Unsupported API!");
+            break;
+    }
+    return sb;
+}
+
 IndexBuffer::IndexBuffer(uint32_t count) : m_count(count) {}
 
 uint32_t IndexBuffer::GetCount() const { return m_count; }
@@ -2,26 +2,54 @@
 
 namespace SD {
 
-CascadeShadow::CascadeShadow() : m_cascade_planes{1, 100, 500, 1000} {}
+CascadeShadow::CascadeShadow()
+    : m_width(0), m_height(0), m_cascade_planes{1, 100, 500, 1000}
+{
+}
+
+static Ref<Texture> CreateCascadeMap(int32_t width, int32_t height,
+                                     int32_t num_of_cascades)
+{
+    const float color[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    Ref<Texture> map = Texture::Create(width, height, num_of_cascades,
+                                      MultiSampleLevel::None,
+                                      TextureType::Array, DataFormat::Depth24);
+    map->SetWrap(TextureWrap::Border);
+    map->SetBorderColor(&color);
+    return map;
+}
 
 void CascadeShadow::CreateShadowMap(int32_t width, int32_t height)
 {
     m_width = width;
     m_height = height;
     m_cascade_fb = Framebuffer::Create();
-    const float color[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    m_cascade_map = Texture::Create(m_width, m_height, m_cascade_planes.size(),
-                                    MultiSampleLevel::None, TextureType::Array,
-                                    DataFormat::Depth24);
-    m_cascade_map->SetWrap(TextureWrap::Border);
-    m_cascade_map->SetBorderColor(&color);
+    m_cascade_map =
+        CreateCascadeMap(m_width, m_height, m_cascade_planes.size());
     m_cascade_fb->Attach(*m_cascade_map, 0, 0);
+    m_static_fb.reset();
+    m_static_map.reset();
+    m_versions.assign(m_cascade_planes.size(), 0);
+    m_static_versions.assign(m_cascade_planes.size(), 0);
+}
+
+void CascadeShadow::CreateStaticShadowMap()
+{
+    m_static_fb = Framebuffer::Create();
+    m_static_map =
+        CreateCascadeMap(m_width, m_height, m_cascade_planes.size());
+    m_static_fb->Attach(*m_static_map, 0, 0);
+    m_static_versions.assign(m_cascade_planes.size(), 0);
 }
 
 void CascadeShadow::DestroyShadowMap()
 {
     m_cascade_fb.reset();
     m_cascade_map.reset();
+    m_static_fb.reset();
+    m_static_map.reset();
+    m_versions.clear();
+    m_static_versions.clear();
 }
 
 void CascadeShadow::SetNumOfCascades(int32_t num_of_cascades)
@@ -47,8 +75,13 @@ static std::vector<Vector4f> GetFrustumCorners(const Matrix4f &project_view)
     return corners;
 }
 
+// The cascade is fit to the bounding sphere of its frustum slice, so its size
+// does not change as the camera rotates, and its center is snapped to whole
+// shadow map texels in light space, so the map does not shimmer as the camera
+// moves or while the cascade is not updated.
 static Matrix4f GetLightSpaceMatrix(const Transform &transform,
-                                    const Matrix4f &projection_view)
+                                    const Matrix4f &projection_view,
+                                    int32_t resolution)
 {
     Vector3f center(0);
     auto corners = GetFrustumCorners(projection_view);
@@ -57,21 +90,27 @@ static Matrix4f GetLightSpaceMatrix(const Transform &transform,
     }
     center /= corners.size();
 
+    float radius = 0;
+    for (const auto &c : corners) {
+        radius = std::max(radius, glm::distance(Vector3f(c), center));
+    }
+    radius = std::ceil(radius * 16.f) / 16.f;
+
+    const float texel = 2.f * radius / std::max(resolution, 1);
+    const Matrix4f light_rotation =
+        glm::lookAt(-transform.GetFront(), Vector3f(0), transform.GetUp());
+    Vector4f light_center = light_rotation * Vector4f(center, 1.0f);
+    light_center.x = std::floor(light_center.x / texel) * texel;
+    light_center.y = std::floor(light_center.y / texel) * texel;
+    center = Vector3f(glm::inverse(light_rotation) * light_center);
+
     const auto light_view =
         glm::lookAt(center - transform.GetFront(), center, transform.GetUp());
 
-    float min_x = std::numeric_limits<float>::max();
-    float max_x = std::numeric_limits<float>::min();
-    float min_y = std::numeric_limits<float>::max();
-    float max_y = std::numeric_limits<float>::min();
     float min_z = std::numeric_limits<float>::max();
-    float max_z = std::numeric_limits<float>::min();
+    float max_z = std::numeric_limits<float>::lowest();
     for (const auto &pt : corners) {
         const auto trf = light_view * pt;
-        min_x = std::min(min_x, trf.x);
-        max_x = std::max(max_x, trf.x);
-        min_y = std::min(min_y, trf.y);
-        max_y = std::max(max_y, trf.y);
         min_z = std::min(min_z, trf.z);
         max_z = std::max(max_z, trf.z);
     }
@@ -79,24 +118,32 @@ static Matrix4f GetLightSpaceMatrix(const Transform &transform,
     min_z = min_z < 0 ? min_z * z_mult : min_z / z_mult;
     max_z = max_z < 0 ? max_z / z_mult : max_z * z_mult;
     const auto &light_proj =
-        glm::ortho(min_x, max_x, min_y, max_y, min_z, max_z);
+        glm::ortho(-radius, radius, -radius, radius, min_z, max_z);
     return light_proj * light_view;
 }
 
 void CascadeShadow::ComputeCascadeLightMatrix(const Transform &transform,
-                                              const Camera &camera)
+                                              const Camera &camera,
+                                              uint32_t level_mask)
 {
     const float fov = camera.GetFOV();
     const float aspect = camera.GetNearWidth() / camera.GetNearHeight();
     const uint32_t size = m_cascade_planes.size();
-    m_projection_views.resize(size);
+    if (m_projection_views.size() != size) {
+        m_projection_views.resize(size);
+        level_mask = ~0u;
+    }
     for (uint32_t i = 0; i < size; ++i) {
+        if ((level_mask & (1u << i)) == 0) continue;
+
         const float near_plane =
             i == 0 ? camera.GetNearZ() : m_cascade_planes[i - 1];
         const float far_plane = m_cascade_planes[i];
         m_projection_views[i] = GetLightSpaceMatrix(
-            transform, glm::perspective(fov, aspect, near_plane, far_plane) *
-                           camera.GetView());
+            transform,
+            glm::perspective(fov, aspect, near_plane, far_plane) *
+                camera.GetView(),
+            m_width);
     }
 }
 }  // namespace SD
@@ -1,9 +1,11 @@
 #include "Graphics/Device.hpp"
 #include "Graphics/OpenGL/GLDevice.hpp"
+#include "Utility/Metrics.hpp"
 
 namespace SD {
 
 static Device::API s_api = Device::API::OpenGL;
+static DeviceStatistics s_statistics;
 
 Device::API Device::GetAPI() { return s_api; }
 
@@ -24,4 +26,36 @@ Scope<Device> Device::Create()
     return device;
 }
 
+DeviceStatistics &Device::GetStatistics() { return s_statistics; }
+
+struct DeviceMetrics {
+    Metrics::Id draw_calls{Metrics::RegisterCounter("device.draw_calls")};
+    Metrics::Id triangles{Metrics::RegisterCounter("device.triangles")};
+    Metrics::Id uploaded_bytes{
+        Metrics::RegisterCounter("device.uploaded_bytes")};
+    Metrics::Id state_issued{Metrics::RegisterCounter("device.state_issued")};
+    Metrics::Id state_elided{Metrics::RegisterCounter("device.state_elided")};
+    Metrics::Id uniform_hits{Metrics::RegisterCounter("device.uniform_hits")};
+    Metrics::Id uniform_misses{
+        Metrics::RegisterCounter("device.uniform_misses")};
+    Metrics::Id texture_hits{Metrics::RegisterCounter("device.texture_hits")};
+    Metrics::Id texture_misses{
+        Metrics::RegisterCounter("device.texture_misses")};
+};
+
+void Device::PublishStatistics()
+{
+    static const DeviceMetrics metrics;
+    Metrics::Add(metrics.draw_calls, s_statistics.draw_calls);
+    Metrics::Add(metrics.triangles, s_statistics.triangles);
+    Metrics::Add(metrics.uploaded_bytes, s_statistics.uploaded_bytes);
+    Metrics::Add(metrics.state_issued, s_statistics.state_issued);
+    Metrics::Add(metrics.state_elided, s_statistics.state_elided);
+    Metrics::Add(metrics.uniform_hits, s_statistics.uniform_hits);
+    Metrics::Add(metrics.uniform_misses, s_statistics.uniform_misses);
+    Metrics::Add(metrics.texture_hits, s_statistics.texture_hits);
+    Metrics::Add(metrics.texture_misses, s_statistics.texture_misses);
+    s_statistics = DeviceStatistics();
+}
+
 }  // namespace SD
@@ -1,5 +1,29 @@
 #include "Graphics/Light.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace SD {
 
+float PointLight::GetRadius(float threshold) const
+{
+    const float intensity = std::max(
+        {ambient.r, ambient.g, ambient.b, diffuse.r, diffuse.g, diffuse.b,
+         specular.r, specular.g, specular.b});
+    if (intensity <= 0) return 0;
+
+    // Solve intensity / (constant + linear * d + quadratic * d^2) = threshold
+    const float c = constant - intensity / threshold;
+    if (c >= 0) return 0;
+    if (quadratic > 0) {
+        return (-linear + std::sqrt(linear * linear - 4 * quadratic * c)) /
+               (2 * quadratic);
+    }
+    if (linear > 0) {
+        return -c / linear;
+    }
+    return std::numeric_limits<float>::infinity();
+}
+
 }  // namespace SD
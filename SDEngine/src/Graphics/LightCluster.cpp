@@ -0,0 +1,168 @@
+#include "Graphics/LightCluster.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SD {
+
+LightCluster::LightCluster(uint32_t x, uint32_t y, uint32_t z)
+    : m_size_x(x),
+      m_size_y(y),
+      m_size_z(z),
+      m_projection(0),
+      m_near_z(0),
+      m_far_z(0),
+      m_perspective(true),
+      m_clusters(x * y * z, Cluster{0, 0})
+{
+}
+
+float LightCluster::GetSliceDepth(uint32_t slice) const
+{
+    const float t = static_cast<float>(slice) / m_size_z;
+    if (m_perspective) {
+        return m_near_z * std::pow(m_far_z / m_near_z, t);
+    }
+    return Math::Lerp(m_near_z, m_far_z, t);
+}
+
+uint32_t LightCluster::GetSlice(float depth) const
+{
+    float t = 0;
+    if (m_perspective) {
+        t = std::log(depth / m_near_z) / std::log(m_far_z / m_near_z);
+    }
+    else {
+        t = (depth - m_near_z) / (m_far_z - m_near_z);
+    }
+    const float slice = std::floor(t * m_size_z);
+    if (!(slice > 0)) return 0;
+    return std::min<float>(slice, m_size_z - 1);
+}
+
+void LightCluster::SetProjection(const Matrix4f &projection, float near_z,
+                                 float far_z)
+{
+    if (m_projection == projection && m_near_z == near_z &&
+        m_far_z == far_z) {
+        return;
+    }
+    m_projection = projection;
+    m_near_z = near_z;
+    m_far_z = far_z;
+    // A perspective projection has no w translation.
+    m_perspective = projection[3][3] == 0 && near_z > 0;
+
+    m_bounds.assign(m_size_x * m_size_y * m_size_z, Math::AABB());
+    m_column_bounds.assign(m_size_x * m_size_z, Math::AABB());
+    m_row_bounds.assign(m_size_y * m_size_z, Math::AABB());
+
+    // View space lines through the tile corners, from the near plane to the
+    // far plane.
+    const Matrix4f inv_projection = glm::inverse(projection);
+    auto unproject = [&inv_projection](float x, float y, float z) {
+        const Vector4f pos = inv_projection * Vector4f(x, y, z, 1.f);
+        return Vector3f(pos) / pos.w;
+    };
+    const uint32_t corners_x = m_size_x + 1;
+    const uint32_t corners_y = m_size_y + 1;
+    std::vector<Vector3f> near_corners(corners_x * corners_y);
+    std::vector<Vector3f> far_corners(corners_x * corners_y);
+    for (uint32_t y = 0; y < corners_y; ++y) {
+        for (uint32_t x = 0; x < corners_x; ++x) {
+            const float ndc_x = 2.f * x / m_size_x - 1.f;
+            const float ndc_y = 2.f * y / m_size_y - 1.f;
+            near_corners[y * corners_x + x] = unproject(ndc_x, ndc_y, -1.f);
+            far_corners[y * corners_x + x] = unproject(ndc_x, ndc_y, 1.f);
+        }
+    }
+    auto corner_at = [&](uint32_t corner, float depth) {
+        const Vector3f &near_pos = near_corners[corner];
+        const Vector3f &far_pos = far_corners[corner];
+        const float t = (depth + near_pos.z) / (near_pos.z - far_pos.z);
+        return near_pos + (far_pos - near_pos) * t;
+    };
+
+    for (uint32_t z = 0; z < m_size_z; ++z) {
+        const float depths[2] = {GetSliceDepth(z), GetSliceDepth(z + 1)};
+        for (uint32_t y = 0; y < m_size_y; ++y) {
+            for (uint32_t x = 0; x < m_size_x; ++x) {
+                Math::AABB &bound = m_bounds[GetClusterIndex(x, y, z)];
+                for (uint32_t i = 0; i < 4; ++i) {
+                    const uint32_t corner =
+                        (y + i / 2) * corners_x + (x + i % 2);
+                    bound.Merge(corner_at(corner, depths[0]));
+                    bound.Merge(corner_at(corner, depths[1]));
+                }
+                Math::AABB &column = m_column_bounds[z * m_size_x + x];
+                column.Merge(bound.min);
+                column.Merge(bound.max);
+                Math::AABB &row = m_row_bounds[z * m_size_y + y];
+                row.Merge(bound.min);
+                row.Merge(bound.max);
+            }
+        }
+    }
+}
+
+void LightCluster::Assign(const Matrix4f &view,
+                          const std::vector<Math::BoundingSphere> &lights)
+{
+    m_pairs.clear();
+    for (uint32_t i = 0; i < lights.size(); ++i) {
+        if (!lights[i].IsValid()) continue;
+
+        const Math::BoundingSphere sphere(
+            Vector3f(view * Vector4f(lights[i].center, 1.f)),
+            lights[i].radius);
+        const float depth = -sphere.center.z;
+        if (depth + sphere.radius < m_near_z ||
+            depth - sphere.radius > m_far_z) {
+            continue;
+        }
+        const uint32_t first_slice = GetSlice(depth - sphere.radius);
+        const uint32_t last_slice = GetSlice(depth + sphere.radius);
+        for (uint32_t z = first_slice; z <= last_slice; ++z) {
+            for (uint32_t y = 0; y < m_size_y; ++y) {
+                const Math::AABB &row = m_row_bounds[z * m_size_y + y];
+                if (sphere.center.y + sphere.radius < row.min.y ||
+                    sphere.center.y - sphere.radius > row.max.y) {
+                    continue;
+                }
+                for (uint32_t x = 0; x < m_size_x; ++x) {
+                    const Math::AABB &column =
+                        m_column_bounds[z * m_size_x + x];
+                    if (sphere.center.x + sphere.radius < column.min.x ||
+                        sphere.center.x - sphere.radius > column.max.x) {
+                        continue;
+                    }
+                    const uint32_t cluster = GetClusterIndex(x, y, z);
+                    if (m_bounds[cluster].Intersects(sphere)) {
+                        m_pairs.emplace_back(cluster, i);
+                    }
+                }
+            }
+        }
+    }
+
+    // Counting sort of the pairs by cluster.
+    for (auto &cluster : m_clusters) {
+        cluster = {0, 0};
+    }
+    for (const auto &[cluster, light] : m_pairs) {
+        ++m_clusters[cluster].count;
+    }
+    uint32_t offset = 0;
+    for (auto &cluster : m_clusters) {
+        cluster.offset = offset;
+        offset += cluster.count;
+        cluster.count = 0;
+    }
+    m_light_indices.resize(m_pairs.size());
+    for (const auto &[cluster, light] : m_pairs) {
+        Cluster &c = m_clusters[cluster];
+        m_light_indices[c.offset + c.count++] = light;
+    }
+}
+
+}  // namespace SD
@@ -1,5 +1,5 @@
 #include "Graphics/Material.hpp"
-#include <map>
+#include <unordered_map>
 
 namespace SD {
 
@@ -19,23 +19,29 @@ const std::string GetMaterialName(MaterialType type)
 }
 
 Material::Material()
-    : m_diffuse_base(1.0), m_ambient_base(1.0), m_emissive_base(0)
+    : m_textures{},
+      m_diffuse_base(1.0),
+      m_ambient_base(1.0),
+      m_emissive_base(0)
 {
 }
 
 void Material::SetTexture(MaterialType type, Texture* texture)
 {
-    m_textures[type] = texture;
+    m_textures[static_cast<size_t>(type)] = texture;
 }
 
 const Texture* Material::GetTexture(MaterialType type) const
 {
-    if (m_textures.count(type) == 0) {
-        return nullptr;
-    }
-    else {
-        return m_textures.at(type);
-    };
+    return m_textures[static_cast<size_t>(type)];
+}
+
+bool Material::operator==(const Material& other) const
+{
+    return m_textures == other.m_textures &&
+           m_diffuse_base == other.m_diffuse_base &&
+           m_ambient_base == other.m_ambient_base &&
+           m_emissive_base == other.m_emissive_base;
 }
 
 }  // namespace SD
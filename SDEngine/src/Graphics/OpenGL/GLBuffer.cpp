@@ -1,5 +1,6 @@
 #include "Graphics/OpenGL/GLBuffer.hpp"
 #include "Graphics/OpenGL/GLTranslator.hpp"
+#include "Graphics/Device.hpp"
 
 namespace SD {
 
@@ -24,6 +25,7 @@ void GLBuffer::UpdateData(const void *data, size_t size, size_t offset)
         }
         glNamedBufferSubData(m_id, offset, size, data);
     }
+    Device::GetStatistics().uploaded_bytes += size;
 }
 
 GLVertexBuffer::GLVertexBuffer(const void *data, size_t size, BufferIOType io)
@@ -56,4 +58,16 @@ GLUniformBuffer::GLUniformBuffer(const void *data, size_t size, BufferIOType io)
 
 uint32_t GLUniformBuffer::GetBindingPoint() const { return m_base; }
 
+uint32_t GLShaderStorageBuffer::s_count = 0;
+
+GLShaderStorageBuffer::GLShaderStorageBuffer(const void *data, size_t size,
+                                             BufferIOType io)
+    : GLBuffer(GL_SHADER_STORAGE_BUFFER, Translate(io), data, size)
+{
+    m_base = s_count++;
+    glBindBufferBase(m_type, m_base, m_id);
+}
+
+uint32_t GLShaderStorageBuffer::GetBindingPoint() const { return m_base; }
+
 }  // namespace SD
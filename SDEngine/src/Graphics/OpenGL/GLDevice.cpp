@@ -7,6 +7,8 @@
 #include "Graphics/VertexArray.hpp"
 #include <GL/glew.h>
 
+#include <algorithm>
+
 namespace SD {
 
 static void OpenGLMessageCallback(GLenum, GLenum, unsigned, GLenum severity,
@@ -32,8 +34,53 @@ static void OpenGLMessageCallback(GLenum, GLenum, unsigned, GLenum severity,
     }
 }
 
+static std::vector<uint32_t> s_texture_units;
+// Devices alive, whose cached bindings are reset when an object is deleted.
+static std::vector<GLDevice *> s_devices;
+
+// Update the cached state, return true if the call has to reach the driver.
+template <typename T>
+static bool UpdateState(T &state, const T &value)
+{
+    DeviceStatistics &statistics = Device::GetStatistics();
+    if (state == value) {
+        ++statistics.state_elided;
+        return false;
+    }
+    state = value;
+    ++statistics.state_issued;
+    return true;
+}
+
+// Count a draw of count vertices per instance.
+static void CountDraw(MeshTopology topology, size_t count, size_t instances)
+{
+    DeviceStatistics &statistics = Device::GetStatistics();
+    ++statistics.draw_calls;
+    switch (topology) {
+        case MeshTopology::Triangles:
+            statistics.triangles += count / 3 * instances;
+            break;
+        case MeshTopology::Quads:
+            statistics.triangles += count / 4 * 2 * instances;
+            break;
+        default:
+            break;
+    }
+}
+
 GLDevice::GLDevice()
+    : m_program(-1),
+      m_vertex_array(-1),
+      m_framebuffer(-1),
+      m_viewport{-1, -1, -1, -1},
+      m_operations{-1, -1, -1, -1, -1},
+      m_depth_mask(-1),
+      m_depth_func(-1),
+      m_cull_face(-1),
+      m_polygon_mode{-1, -1}
 {
+    s_devices.push_back(this);
     SD_CORE_ASSERT(glewInit() == GLEW_OK, "glewInit failed!");
 
     SD_CORE_INFO("---Graphics Card Info---");
@@ -50,6 +97,11 @@ GLDevice::GLDevice()
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+GLDevice::~GLDevice()
+{
+    s_devices.erase(std::find(s_devices.begin(), s_devices.end(), this));
+}
+
 void GLDevice::DispatchCompute(int32_t num_group_x, int32_t num_group_y,
                                int32_t num_group_z)
 {
@@ -65,18 +117,23 @@ void GLDevice::DrawElements(MeshTopology topology, int count, size_t offset)
 {
     glDrawElements(Translate(topology), count, GL_UNSIGNED_INT,
                    (const void *)offset);
+    CountDraw(topology, count, 1);
 }
 
 void GLDevice::DrawElementsInstanced(MeshTopology topology, int count,
-                                     size_t offset, size_t amount)
+                                     size_t offset, size_t amount,
+                                     size_t base_instance)
 {
-    glDrawElementsInstanced(Translate(topology), count, GL_UNSIGNED_INT,
-                            (const void *)offset, amount);
+    glDrawElementsInstancedBaseInstance(Translate(topology), count,
+                                        GL_UNSIGNED_INT, (const void *)offset,
+                                        amount, base_instance);
+    CountDraw(topology, count, amount);
 }
 
 void GLDevice::DrawArrays(MeshTopology topology, int first, int count)
 {
     glDrawArrays(Translate(topology), first, count);
+    CountDraw(topology, count, 1);
 }
 
 void GLDevice::SetLineWidth(float width) { glLineWidth(width); }
@@ -96,82 +153,116 @@ void GLDevice::Clear(BufferBitMask bit)
 
 void GLDevice::SetVertexArray(const VertexArray *vertexArray)
 {
-    if (vertexArray) {
-        glBindVertexArray(vertexArray->Handle());
-    }
-    else {
-        glBindVertexArray(0);
+    const uint32_t id = vertexArray ? vertexArray->Handle() : 0;
+    if (UpdateState<int64_t>(m_vertex_array, id)) {
+        glBindVertexArray(id);
     }
 }
 
 void GLDevice::SetShader(const Shader *shader)
 {
-    if (shader) {
-        glUseProgram(shader->Handle());
-    }
-    else {
-        glUseProgram(0);
+    const uint32_t id = shader ? shader->Handle() : 0;
+    if (UpdateState<int64_t>(m_program, id)) {
+        glUseProgram(id);
     }
 }
 
 void GLDevice::SetViewport(int x, int y, int width, int height)
 {
     // opengl define viewport origin at bottom-left
-    glViewport(x, y, width, height);
+    if (UpdateState<std::array<int, 4>>(m_viewport, {x, y, width, height})) {
+        glViewport(x, y, width, height);
+    }
+}
+
+void GLDevice::SetViewportIndexed(int index, int x, int y, int width,
+                                  int height)
+{
+    glViewportIndexedf(index, x, y, width, height);
+    // The cached viewport no longer holds for every index.
+    m_viewport = {-1, -1, -1, -1};
+    ++GetStatistics().state_issued;
 }
 
 void GLDevice::SetFramebuffer(const Framebuffer *framebuffer)
 {
-    if (framebuffer) {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->Handle());
-    }
-    else {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    const uint32_t id = framebuffer ? framebuffer->Handle() : 0;
+    if (UpdateState<int64_t>(m_framebuffer, id)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, id);
     }
 }
 
 void GLDevice::SetPolygonMode(PolygonMode mode, Face face)
 {
-    glPolygonMode(Translate(face), Translate(mode));
+    const GLenum gl_face = Translate(face);
+    const GLenum gl_mode = Translate(mode);
+    if (UpdateState<std::array<int32_t, 2>>(
+            m_polygon_mode, {static_cast<int32_t>(gl_face),
+                             static_cast<int32_t>(gl_mode)})) {
+        glPolygonMode(gl_face, gl_mode);
+    }
 }
 
-void GLDevice::SetDepthMask(bool depth_mask) { glDepthMask(depth_mask); }
+void GLDevice::SetDepthMask(bool depth_mask)
+{
+    if (UpdateState<int8_t>(m_depth_mask, depth_mask)) {
+        glDepthMask(depth_mask);
+    }
+}
 
-void GLDevice::Disable(Operation operation) { glDisable(Translate(operation)); }
+void GLDevice::Disable(Operation operation)
+{
+    if (UpdateState<int8_t>(m_operations[static_cast<int>(operation)], 0)) {
+        glDisable(Translate(operation));
+    }
+}
 
-void GLDevice::Enable(Operation operation) { glEnable(Translate(operation)); }
+void GLDevice::Enable(Operation operation)
+{
+    if (UpdateState<int8_t>(m_operations[static_cast<int>(operation)], 1)) {
+        glEnable(Translate(operation));
+    }
+}
 
-void GLDevice::SetCullFace(Face face) { glCullFace(Translate(face)); }
+void GLDevice::SetCullFace(Face face)
+{
+    const GLenum gl_face = Translate(face);
+    if (UpdateState<int32_t>(m_cull_face, gl_face)) {
+        glCullFace(gl_face);
+    }
+}
 
 void GLDevice::SetDepthfunc(DepthFunc depth_func)
 {
-    glDepthFunc(Translate(depth_func));
+    const GLenum gl_func = Translate(depth_func);
+    if (UpdateState<int32_t>(m_depth_func, gl_func)) {
+        glDepthFunc(gl_func);
+    }
 }
 
 void GLDevice::DrawBuffer(Framebuffer *fb, int buf)
 {
-    if (fb) {
-        glNamedFramebufferDrawBuffer(fb->Handle(), GL_COLOR_ATTACHMENT0 + buf);
-    }
-    else {
-        glNamedFramebufferDrawBuffer(0, GL_FRONT_LEFT + buf);
-    }
+    DrawBuffers(fb, 1, &buf);
 }
 
 void GLDevice::DrawBuffers(Framebuffer *fb, int n, const int *buf)
 {
+    // Draw buffers are framebuffer object state, the cache of a user created
+    // framebuffer lives in it.
     std::vector<GLenum> glbuf(n);
     if (fb) {
         std::generate(glbuf.begin(), glbuf.end(), [i = 0, buf]() mutable {
             return buf[i++] + GL_COLOR_ATTACHMENT0;
         });
-        glNamedFramebufferDrawBuffers(fb->Handle(), n, glbuf.data());
+        static_cast<GLFramebuffer *>(fb)->SetDrawBuffers(glbuf);
     }
     else {
         std::generate(glbuf.begin(), glbuf.end(), [i = 0, buf]() mutable {
             return buf[i++] + GL_FRONT_LEFT;
         });
-        glNamedFramebufferDrawBuffers(0, n, glbuf.data());
+        if (UpdateState(m_default_draw_buffers, glbuf)) {
+            glNamedFramebufferDrawBuffers(0, n, glbuf.data());
+        }
     }
 }
 
@@ -202,6 +293,56 @@ void GLDevice::BlitFramebuffer(const Framebuffer *src, int src_x, int src_y,
                            dst_y + dst_height, gl_mask, gl_filter);
 }
 
+void GLDevice::BindTextureUnit(int32_t unit, uint32_t texture)
+{
+    DeviceStatistics &statistics = Device::GetStatistics();
+    if (static_cast<int32_t>(s_texture_units.size()) <= unit) {
+        s_texture_units.resize(unit + 1, 0);
+    }
+    else if (s_texture_units[unit] == texture) {
+        ++statistics.texture_hits;
+        return;
+    }
+    s_texture_units[unit] = texture;
+    ++statistics.texture_misses;
+    glBindTextureUnit(unit, texture);
+}
+
+void GLDevice::ReleaseTexture(uint32_t texture)
+{
+    std::replace(s_texture_units.begin(), s_texture_units.end(), texture, 0u);
+}
+
+void GLDevice::ReleaseFramebuffer(uint32_t framebuffer)
+{
+    // GL binds the default framebuffer in place of a deleted one.
+    for (GLDevice *device : s_devices) {
+        if (device->m_framebuffer == framebuffer) {
+            device->m_framebuffer = 0;
+        }
+    }
+}
+
+void GLDevice::ReleaseVertexArray(uint32_t vertex_array)
+{
+    for (GLDevice *device : s_devices) {
+        if (device->m_vertex_array == vertex_array) {
+            device->m_vertex_array = 0;
+        }
+    }
+}
+
+void GLDevice::ReleaseProgram(uint32_t program)
+{
+    // A deleted program stays in use until another one is, so its state is
+    // not known.
+    for (GLDevice *device : s_devices) {
+        if (device->m_program == program) {
+            device->m_program = -1;
+        }
+    }
+}
+
 void GLDevice::ReadPixels(int x, int y, int width, int height,
                           DataFormat format, void *data)
 {
@@ -1,12 +1,18 @@
 #include "Graphics/OpenGL/GLFramebuffer.hpp"
 #include "Graphics/OpenGL/GLTranslator.hpp"
+#include "Graphics/OpenGL/GLDevice.hpp"
 #include "Graphics/Texture.hpp"
+#include "Graphics/Device.hpp"
 
 namespace SD {
 
 GLFramebuffer::GLFramebuffer() { glCreateFramebuffers(1, &m_id); }
 
-GLFramebuffer::~GLFramebuffer() { glDeleteFramebuffers(1, &m_id); }
+GLFramebuffer::~GLFramebuffer()
+{
+    GLDevice::ReleaseFramebuffer(m_id);
+    glDeleteFramebuffers(1, &m_id);
+}
 
 void GLFramebuffer::Attach(Texture &texture, int attachment, int level)
 {
@@ -63,9 +69,30 @@ void GLFramebuffer::Attach(Renderbuffer &buffer, int attachment)
                                    buffer.Handle());
 }
 
-void GLFramebuffer::Prepare()
+void GLFramebuffer::Detach(int attachment)
 {
-    glNamedFramebufferDrawBuffers(m_id, m_drawables.size(), m_drawables.data());
+    if (static_cast<int>(m_drawables.size()) <= attachment) return;
+
+    m_drawables[attachment] = GL_NONE;
+    if (static_cast<int>(m_textures.size()) > attachment) {
+        m_textures[attachment] = nullptr;
+    }
+    glNamedFramebufferTexture(m_id, GL_COLOR_ATTACHMENT0 + attachment, 0, 0);
+}
+
+void GLFramebuffer::Prepare() { SetDrawBuffers(m_drawables); }
+
+void GLFramebuffer::SetDrawBuffers(const std::vector<GLenum> &buffers)
+{
+    DeviceStatistics &statistics = Device::GetStatistics();
+    if (m_draw_buffers == buffers) {
+        ++statistics.state_elided;
+        return;
+    }
+    m_draw_buffers = buffers;
+    ++statistics.state_issued;
+    glNamedFramebufferDrawBuffers(m_id, m_draw_buffers.size(),
+                                  m_draw_buffers.data());
 }
 
 void GLFramebuffer::ClearDepth(const float depth)
@@ -1,8 +1,11 @@
 #include "Graphics/OpenGL/GLShader.hpp"
 #include "Graphics/OpenGL/GLBuffer.hpp"
+#include "Graphics/OpenGL/GLDevice.hpp"
 #include "Graphics/OpenGL/GLTexture.hpp"
 #include "Graphics/OpenGL/GLShaderParam.hpp"
 
+#include <algorithm>
+
 namespace SD {
 
 UniformType GetUniformType(GLenum gl_type)
@@ -88,6 +91,7 @@ GLShader::GLShader()
 
 GLShader::~GLShader()
 {
+    GLDevice::ReleaseProgram(m_id);
     glDeleteProgram(m_id);
     DestroyShaders();
 
@@ -110,17 +114,24 @@ int32_t GLShader::GetUniformBufferCount() const
     return count;
 }
 
-ShaderParam* GLShader::GetParam(const std::string& name)
+static bool CompareParamId(const std::pair<UniformId, ShaderParam*>& param,
+                           UniformId id)
 {
-    auto itr = m_params.find(name);
-    if (itr != m_params.end()) {
+    return param.first < id;
+}
+
+ShaderParam* GLShader::GetParam(UniformId id)
+{
+    auto itr =
+        std::lower_bound(m_params.begin(), m_params.end(), id, CompareParamId);
+    if (itr != m_params.end() && itr->first == id) {
         return itr->second;
     }
 
     SD_CORE_ASSERT(
         false,
-        fmt::format("No shader uniform variable corresponding to: \"{}\"",
-                    name));
+        fmt::format("No shader uniform variable corresponding to id: {:#x}",
+                    id.GetHash()));
     return nullptr;
 }
 
@@ -143,9 +154,14 @@ ShaderParam* GLShader::GetParam(int32_t index)
         return nullptr;
     }
     std::string s(name);
-
-    auto itr = m_params.find(s);
-    if (itr != m_params.end()) {
+    const UniformId id(s);
+
+    auto itr =
+        std::lower_bound(m_params.begin(), m_params.end(), id, CompareParamId);
+    if (itr != m_params.end() && itr->first == id) {
+        SD_CORE_ASSERT(itr->second->GetName() == s,
+                       fmt::format("Uniform id collision: \"{}\" and \"{}\"",
+                                   itr->second->GetName(), s));
         return itr->second;
     }
 
@@ -169,7 +185,8 @@ ShaderParam* GLShader::GetParam(int32_t index)
     ShaderParam* p = new GLShaderParam(type, s, index, m_id, location,
                                        tex_binding_id, image_binding, size);
 
-    return m_params.emplace(s, p).first->second;
+    m_params.emplace(itr, id, p);
+    return p;
 }
 
 void GLShader::CompileShader(ShaderType type, const std::string& code)
@@ -276,6 +293,16 @@ void GLShader::SetUniformBuffer(const std::string& name,
     }
 }
 
+void GLShader::SetStorageBuffer(const std::string& name,
+                                const ShaderStorageBuffer& buffer)
+{
+    uint32_t index =
+        glGetProgramResourceIndex(m_id, GL_SHADER_STORAGE_BLOCK, name.c_str());
+    if (index != GL_INVALID_INDEX) {
+        glShaderStorageBlockBinding(m_id, index, buffer.GetBindingPoint());
+    }
+}
+
 uint32_t GLShader::GetUint(const std::string& name) const
 {
     uint32_t value = 0;
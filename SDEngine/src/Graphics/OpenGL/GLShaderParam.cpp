@@ -1,5 +1,8 @@
 #include "Graphics/OpenGL/GLShaderParam.hpp"
 #include "Graphics/OpenGL/GLTranslator.hpp"
+#include "Graphics/OpenGL/GLDevice.hpp"
+
+#include <cstring>
 
 #include <GL/glew.h>
 
@@ -10,6 +13,7 @@ GLShaderParam::GLShaderParam(UniformType type, const std::string& name,
                              int32_t location, int32_t tex_binding_id,
                              int32_t image_binding, int32_t size)
     : ShaderParam(type, name, index),
+      m_cache_size(0),
       m_program(program_id),
       m_location(location),
       m_texture_binding(tex_binding_id),
@@ -29,71 +33,102 @@ GLShaderParam::GLShaderParam(UniformType type, const std::string& name,
     }
 }
 
+bool GLShaderParam::IsCached(const void* value, size_t size)
+{
+    DeviceStatistics& statistics = Device::GetStatistics();
+    if (size > CACHE_SIZE) {
+        m_cache_size = 0;
+        ++statistics.uniform_misses;
+        return false;
+    }
+    if (m_cache_size == size && std::memcmp(m_cache.data(), value, size) == 0) {
+        ++statistics.uniform_hits;
+        return true;
+    }
+    std::memcpy(m_cache.data(), value, size);
+    m_cache_size = size;
+    ++statistics.uniform_misses;
+    return false;
+}
+
 void GLShaderParam::SetAsBool(bool value)
 {
+    const int32_t data = value;
+    if (IsCached(&data, sizeof(data))) return;
     glProgramUniform1i(m_program, m_location, value);
 }
 
 void GLShaderParam::SetAsInt(int value)
 {
+    if (IsCached(&value, sizeof(value))) return;
     glProgramUniform1i(m_program, m_location, value);
 }
 
 void GLShaderParam::SetAsUint(uint32_t value)
 {
+    if (IsCached(&value, sizeof(value))) return;
     glProgramUniform1ui(m_program, m_location, value);
 }
 
 void GLShaderParam::SetAsFloat(float value)
 {
+    if (IsCached(&value, sizeof(value))) return;
     glProgramUniform1f(m_program, m_location, value);
 }
 
 void GLShaderParam::SetAsVec(const int* value, int32_t count)
 {
+    if (IsCached(value, sizeof(int) * count)) return;
     glProgramUniform1iv(m_program, m_location, count, value);
 }
 
 void GLShaderParam::SetAsVec(const float* value, int32_t count)
 {
+    if (IsCached(value, sizeof(float) * count)) return;
     glProgramUniform1fv(m_program, m_location, count, value);
 }
 
 void GLShaderParam::SetAsVec2(const float* value, int32_t count)
 {
+    if (IsCached(value, sizeof(float) * 2 * count)) return;
     glProgramUniform2fv(m_program, m_location, count, value);
 }
 
 void GLShaderParam::SetAsVec3(const float* value, int32_t count)
 {
+    if (IsCached(value, sizeof(float) * 3 * count)) return;
     glProgramUniform3fv(m_program, m_location, count, value);
 }
 
 void GLShaderParam::SetAsVec4(const float* value, int32_t count)
 {
+    if (IsCached(value, sizeof(float) * 4 * count)) return;
     glProgramUniform4fv(m_program, m_location, count, value);
 }
 
 void GLShaderParam::SetAsMat3(const float* value, int32_t count)
 {
+    if (IsCached(value, sizeof(float) * 9 * count)) return;
     glProgramUniformMatrix3fv(m_program, m_location, count, GL_FALSE, value);
 }
 
 void GLShaderParam::SetAsMat4(const float* value, int32_t count)
 {
+    if (IsCached(value, sizeof(float) * 16 * count)) return;
     glProgramUniformMatrix4fv(m_program, m_location, count, GL_FALSE, value);
 }
 
 void GLShaderParam::SetAsTexture(const Texture* texture)
 {
-    glBindTextureUnit(m_texture_binding, texture ? texture->Handle() : 0);
+    GLDevice::BindTextureUnit(m_texture_binding,
+                              texture ? texture->Handle() : 0);
 }
 
 void GLShaderParam::SetAsTextures(const Texture** textures, int32_t count)
 {
     for (int32_t i = 0; i < count; ++i) {
-        glBindTextureUnit(m_texture_binding + i,
-                          textures[i] ? textures[i]->Handle() : 0);
+        GLDevice::BindTextureUnit(m_texture_binding + i,
+                                  textures[i] ? textures[i]->Handle() : 0);
     }
 }
 
@@ -1,5 +1,6 @@
 #include "Graphics/OpenGL/GLTexture.hpp"
 #include "Graphics/OpenGL/GLTranslator.hpp"
+#include "Graphics/OpenGL/GLDevice.hpp"
 
 namespace SD {
 
@@ -42,7 +43,11 @@ GLTexture::GLTexture(int width, int height, int depth, MultiSampleLevel samples,
     }
 }
 
-GLTexture::~GLTexture() { glDeleteTextures(1, &m_id); }
+GLTexture::~GLTexture()
+{
+    GLDevice::ReleaseTexture(m_id);
+    glDeleteTextures(1, &m_id);
+}
 
 void GLTexture::Allocate()
 {
@@ -102,6 +107,9 @@ void GLTexture::SetPixels(int x, int y, int z, int width, int height, int depth,
             break;
     }
     glGenerateTextureMipmap(m_id);
+    const size_t texel_size = GetDataSize() / m_width / m_height / m_depth;
+    Device::GetStatistics().uploaded_bytes +=
+        texel_size * width * height * depth;
 }
 
 void GLTexture::SetBorderColor(const void *color)
@@ -160,6 +168,58 @@ void GLTexture::ReadPixels(int level, int x, int y, int z, int w, int h, int d,
                          gl_format_type, size, data);
 }
 
+void GLTexture::ClearPixels(int level, int x, int y, int z, int w, int h,
+                            int d, const void *value)
+{
+    glClearTexSubImage(m_id, level, x, y, z, w, h, d, gl_format,
+                       gl_format_type, value);
+}
+
+void GLTexture::CopyFrom(const Texture &src, int first_layer, int layer_count)
+{
+    const GLTexture &gl_src = static_cast<const GLTexture &>(src);
+    SD_CORE_ASSERT(gl_src.gl_type == gl_type && gl_src.m_format == m_format &&
+                       gl_src.m_width == m_width &&
+                       gl_src.m_height == m_height &&
+                       gl_src.m_depth == m_depth &&
+                       gl_src.m_mipmap_levels == m_mipmap_levels,
+                   "Texture copy requires identical textures!");
+    int depth = 1;
+    if (gl_type == GL_TEXTURE_CUBE_MAP) {
+        depth = 6;
+    }
+    else if (gl_type == GL_TEXTURE_3D || gl_type == GL_TEXTURE_2D_ARRAY) {
+        depth = m_depth;
+    }
+    if (layer_count == 0) {
+        layer_count = depth - first_layer;
+    }
+    for (int level = 0; level < m_mipmap_levels; ++level) {
+        const int width = std::max(m_width >> level, 1);
+        const int height = std::max(m_height >> level, 1);
+        // The depth of a 3D texture shrinks with the level too.
+        const int count =
+            gl_type == GL_TEXTURE_3D
+                ? std::min(layer_count,
+                           std::max(depth >> level, 1) - first_layer)
+                : layer_count;
+        if (count <= 0) break;
+        glCopyImageSubData(gl_src.m_id, gl_type, level, 0, 0, first_layer,
+                           m_id, gl_type, level, 0, 0, first_layer, width,
+                           height, count);
+    }
+}
+
+void GLTexture::CopyPixels(const Texture &src, int level, int x, int y, int z,
+                           int w, int h, int d)
+{
+    const GLTexture &gl_src = static_cast<const GLTexture &>(src);
+    SD_CORE_ASSERT(gl_src.gl_type == gl_type && gl_src.m_format == m_format,
+                   "Texture copy requires identical formats!");
+    glCopyImageSubData(gl_src.m_id, gl_type, level, x, y, z, m_id, gl_type,
+                       level, x, y, z, w, h, d);
+}
+
 void GLTexture::GenerateMipmap() { glGenerateTextureMipmap(m_id); }
 
 }  // namespace SD
@@ -0,0 +1,30 @@
+#include "Graphics/OpenGL/GLTimerQuery.hpp"
+
+namespace SD {
+
+GLTimerQuery::GLTimerQuery() { glCreateQueries(GL_TIMESTAMP, 2, m_ids); }
+
+GLTimerQuery::~GLTimerQuery() { glDeleteQueries(2, m_ids); }
+
+void GLTimerQuery::Begin() { glQueryCounter(m_ids[0], GL_TIMESTAMP); }
+
+void GLTimerQuery::End() { glQueryCounter(m_ids[1], GL_TIMESTAMP); }
+
+bool GLTimerQuery::IsReady() const
+{
+    // The end is written last.
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(m_ids[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    return available == GL_TRUE;
+}
+
+float GLTimerQuery::GetElapsedMS() const
+{
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(m_ids[0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(m_ids[1], GL_QUERY_RESULT, &end);
+    return (end - begin) / 1e6f;
+}
+
+}  // namespace SD
@@ -338,7 +338,7 @@ GLenum GetFormatType(DataFormat format)
         case DataFormat::RGBA32UI:
             return GL_RGBA_INTEGER;
         case DataFormat::Depth24:
-            return GL_DEPTH;
+            return GL_DEPTH_COMPONENT;
         case DataFormat::Stencil8:
             return GL_STENCIL_INDEX;
         case DataFormat::Depth24Stencil8:
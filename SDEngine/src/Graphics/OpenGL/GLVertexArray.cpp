@@ -1,5 +1,6 @@
 #include "Graphics/OpenGL/GLVertexArray.hpp"
 #include "Graphics/OpenGL/GLTranslator.hpp"
+#include "Graphics/OpenGL/GLDevice.hpp"
 #include "Utility/Log.hpp"
 
 #include <numeric>
@@ -11,11 +12,16 @@ GLVertexArray::GLVertexArray() : m_attrib_id(0)
     glCreateVertexArrays(1, &m_id);
 }
 
-GLVertexArray::~GLVertexArray() { glDeleteVertexArrays(1, &m_id); }
+GLVertexArray::~GLVertexArray()
+{
+    GLDevice::ReleaseVertexArray(m_id);
+    glDeleteVertexArrays(1, &m_id);
+}
 
-void GLVertexArray::BindVertexBuffer(const VertexBuffer &buffer, int32_t index)
+void GLVertexArray::BindVertexBuffer(const VertexBuffer &buffer, int32_t index,
+                                     size_t offset)
 {
-    glVertexArrayVertexBuffer(m_id, index, buffer.Handle(), 0,
+    glVertexArrayVertexBuffer(m_id, index, buffer.Handle(), offset,
                               m_layouts[index].GetStride());
 }
 
@@ -0,0 +1,146 @@
+#include "Graphics/ShadowAtlas.hpp"
+
+namespace SD {
+
+ShadowAtlas::ShadowAtlas(int32_t size, int32_t min_tile_size)
+{
+    Reset(size, min_tile_size);
+}
+
+void ShadowAtlas::Reset(int32_t size, int32_t min_tile_size)
+{
+    SD_CORE_ASSERT(size > 0 && (size & (size - 1)) == 0 &&
+                       min_tile_size > 0 &&
+                       (min_tile_size & (min_tile_size - 1)) == 0 &&
+                       min_tile_size <= size,
+                   "Shadow atlas sizes must be powers of two!");
+    m_size = size;
+    m_min_tile_size = min_tile_size;
+    size_t count = 1;
+    for (int32_t s = size; s > min_tile_size; s >>= 1) {
+        count = count * 4 + 1;
+    }
+    m_nodes.assign(count, NodeState::Free);
+    m_used_area = 0;
+
+    m_shadow_map.reset();
+    m_framebuffer.reset();
+    m_static_map.reset();
+    m_static_framebuffer.reset();
+}
+
+int32_t ShadowAtlas::GetLevel(int32_t tile_size) const
+{
+    int32_t level = 0;
+    for (int32_t s = m_size; s >= m_min_tile_size; s >>= 1, ++level) {
+        if (s == tile_size) return level;
+    }
+    return -1;
+}
+
+int32_t ShadowAtlas::Allocate(int32_t tile_size)
+{
+    const int32_t level = GetLevel(tile_size);
+    if (level < 0) return -1;
+
+    const int32_t tile = Find(0, 0, level);
+    if (tile >= 0) {
+        m_used_area += static_cast<int64_t>(tile_size) * tile_size;
+    }
+    return tile;
+}
+
+int32_t ShadowAtlas::Find(int32_t node, int32_t level, int32_t target)
+{
+    switch (m_nodes[node]) {
+        case NodeState::Used:
+            return -1;
+        case NodeState::Free: {
+            if (level == target) {
+                m_nodes[node] = NodeState::Used;
+                return node;
+            }
+            m_nodes[node] = NodeState::Split;
+            for (int32_t i = 1; i <= 4; ++i) {
+                m_nodes[node * 4 + i] = NodeState::Free;
+            }
+            return Find(node * 4 + 1, level + 1, target);
+        }
+        case NodeState::Split: {
+            if (level == target) return -1;
+            // Fill the nodes already split before splitting free ones, to
+            // keep the large free tiles whole.
+            for (int32_t i = 1; i <= 4; ++i) {
+                const int32_t child = node * 4 + i;
+                if (m_nodes[child] != NodeState::Split) continue;
+
+                const int32_t tile = Find(child, level + 1, target);
+                if (tile >= 0) return tile;
+            }
+            for (int32_t i = 1; i <= 4; ++i) {
+                const int32_t child = node * 4 + i;
+                if (m_nodes[child] == NodeState::Free) {
+                    return Find(child, level + 1, target);
+                }
+            }
+            return -1;
+        }
+    }
+    return -1;
+}
+
+void ShadowAtlas::Free(int32_t tile)
+{
+    SD_CORE_ASSERT(tile >= 0 && tile < static_cast<int32_t>(m_nodes.size()) &&
+                       m_nodes[tile] == NodeState::Used,
+                   "Freeing a shadow atlas tile not in use!");
+    const int64_t size = GetTile(tile).size;
+    m_used_area -= size * size;
+    m_nodes[tile] = NodeState::Free;
+    while (tile > 0) {
+        const int32_t parent = (tile - 1) / 4;
+        for (int32_t i = 1; i <= 4; ++i) {
+            if (m_nodes[parent * 4 + i] != NodeState::Free) return;
+        }
+        m_nodes[parent] = NodeState::Free;
+        tile = parent;
+    }
+}
+
+ShadowAtlas::Tile ShadowAtlas::GetTile(int32_t tile) const
+{
+    int32_t size = m_size;
+    for (int32_t node = tile; node > 0; node = (node - 1) / 4) {
+        size >>= 1;
+    }
+    Tile result{0, 0, size};
+    for (int32_t node = tile; node > 0; node = (node - 1) / 4) {
+        const int32_t child = (node - 1) % 4;
+        result.x += (child & 1) * size;
+        result.y += (child >> 1) * size;
+        size <<= 1;
+    }
+    return result;
+}
+
+void ShadowAtlas::CreateShadowMap()
+{
+    m_framebuffer = Framebuffer::Create();
+    m_shadow_map =
+        Texture::Create(m_size, m_size, 1, MultiSampleLevel::None,
+                        TextureType::Normal2D, DataFormat::Depth24);
+    m_framebuffer->Attach(*m_shadow_map, 0, 0);
+    m_static_map.reset();
+    m_static_framebuffer.reset();
+}
+
+void ShadowAtlas::CreateStaticShadowMap()
+{
+    m_static_framebuffer = Framebuffer::Create();
+    m_static_map =
+        Texture::Create(m_size, m_size, 1, MultiSampleLevel::None,
+                        TextureType::Normal2D, DataFormat::Depth24);
+    m_static_framebuffer->Attach(*m_static_map, 0, 0);
+}
+
+}  // namespace SD
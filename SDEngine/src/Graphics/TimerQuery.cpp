@@ -0,0 +1,21 @@
+#include "Graphics/TimerQuery.hpp"
+#include "Graphics/Device.hpp"
+#include "Graphics/OpenGL/GLTimerQuery.hpp"
+
+namespace SD {
+
+Ref<TimerQuery> TimerQuery::Create()
+{
+    Ref<TimerQuery> query;
+    switch (Device::GetAPI()) {
+        case Device::API::OpenGL:
+            query = CreateRef<GLTimerQuery>();
+            break;
+        default:
+            SD_CORE_ERROR("Unsupported API!");
+            break;
+    }
+    return query;
+}
+
+}  // namespace SD
@@ -2,6 +2,8 @@
 #include "Graphics/Model.hpp"
 #include "Graphics/Font.hpp"
 
+#include <string_view>
+
 namespace ImGui {
 
 bool DrawVec3Control(const std::string &label, SD::Vector3f &values,
@@ -236,6 +238,89 @@ bool BeginCenterPopupModal(const char *name, bool *p_open,
                                   flags | ImGuiWindowFlags_AlwaysAutoResize);
 }
 
+void DrawFlameGraph(const std::vector<SD::ProfileRecord> &records)
+{
+    const SD::ProfileRecord *root = nullptr;
+    for (const auto &record : records) {
+        if (record.depth == 0) {
+            root = &record;
+        }
+    }
+    if (root == nullptr) {
+        ImGui::TextUnformatted("No scope recorded.");
+        return;
+    }
+
+    const double duration = std::max<uint64_t>(root->end - root->begin, 1);
+    ImGui::Text("%s: %.3f ms", root->name, duration / 1e6);
+
+    uint32_t max_depth = 0;
+    for (const auto &record : records) {
+        if (record.begin >= root->begin && record.end <= root->end) {
+            max_depth = std::max(max_depth, record.depth);
+        }
+    }
+
+    const float row_height = ImGui::GetTextLineHeightWithSpacing();
+    const float width = ImGui::GetContentRegionAvail().x;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList *draw_list = ImGui::GetWindowDrawList();
+    for (const auto &record : records) {
+        if (record.begin < root->begin || record.end > root->end) continue;
+
+        const float x0 =
+            origin.x + (record.begin - root->begin) / duration * width;
+        const float x1 = std::max(
+            origin.x + (record.end - root->begin) / duration * width,
+            x0 + 1.f);
+        const float y0 = origin.y + record.depth * row_height;
+        const ImVec2 min(x0, y0);
+        const ImVec2 max(x1, y0 + row_height - 1.f);
+
+        // The same scope keeps its color from frame to frame.
+        const size_t hash = std::hash<std::string_view>()(record.name);
+        const float hue = (hash % 256) / 256.f;
+        draw_list->AddRectFilled(min, max, ImColor::HSV(hue, 0.5f, 0.7f));
+        draw_list->PushClipRect(min, max, true);
+        draw_list->AddText(ImVec2(x0 + 2.f, y0), IM_COL32_WHITE, record.name);
+        draw_list->PopClipRect();
+
+        if (ImGui::IsMouseHoveringRect(min, max)) {
+            ImGui::SetTooltip("%s: %.3f ms", record.name,
+                              (record.end - record.begin) / 1e6);
+        }
+    }
+    ImGui::Dummy(ImVec2(width, row_height * (max_depth + 1)));
+}
+
+void DrawMetrics(const std::vector<SD::Metric> &metrics)
+{
+    ImGui::PushID("Metrics");
+    ImGui::Columns(5);
+    ImGui::TextUnformatted("Name");
+    for (const char *header : {"Value", "p50", "p95", "p99"}) {
+        ImGui::NextColumn();
+        ImGui::TextUnformatted(header);
+    }
+    ImGui::Separator();
+    for (const auto &metric : metrics) {
+        ImGui::NextColumn();
+        ImGui::TextUnformatted(metric.name.c_str());
+        ImGui::NextColumn();
+        ImGui::Text("%.6g", metric.value);
+        const bool has_window = metric.type != SD::MetricType::Gauge &&
+                                metric.histogram.GetCount() > 0;
+        for (double p : {0.5, 0.95, 0.99}) {
+            ImGui::NextColumn();
+            if (has_window) {
+                ImGui::Text("%.6g", metric.histogram.GetPercentile(p));
+            }
+        }
+    }
+    ImGui::Columns(1);
+    ImGui::PopID();
+}
+
 // bool DrawTextureAssetSelection(const SD::ResourceRegistry::TextureCache &,
 //                                SD::ResourceId *)
 // {
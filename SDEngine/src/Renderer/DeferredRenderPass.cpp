@@ -1,47 +1,177 @@
 #include "Renderer/DeferredRenderPass.hpp"
 #include "Renderer/Renderer3D.hpp"
+#include "Renderer/GPUProfiler.hpp"
+#include "Graphics/LightCluster.hpp"
+#include "Graphics/ShadowAtlas.hpp"
 #include "ECS/Component.hpp"
 #include "Utility/Random.hpp"
 #include "ImGui/ImGuiWidget.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
 namespace SD {
 
+// std430 layout of ClusterLight in cluster.glsl.
+struct ClusterLightData {
+    Vector4f position;
+    Vector4f ambient;
+    Vector4f diffuse;
+    Vector4f specular;
+    Vector4f attenuation;
+};
+
+struct CasterState {
+    Matrix4f transform;
+    uint64_t moved_frame;
+    uint64_t seen_frame;
+};
+
+struct ShadowCaster {
+    const Mesh *mesh;
+    Matrix4f transform;
+    uint32_t entity;
+    uint32_t mask;
+};
+
+// Atlas tiles of a point light's cube faces, the faces being the layers
+// UpdateShadowMap works on.
+struct PointShadowTiles {
+    ShadowAtlas *atlas{nullptr};
+    // -1 if the light has no tiles.
+    std::array<int32_t, 6> tiles{-1, -1, -1, -1, -1, -1};
+    std::array<ShadowAtlas::Tile, 6> regions{};
+    // Tile size asked for, the tiles are smaller if the atlas was full.
+    int32_t request{0};
+    std::array<uint64_t, 6> versions{};
+    std::array<uint64_t, 6> static_versions{};
+    uint64_t seen_frame{0};
+
+    bool HasTiles() const { return tiles[0] >= 0; }
+
+    Texture *GetShadowMap() { return atlas->GetShadowMap(); }
+    Framebuffer *GetShadowTarget() { return atlas->GetShadowTarget(); }
+    void CreateStaticShadowMap() { atlas->CreateStaticShadowMap(); }
+    Texture *GetStaticShadowMap() { return atlas->GetStaticShadowMap(); }
+    Framebuffer *GetStaticShadowTarget()
+    {
+        return atlas->GetStaticShadowTarget();
+    }
+
+    uint64_t GetVersion(uint32_t face) const { return versions[face]; }
+    void SetVersion(uint32_t face, uint64_t version)
+    {
+        versions[face] = version;
+    }
+    uint64_t GetStaticVersion(uint32_t face) const
+    {
+        return static_versions[face];
+    }
+    void SetStaticVersion(uint32_t face, uint64_t version)
+    {
+        static_versions[face] = version;
+    }
+};
+
+static const int GBUFFER_COUNT =
+    static_cast<int>(GeometryBufferType::GBufferCount);
+
+// Render graph resources of the current frame.
+struct DeferredResources {
+    RenderGraph::Resource color;
+    std::array<RenderGraph::Resource, GBUFFER_COUNT> gbuffer_msaa;
+    RenderGraph::Resource depth;
+    // -1 for the buffers not resolved.
+    std::array<RenderGraph::Resource, GBUFFER_COUNT> gbuffer;
+    RenderGraph::Resource depth_resolved;
+    RenderGraph::Resource entity;
+    RenderGraph::Resource ssao_depth;
+    RenderGraph::Resource ssao_normal;
+    RenderGraph::Resource ssao;
+    RenderGraph::Resource ssao_blur;
+    // ssao_blur at full resolution, upsampled otherwise.
+    RenderGraph::Resource ssao_result;
+    std::array<RenderGraph::Resource, 2> lighting;
+    RenderGraph::Resource cascade_debug;
+};
+
 struct DeferredRenderData {
     Device *device;
+    // Region drawn to at the bottom left of the textures, smaller than them
+    // at a reduced resolution.
+    int32_t viewport_width;
+    int32_t viewport_height;
     ShaderHandle cascade_shader;
     ShaderHandle cascade_debug_shader;
 
     Ref<Framebuffer> cascade_debug_target;
-    Ref<Texture> cascade_debug_buffer;
+    Texture *cascade_debug_buffer;
     int debug_layer{0};
 
     ShaderHandle point_shadow_shader;
+    ShadowAtlas point_shadow_atlas;
+    std::unordered_map<entt::entity, PointShadowTiles> point_shadow_tiles;
+    std::vector<PointShadowTiles *> pending_point_shadows;
+
     ShaderHandle emssive_shader;
 
     ShaderHandle deferred_shader;
 
     Ref<Framebuffer> lighting_target[2];
-    Ref<Texture> lighting_buffers[2];
+    Texture *lighting_buffers[2];
     Texture *lighting_result;
 
+    // Last transform of every mesh and the frame it last changed, to tell
+    // static shadow casters from dynamic ones.
+    std::unordered_map<entt::entity, CasterState> caster_states;
+    uint64_t frame{0};
+    std::vector<ShadowCaster> static_casters;
+    std::vector<ShadowCaster> dynamic_casters;
+
+    LightCluster light_cluster;
+    std::vector<ClusterLightData> cluster_lights;
+    std::vector<Math::BoundingSphere> cluster_light_bounds;
+    Ref<ShaderStorageBuffer> cluster_light_buffer;
+    Ref<ShaderStorageBuffer> cluster_grid_buffer;
+    Ref<ShaderStorageBuffer> cluster_index_buffer;
+
     ShaderHandle gbuffer_shader;
     Ref<Framebuffer> geometry_target_msaa;
-    std::array<Ref<Texture>, static_cast<int>(GeometryBufferType::GBufferCount)>
-        gbuffer_msaa;
+    std::array<Texture *, GBUFFER_COUNT> gbuffer_msaa;
+    Texture *depth_buffer;
+    // Resolved buffers, only the ones used in this frame.
     Ref<Framebuffer> geometry_target;
-    std::array<Ref<Texture>, static_cast<int>(GeometryBufferType::GBufferCount)>
-        gbuffer;
-    Ref<Renderbuffer> depth_buffer;
-
+    std::array<Texture *, GBUFFER_COUNT> gbuffer;
+    Texture *depth_resolved;
+    // Read back after the frame, so it is not a transient resource.
+    Ref<Texture> entity_buffer;
+
+    ShaderHandle ssao_downsample_shader;
+    // Depth and normal pyramid, one level per halving.
+    Texture *ssao_depth;
+    Texture *ssao_normal;
     ShaderHandle ssao_shader;
-    Ref<Texture> ssao_buffer;
+    Texture *ssao_buffer;
     ShaderHandle ssao_blur_shader;
-    Ref<Texture> ssao_blur_buffer;
+    Texture *ssao_blur_buffer;
+    ShaderHandle ssao_upsample_shader;
+    Texture *ssao_result;
+
+    // Debug views drawn by ImGui, produced only while they are shown.
+    bool show_gbuffer{false};
+    bool show_ssao{false};
+    bool show_cascade_debug{false};
+
+    DeferredResources resources;
 
     Ref<Texture> ssao_noise;
     std::vector<Vector3f> ssao_kernel;
 };
 
+// Matches the invocations of the cascade geometry shader.
+static const uint32_t MAX_CASCADE_COUNT = 4;
+
 static DeferredRenderData s_data;
 static DeferredRenderSettings s_settings;
 
@@ -50,14 +180,11 @@ static ModelCache *s_models;
 DataFormat GetTextureFormat(GeometryBufferType type)
 {
     switch (type) {
-        case GeometryBufferType::Position:
         case GeometryBufferType::Normal:
-            return DataFormat::RGB16F;
+            return DataFormat::RG16F;
         case GeometryBufferType::Albedo:
             return DataFormat::RGBA8;
-        case GeometryBufferType::Ambient:
-        case GeometryBufferType::Emissive:
-            return DataFormat::RGB8;
+        case GeometryBufferType::AmbientEmissive:
         case GeometryBufferType::EntityId:
             return DataFormat::R32UI;
         default:
@@ -72,6 +199,8 @@ void DeferredRenderPass::Init(DeferredRenderSettings settings, Device *device,
     s_settings = std::move(settings);
 
     s_data.device = device;
+    s_data.viewport_width = s_settings.width;
+    s_data.viewport_height = s_settings.height;
     s_models = &models;
 
     for (int i = 0; i < 2; ++i) {
@@ -80,10 +209,18 @@ void DeferredRenderPass::Init(DeferredRenderSettings settings, Device *device,
     s_data.geometry_target_msaa = Framebuffer::Create();
     s_data.geometry_target = Framebuffer::Create();
     s_data.cascade_debug_target = Framebuffer::Create();
+
+    s_data.cluster_light_buffer = ShaderStorageBuffer::Create(
+        nullptr, sizeof(ClusterLightData) * 256, BufferIOType::Dynamic);
+    s_data.cluster_grid_buffer = ShaderStorageBuffer::Create(
+        nullptr, sizeof(LightCluster::Cluster) *
+                     s_data.light_cluster.GetClusters().size(),
+        BufferIOType::Dynamic);
+    s_data.cluster_index_buffer = ShaderStorageBuffer::Create(
+        nullptr, sizeof(uint32_t) * 4096, BufferIOType::Dynamic);
     InitShaders(shaders);
     InitSSAOKernel();
-    InitSSAOBuffers();
-    InitLightingBuffers();
+    InitEntityBuffer();
 }
 
 void DeferredRenderPass::InitShaders(ShaderCache &shaders)
@@ -102,6 +239,12 @@ void DeferredRenderPass::InitShaders(ShaderCache &shaders)
         shaders.Load("shader/ssao", "assets/shaders/ssao.comp.glsl");
     s_data.ssao_blur_shader =
         shaders.Load("shader/ssao_blur", "assets/shaders/ssao_blur.comp.glsl");
+    s_data.ssao_downsample_shader =
+        shaders.Load("shader/ssao_downsample",
+                     "assets/shaders/ssao_downsample.comp.glsl");
+    s_data.ssao_upsample_shader =
+        shaders.Load("shader/ssao_upsample",
+                     "assets/shaders/ssao_upsample.comp.glsl");
 
     s_data.cascade_shader =
         shaders.Load("shader/cascade_shadow", "assets/shaders/shadow.vert.glsl",
@@ -115,16 +258,6 @@ void DeferredRenderPass::InitShaders(ShaderCache &shaders)
                      "assets/shaders/point_shadow.geo.glsl");
 }
 
-void DeferredRenderPass::InitSSAOBuffers()
-{
-    s_data.ssao_buffer = Texture::Create(
-        s_settings.width, s_settings.height, 1, MultiSampleLevel::None,
-        TextureType::Normal2D, DataFormat::R16F);
-    s_data.ssao_blur_buffer = Texture::Create(
-        s_settings.width, s_settings.height, 1, MultiSampleLevel::None,
-        TextureType::Normal2D, DataFormat::R16F);
-}
-
 void DeferredRenderPass::InitSSAOKernel()
 {
     uint32_t kernel_size = s_data.ssao_shader->GetUint("u_kernel_size");
@@ -157,68 +290,65 @@ void DeferredRenderPass::InitSSAOKernel()
         ->SetAsVec3(&s_data.ssao_kernel[0][0], kernel_size);
 }
 
-void DeferredRenderPass::InitLightingBuffers()
+void DeferredRenderPass::InitEntityBuffer()
 {
-    for (int i = 0; i < 2; ++i) {
-        s_data.lighting_buffers[i] = Texture::Create(
-            s_settings.width, s_settings.height, 1, s_settings.msaa,
-            TextureType::Normal2D, DataFormat::RGB16F);
-        s_data.lighting_target[i]->Attach(*s_data.lighting_buffers[i], 0, 0);
-    }
-
-    for (size_t i = 0; i < s_data.gbuffer_msaa.size(); ++i) {
-        GeometryBufferType type = static_cast<GeometryBufferType>(i);
-        s_data.gbuffer_msaa[i] = Texture::Create(
-            s_settings.width, s_settings.height, 1, s_settings.msaa,
-            TextureType::Normal2D, GetTextureFormat(type));
-        s_data.geometry_target_msaa->Attach(*s_data.gbuffer_msaa[i], i, 0);
-
-        s_data.gbuffer[i] = Texture::Create(
-            s_settings.width, s_settings.height, 1, MultiSampleLevel::None,
-            TextureType::Normal2D, GetTextureFormat(type));
-        s_data.geometry_target->Attach(*s_data.gbuffer[i], i, 0);
-    }
-    s_data.depth_buffer =
-        Renderbuffer::Create(s_settings.width, s_settings.height,
-                             s_settings.msaa, DataFormat::Depth24);
-    s_data.geometry_target_msaa->Attach(*s_data.depth_buffer, 0);
-
-    s_data.cascade_debug_buffer = Texture::Create(
+    s_data.entity_buffer = Texture::Create(
         s_settings.width, s_settings.height, 1, MultiSampleLevel::None,
-        TextureType::Normal2D, DataFormat::RGB16F);
-    s_data.cascade_debug_target->Attach(*s_data.cascade_debug_buffer, 0, 0);
+        TextureType::Normal2D, GetTextureFormat(GeometryBufferType::EntityId));
 }
 
 void DeferredRenderPass::SetRenderSize(int32_t width, int32_t height)
 {
     s_settings.width = width;
     s_settings.height = height;
-    InitSSAOBuffers();
-    InitLightingBuffers();
+    SetViewportSize(width, height);
+    InitEntityBuffer();
 }
 
-void DeferredRenderPass::BlitGeometryBuffers()
+void DeferredRenderPass::SetViewportSize(int32_t width, int32_t height)
 {
-    for (size_t i = 0; i < s_data.gbuffer.size(); ++i) {
-        s_data.device->DrawBuffer(s_data.geometry_target.get(), i);
-        s_data.device->ReadBuffer(s_data.geometry_target_msaa.get(), i);
-        s_data.device->BlitFramebuffer(
-            s_data.geometry_target_msaa.get(), 0, 0, s_settings.width,
-            s_settings.height, s_data.geometry_target.get(), 0, 0,
-            s_settings.width, s_settings.height, BufferBitMask::ColorBufferBit,
-            BlitFilter::Nearest);
-    }
+    s_data.viewport_width = std::min(width, s_settings.width);
+    s_data.viewport_height = std::min(height, s_settings.height);
+}
+
+void DeferredRenderPass::ResolveGeometryBuffer(GeometryBufferType type,
+                                               Texture &dst)
+{
+    const int i = static_cast<int>(type);
+    s_data.geometry_target->Attach(dst, i, 0);
+    s_data.device->DrawBuffer(s_data.geometry_target.get(), i);
+    s_data.device->ReadBuffer(s_data.geometry_target_msaa.get(), i);
+    s_data.device->BlitFramebuffer(
+        s_data.geometry_target_msaa.get(), 0, 0, s_data.viewport_width,
+        s_data.viewport_height, s_data.geometry_target.get(), 0, 0,
+        s_data.viewport_width, s_data.viewport_height,
+        BufferBitMask::ColorBufferBit, BlitFilter::Nearest);
+}
+
+void DeferredRenderPass::ResolveDepth(Texture &dst)
+{
+    s_data.geometry_target->Attach(dst, 0, 0);
+    s_data.device->BlitFramebuffer(
+        s_data.geometry_target_msaa.get(), 0, 0, s_data.viewport_width,
+        s_data.viewport_height, s_data.geometry_target.get(), 0, 0,
+        s_data.viewport_width, s_data.viewport_height,
+        BufferBitMask::DepthBufferBit, BlitFilter::Nearest);
 }
 
 void DeferredRenderPass::ImGui()
 {
-    if (ImGui::TreeNodeEx("Geometry Buffers")) {
+    ImGui::Checkbox("Entity Id For Picking", &s_settings.entity_id_state);
+    s_data.show_gbuffer = ImGui::TreeNodeEx("Geometry Buffers");
+    if (s_data.show_gbuffer) {
         for (size_t i = 0; i < s_data.gbuffer.size(); ++i) {
+            if (s_data.gbuffer[i] == nullptr) continue;
+
             ImGui::DrawTexture(*s_data.gbuffer[i], ImVec2(0, 1), ImVec2(1, 0));
         }
         ImGui::TreePop();
     }
-    if (ImGui::TreeNodeEx("SSAO")) {
+    s_data.show_ssao = ImGui::TreeNodeEx("SSAO");
+    if (s_data.show_ssao) {
         ImGui::Checkbox("On", &s_settings.ssao_state);
         ImGui::TextUnformatted("SSAO Power");
         ImGui::SliderInt("##SSAO Power", &s_settings.ssao_power, 1, 32);
@@ -226,30 +356,307 @@ void DeferredRenderPass::ImGui()
         ImGui::SliderFloat("##SSAO Radius", &s_settings.ssao_radius, 0.1, 30);
         ImGui::TextUnformatted("SSAO Bias");
         ImGui::SliderFloat("##SSAO Bias", &s_settings.ssao_bias, 0.01, 2);
-        ImGui::DrawTexture(*s_data.ssao_blur_buffer, ImVec2(0, 1),
-                           ImVec2(1, 0));
+        ImGui::TextUnformatted("SSAO Resolution");
+        int resolution = static_cast<int>(s_settings.ssao_resolution);
+        const char *resolutions[] = {"Full", "Half", "Quarter"};
+        if (ImGui::Combo("##SSAO Resolution", &resolution, resolutions,
+                         IM_ARRAYSIZE(resolutions))) {
+            s_settings.ssao_resolution =
+                static_cast<SSAOResolution>(resolution);
+        }
+        if (s_data.ssao_result) {
+            ImGui::DrawTexture(*s_data.ssao_result, ImVec2(0, 1),
+                               ImVec2(1, 0));
+        }
         ImGui::TreePop();
     }
-    if (ImGui::TreeNodeEx("Cascade Shadow")) {
+    s_data.show_cascade_debug = ImGui::TreeNodeEx("Cascade Shadow");
+    if (s_data.show_cascade_debug) {
+        ImGui::TextUnformatted("Cascades Updated Every Frame");
+        ImGui::SliderInt("##Cascades Updated Every Frame",
+                         &s_settings.cascade_every_frame_count, 0,
+                         MAX_CASCADE_COUNT);
+        ImGui::TextUnformatted("Far Cascade Update Interval");
+        ImGui::SliderInt("##Far Cascade Update Interval",
+                         &s_settings.cascade_update_interval, 1, 16);
         ImGui::InputInt("Layer", &s_data.debug_layer);
-        ImGui::DrawTexture(*s_data.cascade_debug_buffer, ImVec2(0, 1),
-                           ImVec2(1, 0));
+        if (s_data.cascade_debug_buffer) {
+            ImGui::DrawTexture(*s_data.cascade_debug_buffer, ImVec2(0, 1),
+                               ImVec2(1, 0));
+        }
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNodeEx("Lighting")) {
+        ImGui::Checkbox("Clustered", &s_settings.clustered_lighting);
+        ImGui::Text("Clustered lights: %zu, light indices: %zu",
+                    s_data.cluster_lights.size(),
+                    s_data.light_cluster.GetLightIndices().size());
         ImGui::TreePop();
     }
     if (ImGui::TreeNodeEx("Point Shadow")) {
+        const ShadowAtlas &atlas = s_data.point_shadow_atlas;
+        ImGui::Text("Atlas %dx%d, %.1f%% used", atlas.GetSize(),
+                    atlas.GetSize(),
+                    100.0 * atlas.GetUsedArea() /
+                        (static_cast<double>(atlas.GetSize()) *
+                         atlas.GetSize()));
+        ImGui::TextUnformatted("Resolution Scale");
+        ImGui::SliderFloat("##Resolution Scale",
+                           &s_settings.point_shadow_resolution_scale, 0.1f,
+                           4.f);
+        ImGui::TextUnformatted("Min Pixels For Shadow");
+        ImGui::SliderFloat("##Min Pixels For Shadow",
+                           &s_settings.point_shadow_min_pixels, 0.f, 256.f);
+        if (s_data.point_shadow_atlas.GetShadowMap()) {
+            ImGui::DrawTexture(*s_data.point_shadow_atlas.GetShadowMap(),
+                               ImVec2(0, 1), ImVec2(1, 0));
+        }
         ImGui::TreePop();
     }
 }
 
-void DeferredRenderPass::Render(Scene &scene)
+void DeferredRenderPass::AddPasses(RenderGraph &graph, Scene &scene,
+                                   RenderGraph::Resource color)
 {
-    RenderGBuffer(scene);
-    BlitGeometryBuffers();
+    // The transient textures change from frame to frame, they are looked
+    // up again when the passes run.
+    s_data.gbuffer_msaa.fill(nullptr);
+    s_data.gbuffer.fill(nullptr);
+    s_data.depth_buffer = nullptr;
+    s_data.depth_resolved = nullptr;
+    s_data.ssao_buffer = nullptr;
+    s_data.ssao_blur_buffer = nullptr;
+    s_data.ssao_depth = nullptr;
+    s_data.ssao_normal = nullptr;
+    s_data.ssao_result = nullptr;
+    s_data.lighting_buffers[0] = s_data.lighting_buffers[1] = nullptr;
+    s_data.lighting_result = nullptr;
+    s_data.cascade_debug_buffer = nullptr;
+
+    DeferredResources &res = s_data.resources;
+    res.color = color;
+    res.gbuffer.fill(-1);
+    res.cascade_debug = -1;
+    const int32_t width = s_settings.width;
+    const int32_t height = s_settings.height;
+
+    constexpr int entity = static_cast<int>(GeometryBufferType::EntityId);
+    constexpr int normal = static_cast<int>(GeometryBufferType::Normal);
+    res.gbuffer_msaa.fill(-1);
+    graph.AddPass(
+        "GBuffer",
+        [&](RenderGraph::PassBuilder &builder) {
+            for (int i = 0; i < GBUFFER_COUNT; ++i) {
+                if (i == entity && !s_settings.entity_id_state) continue;
+
+                const auto type = static_cast<GeometryBufferType>(i);
+                res.gbuffer_msaa[i] =
+                    builder.Create("GBufferMSAA", {width, height,
+                                                   s_settings.msaa,
+                                                   GetTextureFormat(type)});
+            }
+            res.depth = builder.Create(
+                "GBufferDepth",
+                {width, height, s_settings.msaa, DataFormat::Depth24});
+        },
+        [&scene](const RenderGraph &graph) {
+            const DeferredResources &res = s_data.resources;
+            for (int i = 0; i < GBUFFER_COUNT; ++i) {
+                if (res.gbuffer_msaa[i] < 0) {
+                    s_data.geometry_target_msaa->Detach(i);
+                    continue;
+                }
+                s_data.gbuffer_msaa[i] = graph.GetTexture(res.gbuffer_msaa[i]);
+                s_data.geometry_target_msaa->Attach(*s_data.gbuffer_msaa[i],
+                                                    i, 0);
+            }
+            s_data.depth_buffer = graph.GetTexture(res.depth);
+            s_data.geometry_target_msaa->Attach(*s_data.depth_buffer, 0, 0);
+            RenderGBuffer(scene);
+        });
+
+    if (s_settings.entity_id_state) {
+        res.entity = graph.Import("EntityId", s_data.entity_buffer.get());
+        graph.AddPass(
+            "EntityIdResolve",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Read(res.gbuffer_msaa[entity]);
+                builder.Write(res.entity);
+            },
+            [](const RenderGraph &) {
+                ResolveGeometryBuffer(GeometryBufferType::EntityId,
+                                      *s_data.entity_buffer);
+            });
+    }
 
-    if (s_settings.ssao_state) {
-        RenderSSAO();
+    // Depth and normal for SSAO, albedo only for the debug view. The packed
+    // ambient and emissive are not resolved.
+    graph.AddPass(
+        "GBufferResolve",
+        [&](RenderGraph::PassBuilder &builder) {
+            for (int i = 0; i < GBUFFER_COUNT; ++i) {
+                const auto type = static_cast<GeometryBufferType>(i);
+                if (type != GeometryBufferType::Normal &&
+                    (type != GeometryBufferType::Albedo ||
+                     !s_data.show_gbuffer)) {
+                    continue;
+                }
+                builder.Read(res.gbuffer_msaa[i]);
+                res.gbuffer[i] = builder.Create(
+                    "GBuffer", {width, height, MultiSampleLevel::None,
+                                GetTextureFormat(type)});
+                if (s_data.show_gbuffer) {
+                    graph.MarkOutput(res.gbuffer[i]);
+                }
+            }
+            builder.Read(res.depth);
+            res.depth_resolved = builder.Create(
+                "GBufferDepthResolve",
+                {width, height, MultiSampleLevel::None, DataFormat::Depth24});
+        },
+        [](const RenderGraph &graph) {
+            const DeferredResources &res = s_data.resources;
+            for (int i = 0; i < GBUFFER_COUNT; ++i) {
+                if (res.gbuffer[i] < 0) continue;
+
+                s_data.gbuffer[i] = graph.GetTexture(res.gbuffer[i]);
+                ResolveGeometryBuffer(static_cast<GeometryBufferType>(i),
+                                      *s_data.gbuffer[i]);
+            }
+            s_data.depth_resolved = graph.GetTexture(res.depth_resolved);
+            ResolveDepth(*s_data.depth_resolved);
+        });
+
+    // At reduced resolution SSAO reads a downsampled pyramid of the depth
+    // and normal buffers, and its result is upsampled back.
+    const int32_t ssao_levels =
+        static_cast<int32_t>(s_settings.ssao_resolution);
+    const int32_t ssao_width = std::max(width >> ssao_levels, 1);
+    const int32_t ssao_height = std::max(height >> ssao_levels, 1);
+    res.ssao_depth = res.ssao_normal = -1;
+    if (ssao_levels > 0) {
+        graph.AddPass(
+            "SSAODownsample",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Read(res.depth_resolved);
+                builder.Read(res.gbuffer[normal]);
+                const TextureParameter params{
+                    TextureWrap::Edge, TextureMinFilter::Nearest,
+                    TextureMagFilter::Nearest,
+                    ssao_levels > 1 ? MipmapMode::Nearest : MipmapMode::None};
+                const int32_t pyramid_width = std::max(width / 2, 1);
+                const int32_t pyramid_height = std::max(height / 2, 1);
+                res.ssao_depth = builder.Create(
+                    "SSAODepth",
+                    {pyramid_width, pyramid_height, MultiSampleLevel::None,
+                     DataFormat::R32F, params, ssao_levels});
+                res.ssao_normal = builder.Create(
+                    "SSAONormal",
+                    {pyramid_width, pyramid_height, MultiSampleLevel::None,
+                     DataFormat::RG16F, params, ssao_levels});
+            },
+            [](const RenderGraph &graph) {
+                const DeferredResources &res = s_data.resources;
+                s_data.ssao_depth = graph.GetTexture(res.ssao_depth);
+                s_data.ssao_normal = graph.GetTexture(res.ssao_normal);
+                DownsampleSSAOInput();
+            });
+    }
+    graph.AddPass(
+        "SSAO",
+        [&](RenderGraph::PassBuilder &builder) {
+            if (ssao_levels > 0) {
+                builder.Read(res.ssao_depth);
+                builder.Read(res.ssao_normal);
+            }
+            else {
+                builder.Read(res.depth_resolved);
+                builder.Read(res.gbuffer[normal]);
+            }
+            const RenderGraphTextureDesc desc{ssao_width, ssao_height,
+                                              MultiSampleLevel::None,
+                                              DataFormat::R16F};
+            res.ssao = builder.Create("SSAO", desc);
+            res.ssao_blur = builder.Create("SSAOBlur", desc);
+            res.ssao_result = res.ssao_blur;
+        },
+        [](const RenderGraph &graph) {
+            const DeferredResources &res = s_data.resources;
+            s_data.ssao_buffer = graph.GetTexture(res.ssao);
+            s_data.ssao_blur_buffer = graph.GetTexture(res.ssao_blur);
+            s_data.ssao_result = s_data.ssao_blur_buffer;
+            RenderSSAO();
+        });
+    if (ssao_levels > 0) {
+        graph.AddPass(
+            "SSAOUpsample",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Read(res.depth_resolved);
+                builder.Read(res.gbuffer[normal]);
+                builder.Read(res.ssao_depth);
+                builder.Read(res.ssao_normal);
+                builder.Read(res.ssao_blur);
+                res.ssao_result = builder.Create(
+                    "SSAOUpsample", {width, height, MultiSampleLevel::None,
+                                     DataFormat::R16F});
+            },
+            [](const RenderGraph &graph) {
+                s_data.ssao_result =
+                    graph.GetTexture(s_data.resources.ssao_result);
+                UpsampleSSAO();
+            });
     }
+    if (s_data.show_ssao) {
+        graph.MarkOutput(res.ssao_result);
+    }
+
+    graph.AddPass(
+        "Lighting",
+        [&](RenderGraph::PassBuilder &builder) {
+            for (int i = 0; i < GBUFFER_COUNT; ++i) {
+                if (i != entity) {
+                    builder.Read(res.gbuffer_msaa[i]);
+                }
+            }
+            builder.Read(res.depth);
+            // SSAO is culled when its result is not read.
+            if (s_settings.ssao_state) {
+                builder.Read(res.ssao_result);
+            }
+            builder.Read(color);
+            builder.Write(color);
+            for (int i = 0; i < 2; ++i) {
+                res.lighting[i] = builder.Create(
+                    "Lighting",
+                    {width, height, s_settings.msaa, DataFormat::RGB16F});
+            }
+            if (s_data.show_cascade_debug) {
+                res.cascade_debug = builder.Create(
+                    "CascadeDebug", {width, height, MultiSampleLevel::None,
+                                     DataFormat::RGB16F});
+                graph.MarkOutput(res.cascade_debug);
+            }
+        },
+        [&scene](const RenderGraph &graph) {
+            const DeferredResources &res = s_data.resources;
+            for (int i = 0; i < 2; ++i) {
+                s_data.lighting_buffers[i] = graph.GetTexture(res.lighting[i]);
+                s_data.lighting_target[i]->Attach(*s_data.lighting_buffers[i],
+                                                  0, 0);
+            }
+            if (res.cascade_debug >= 0) {
+                s_data.cascade_debug_buffer =
+                    graph.GetTexture(res.cascade_debug);
+                s_data.cascade_debug_target->Attach(
+                    *s_data.cascade_debug_buffer, 0, 0);
+            }
+            RenderLighting(scene);
+        });
+}
 
+void DeferredRenderPass::RenderLighting(Scene &scene)
+{
+    UpdateCasterStates(scene);
     RenderDeferred(scene);
     auto dir_lights =
         scene.view<TransformComponent, DirectionalLightComponent>();
@@ -262,9 +669,272 @@ void DeferredRenderPass::Render(Scene &scene)
     s_data.device->ReadBuffer(s_data.geometry_target_msaa.get(), 0);
     s_data.device->DrawBuffer(fb, 0);
     s_data.device->BlitFramebuffer(
-        s_data.geometry_target_msaa.get(), 0, 0, s_settings.width,
-        s_settings.height, fb, 0, 0, s_settings.width, s_settings.height,
-        BufferBitMask::DepthBufferBit, BlitFilter::Nearest);
+        s_data.geometry_target_msaa.get(), 0, 0, s_data.viewport_width,
+        s_data.viewport_height, fb, 0, 0, s_data.viewport_width,
+        s_data.viewport_height, BufferBitMask::DepthBufferBit,
+        BlitFilter::Nearest);
+}
+
+// Bitmask of the shadow frustums the mesh touches, all bits set if the mesh
+// has no bounds.
+static uint32_t GetShadowMask(const Math::Frustum *frustums, uint32_t size,
+                              const Mesh &mesh, const Matrix4f &transform)
+{
+    const Math::AABB &local_aabb = mesh.GetBoundingBox();
+    if (!local_aabb.IsValid()) return (1u << size) - 1;
+
+    const Math::AABB aabb = local_aabb.Transform(transform);
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+        if (frustums[i].Intersects(aabb)) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+// Casters that moved within this many frames are drawn as dynamic.
+static const uint64_t STATIC_CASTER_FRAMES = 30;
+static const uint64_t NEVER_MOVED = std::numeric_limits<uint64_t>::max();
+
+void DeferredRenderPass::UpdateCasterStates(const Scene &scene)
+{
+    const uint64_t frame = ++s_data.frame;
+    auto &states = s_data.caster_states;
+    auto meshes = scene.view<TransformComponent, MeshComponent>();
+    meshes.each([&](const entt::entity &entity,
+                    const TransformComponent &transform,
+                    const MeshComponent &) {
+        const Matrix4f mat = transform.GetWorldTransform().GetMatrix();
+        auto [iter, inserted] =
+            states.try_emplace(entity, CasterState{mat, NEVER_MOVED, frame});
+        CasterState &state = iter->second;
+        if (!inserted && state.transform != mat) {
+            state.transform = mat;
+            state.moved_frame = frame;
+        }
+        state.seen_frame = frame;
+    });
+    for (auto iter = states.begin(); iter != states.end();) {
+        if (iter->second.seen_frame != frame) {
+            iter = states.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+}
+
+static bool IsDynamicCaster(entt::entity entity)
+{
+    auto iter = s_data.caster_states.find(entity);
+    if (iter == s_data.caster_states.end()) return true;
+
+    const uint64_t moved = iter->second.moved_frame;
+    return moved != NEVER_MOVED && s_data.frame - moved < STATIC_CASTER_FRAMES;
+}
+
+static uint64_t HashBytes(const void *data, size_t size,
+                          uint64_t hash = 14695981039346656037ull)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static void AddShadowCaster(const ShadowCaster &caster, entt::entity entity)
+{
+    if (IsDynamicCaster(entity)) {
+        s_data.dynamic_casters.push_back(caster);
+    }
+    else {
+        s_data.static_casters.push_back(caster);
+    }
+}
+
+// Order independent version of the casters drawn to a layer.
+static uint64_t GetCastersVersion(const std::vector<ShadowCaster> &casters,
+                                  uint32_t layer)
+{
+    uint64_t version = 0;
+    for (const auto &caster : casters) {
+        if (caster.mask & (1u << layer)) {
+            version += HashBytes(&caster, sizeof(ShadowCaster));
+        }
+    }
+    return version;
+}
+
+// Atlas regions of the layers of a shadow, nullptr if its layers are whole
+// texture layers.
+static const ShadowAtlas::Tile *GetShadowRegions(const CascadeShadow &)
+{
+    return nullptr;
+}
+
+static const ShadowAtlas::Tile *GetShadowRegions(const PointShadowTiles &tiles)
+{
+    return tiles.regions.data();
+}
+
+// Draw the casters to the layers in the mask, the layers must have been
+// cleared or filled beforehand. With regions, layer i is drawn to the
+// viewport regions[i] of a 2D map.
+static void DrawShadowCasters(Framebuffer *target, const Texture *map,
+                              Shader &shader, const Vector3f &eye,
+                              const std::vector<ShadowCaster> &casters,
+                              uint32_t layer_mask,
+                              const ShadowAtlas::Tile *regions = nullptr)
+{
+    RenderOperation op;
+    op.cull_face = Face::Front;
+    RenderPassInfo info{target, map->GetWidth(), map->GetHeight(), op};
+    info.clear_mask = BufferBitMask::None;
+    Renderer::BeginRenderPass(info);
+    for (uint32_t i = 0; regions && (layer_mask >> i); ++i) {
+        if (layer_mask & (1u << i)) {
+            s_data.device->SetViewportIndexed(i, regions[i].x, regions[i].y,
+                                              regions[i].size,
+                                              regions[i].size);
+        }
+    }
+    Renderer3D::BeginInstances(eye);
+    for (const auto &caster : casters) {
+        const uint32_t mask = caster.mask & layer_mask;
+        if (mask == 0) continue;
+
+        Renderer3D::AddInstance(*caster.mesh, nullptr,
+                                {caster.transform, caster.entity, mask});
+    }
+    Renderer3D::DrawInstances(shader);
+    Renderer::EndRenderPass();
+}
+
+static void ClearShadowLayers(Texture *map, uint32_t layer_mask,
+                              const ShadowAtlas::Tile *regions = nullptr)
+{
+    const float depth = 1.0f;
+    for (uint32_t i = 0; layer_mask >> i; ++i) {
+        if ((layer_mask & (1u << i)) == 0) continue;
+
+        if (regions) {
+            map->ClearPixels(0, regions[i].x, regions[i].y, 0,
+                             regions[i].size, regions[i].size, 1, &depth);
+        }
+        else {
+            map->ClearPixels(0, 0, 0, i, map->GetWidth(), map->GetHeight(), 1,
+                             &depth);
+        }
+    }
+}
+
+static void CopyShadowLayer(Texture *map, const Texture &src, uint32_t layer,
+                            const ShadowAtlas::Tile *regions = nullptr)
+{
+    if (regions) {
+        const ShadowAtlas::Tile &region = regions[layer];
+        map->CopyPixels(src, 0, region.x, region.y, 0, region.size,
+                        region.size, 1);
+    }
+    else {
+        map->CopyFrom(src, layer, 1);
+    }
+}
+
+// Redraw the layers of the shadow map whose light or casters changed, among
+// the layers due for an update. Layers with dynamic casters keep their
+// static casters cached in the static map and have the dynamic ones drawn
+// over a copy of it.
+template <typename T>
+static void UpdateShadowMap(T &shadow, const uint64_t *light_versions,
+                            uint32_t layer_count, uint32_t update_mask,
+                            Shader &shader, const Vector3f &eye)
+{
+    const auto &static_casters = s_data.static_casters;
+    const auto &dynamic_casters = s_data.dynamic_casters;
+    const ShadowAtlas::Tile *regions = GetShadowRegions(shadow);
+    uint32_t dirty_mask = 0;
+    uint32_t static_dirty_mask = 0;
+    uint32_t dynamic_mask = 0;
+    std::array<uint64_t, 32> versions;
+    std::array<uint64_t, 32> static_versions;
+    for (uint32_t i = 0; i < layer_count; ++i) {
+        // Layers never drawn are always due.
+        if ((update_mask & (1u << i)) == 0 && shadow.GetVersion(i) != 0) {
+            continue;
+        }
+        // Never 0, which marks an outdated layer.
+        static_versions[i] =
+            HashBytes(&light_versions[i], sizeof(uint64_t),
+                      GetCastersVersion(static_casters, i)) |
+            1;
+        versions[i] = static_versions[i];
+        const uint64_t dynamic_version =
+            GetCastersVersion(dynamic_casters, i);
+        if (dynamic_version != 0) {
+            versions[i] = HashBytes(&static_versions[i], sizeof(uint64_t),
+                                    dynamic_version) |
+                          1;
+            dynamic_mask |= 1u << i;
+        }
+        if (shadow.GetVersion(i) == versions[i]) continue;
+
+        dirty_mask |= 1u << i;
+        if ((dynamic_mask & (1u << i)) &&
+            (shadow.GetStaticShadowMap() == nullptr ||
+             shadow.GetStaticVersion(i) != static_versions[i])) {
+            static_dirty_mask |= 1u << i;
+        }
+    }
+    if (dirty_mask == 0) return;
+
+    if (static_dirty_mask) {
+        if (shadow.GetStaticShadowMap() == nullptr) {
+            shadow.CreateStaticShadowMap();
+        }
+        ClearShadowLayers(shadow.GetStaticShadowMap(), static_dirty_mask,
+                          regions);
+        DrawShadowCasters(shadow.GetStaticShadowTarget(),
+                          shadow.GetStaticShadowMap(), shader, eye,
+                          static_casters, static_dirty_mask, regions);
+    }
+
+    Texture *map = shadow.GetShadowMap();
+    for (uint32_t i = 0; i < layer_count; ++i) {
+        if ((dirty_mask & (1u << i)) == 0) continue;
+
+        if (dynamic_mask & (1u << i)) {
+            CopyShadowLayer(map, *shadow.GetStaticShadowMap(), i, regions);
+            shadow.SetStaticVersion(i, static_versions[i]);
+        }
+        else {
+            ClearShadowLayers(map, 1u << i, regions);
+        }
+        shadow.SetVersion(i, versions[i]);
+    }
+    DrawShadowCasters(shadow.GetShadowTarget(), map, shader, eye,
+                      static_casters, dirty_mask & ~dynamic_mask, regions);
+    DrawShadowCasters(shadow.GetShadowTarget(), map, shader, eye,
+                      dynamic_casters, dirty_mask & dynamic_mask, regions);
+}
+
+// Whether a cascade is updated this frame: the near ones every frame, the
+// far ones every cascade_update_interval frames, staggered so that they do
+// not all update on the same frame.
+static uint32_t GetCascadeUpdateMask(uint32_t num_of_cascades)
+{
+    const uint64_t interval =
+        std::max(s_settings.cascade_update_interval, 1);
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < num_of_cascades; ++i) {
+        if (static_cast<int>(i) < s_settings.cascade_every_frame_count ||
+            (s_data.frame + i) % interval == 0) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
 }
 
 void DeferredRenderPass::RenderShadowMap(const Scene &scene,
@@ -272,30 +942,51 @@ void DeferredRenderPass::RenderShadowMap(const Scene &scene,
                                          const Camera &camera,
                                          const Transform &transform)
 {
+    GPUProfileScope scope("Cascade Shadow Map");
     auto modelView = scene.view<TransformComponent, MeshComponent>();
-    RenderOperation op;
-    op.cull_face = Face::Front;
     Texture *depth_map = shadow.GetShadowMap();
-    Framebuffer *target = shadow.GetShadowTarget();
-    Renderer::BeginRenderPass(RenderPassInfo{target, depth_map->GetWidth(),
-                                             depth_map->GetHeight(), op});
-    shadow.ComputeCascadeLightMatrix(transform, camera);
+    const uint32_t update_mask =
+        GetCascadeUpdateMask(shadow.GetCascadePlanes().size());
+    shadow.ComputeCascadeLightMatrix(transform, camera, update_mask);
     Renderer3D::BindCascadeShadow(*s_data.cascade_shader);
     Renderer3D::SetCascadeShadow(shadow);
 
-    ShaderParam *model_param = s_data.cascade_shader->GetParam("u_model");
-    modelView.each([&](const TransformComponent &tc, const MeshComponent &mc) {
+    // The geometry shader only emits to the cascades in the mask.
+    const auto &projection_views = shadow.GetLevelProjectionView();
+    const uint32_t num_of_cascades =
+        std::min<uint32_t>(projection_views.size(), MAX_CASCADE_COUNT);
+    std::array<Math::Frustum, MAX_CASCADE_COUNT> frustums;
+    std::array<uint64_t, MAX_CASCADE_COUNT> light_versions;
+    for (uint32_t i = 0; i < num_of_cascades; ++i) {
+        frustums[i] = Math::Frustum(projection_views[i]);
+        // The cascades follow the camera, so they are part of the version.
+        light_versions[i] = HashBytes(&projection_views[i], sizeof(Matrix4f));
+    }
+
+    s_data.static_casters.clear();
+    s_data.dynamic_casters.clear();
+    modelView.each([&](const entt::entity &entity,
+                       const TransformComponent &tc, const MeshComponent &mc) {
+        if (!s_models->Contains(mc.model_id)) return;
+
+        auto &mesh = s_models->Get(mc.model_id)->GetMesh(mc.mesh_index);
         Matrix4f mat = tc.GetWorldTransform().GetMatrix();
-        model_param->SetAsMat4(&mat[0][0]);
-        if (s_models->Contains(mc.model_id)) {
-            auto &mesh = s_models->Get(mc.model_id)->GetMesh(mc.mesh_index);
-            Renderer3D::DrawMesh(*s_data.cascade_shader, mesh);
-        }
+        const uint32_t mask =
+            GetShadowMask(frustums.data(), num_of_cascades, mesh, mat);
+        if (mask == 0) return;
+
+        AddShadowCaster({&mesh, mat, static_cast<uint32_t>(entity), mask},
+                        entity);
     });
-    Renderer::EndRenderPass();
 
-    // debug
-    {
+    // Front to back along the light direction, seen from behind the
+    // camera's far plane.
+    UpdateShadowMap(shadow, light_versions.data(), num_of_cascades,
+                    update_mask, *s_data.cascade_shader,
+                    camera.GetWorldPosition() -
+                        transform.GetFront() * camera.GetFarZ());
+
+    if (s_data.cascade_debug_buffer) {
         Renderer::BeginRenderPass(RenderPassInfo{
             s_data.cascade_debug_target.get(),
             s_data.cascade_debug_buffer->GetWidth(),
@@ -314,23 +1005,168 @@ void DeferredRenderPass::RenderShadowMap(const Scene &scene,
     }
 }
 
+// Diameter in pixels of a sphere in the region drawn, unbounded if the
+// camera is inside it.
+static float GetScreenDiameter(const Camera &camera,
+                               const Math::BoundingSphere &sphere)
+{
+    const Matrix4f &projection = camera.GetProjection();
+    const float scale = projection[1][1] * s_data.viewport_height;
+    if (projection[3][3] != 0) return sphere.radius * scale;
+
+    const Vector3f offset = sphere.center - camera.GetWorldPosition();
+    const float distance2 = glm::dot(offset, offset);
+    const float radius2 = sphere.radius * sphere.radius;
+    if (distance2 <= radius2) return std::numeric_limits<float>::max();
+
+    return sphere.radius / std::sqrt(distance2 - radius2) * scale;
+}
+
+// Tile size of a point light covering the pixels on screen, 0 for no
+// shadow. A light keeps its current size until the ideal one is a quarter
+// off it, so that it does not flip every frame around a power of two.
+static int32_t GetPointShadowTileSize(float pixels, int32_t current)
+{
+    if (pixels < s_settings.point_shadow_min_pixels) return 0;
+
+    const ShadowAtlas &atlas = s_data.point_shadow_atlas;
+    const float ideal = pixels * s_settings.point_shadow_resolution_scale;
+    if (current > 0 && ideal > current * 0.375f && ideal <= current * 1.25f) {
+        return current;
+    }
+    const int32_t max_size =
+        std::min(s_settings.point_shadow_max_tile_size, atlas.GetSize());
+    int32_t size = atlas.GetMinTileSize();
+    while (size < ideal && size < max_size) {
+        size *= 2;
+    }
+    return size;
+}
+
+static void FreePointShadowTiles(PointShadowTiles &tiles)
+{
+    if (!tiles.HasTiles()) return;
+
+    for (auto &tile : tiles.tiles) {
+        tiles.atlas->Free(tile);
+        tile = -1;
+    }
+    tiles.versions.fill(0);
+    tiles.static_versions.fill(0);
+}
+
+// Six tiles of the largest size the atlas still has room for, up to the
+// requested one.
+static void AllocatePointShadowTiles(PointShadowTiles &tiles)
+{
+    ShadowAtlas &atlas = *tiles.atlas;
+    for (int32_t size = tiles.request; size >= atlas.GetMinTileSize();
+         size /= 2) {
+        uint32_t count = 0;
+        while (count < 6 && (tiles.tiles[count] = atlas.Allocate(size)) >= 0) {
+            ++count;
+        }
+        if (count == 6) {
+            for (uint32_t i = 0; i < 6; ++i) {
+                tiles.regions[i] = atlas.GetTile(tiles.tiles[i]);
+            }
+            return;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            atlas.Free(tiles.tiles[i]);
+        }
+        tiles.tiles.fill(-1);
+    }
+}
+
+// Tiles of a point light shadowed this frame, nullptr if it has none.
+static PointShadowTiles *GetPointShadowTiles(entt::entity entity)
+{
+    auto iter = s_data.point_shadow_tiles.find(entity);
+    if (iter == s_data.point_shadow_tiles.end() || !iter->second.HasTiles()) {
+        return nullptr;
+    }
+    return &iter->second;
+}
+
+void DeferredRenderPass::UpdatePointShadowTiles(const Scene &scene,
+                                                const Camera &camera)
+{
+    ShadowAtlas &atlas = s_data.point_shadow_atlas;
+    auto &states = s_data.point_shadow_tiles;
+    if (atlas.GetSize() != s_settings.point_shadow_atlas_size ||
+        atlas.GetMinTileSize() != s_settings.point_shadow_min_tile_size) {
+        states.clear();
+        atlas.Reset(s_settings.point_shadow_atlas_size,
+                    s_settings.point_shadow_min_tile_size);
+    }
+    if (atlas.GetShadowMap() == nullptr) {
+        atlas.CreateShadowMap();
+    }
+
+    // Lights whose requested size changed give their tiles back first, the
+    // ones without tiles then get them, the largest first.
+    const uint64_t frame = s_data.frame;
+    const Math::Frustum frustum(camera.GetViewPorjection());
+    auto &pending = s_data.pending_point_shadows;
+    pending.clear();
+    auto point_lights = scene.view<TransformComponent, PointLightComponent>();
+    point_lights.each([&](const entt::entity &entity,
+                          const TransformComponent &transformComp,
+                          const PointLightComponent &lightComp) {
+        if (!lightComp.is_cast_shadow) return;
+
+        PointShadowTiles &tiles = states[entity];
+        tiles.atlas = &atlas;
+        tiles.seen_frame = frame;
+        const Math::BoundingSphere range(
+            transformComp.GetWorldTransform().GetPosition(),
+            std::min(lightComp.shadow.GetFarZ(),
+                     lightComp.light.GetRadius()));
+        int32_t request = 0;
+        if (frustum.Intersects(range)) {
+            request = GetPointShadowTileSize(GetScreenDiameter(camera, range),
+                                             tiles.request);
+        }
+        if (request != tiles.request) {
+            FreePointShadowTiles(tiles);
+            tiles.request = request;
+        }
+        if (request > 0 && !tiles.HasTiles()) {
+            pending.push_back(&tiles);
+        }
+    });
+    for (auto iter = states.begin(); iter != states.end();) {
+        if (iter->second.seen_frame != frame) {
+            FreePointShadowTiles(iter->second);
+            iter = states.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](const PointShadowTiles *lhs,
+                        const PointShadowTiles *rhs) {
+                         return lhs->request > rhs->request;
+                     });
+    for (PointShadowTiles *tiles : pending) {
+        AllocatePointShadowTiles(*tiles);
+    }
+}
+
 void DeferredRenderPass::RenderPointShadowMap(const Scene &scene,
                                               PointShadow &shadow,
+                                              PointShadowTiles &tiles,
                                               const Transform &transform)
 {
+    GPUProfileScope scope("Point Shadow Map");
     Vector3f light_pos = transform.GetPosition();
     std::array<Matrix4f, 6> shadow_trans =
         shadow.GetProjectionMatrix(light_pos);
 
     auto modelView = scene.view<TransformComponent, MeshComponent>();
-    RenderOperation op;
-    op.cull_face = Face::Front;
-    Texture *shadow_map = shadow.GetShadowMap();
-    Framebuffer *shadow_target = shadow.GetShadowTarget();
-    Renderer::BeginRenderPass(RenderPassInfo{
-        shadow_target, shadow_map->GetWidth(), shadow_map->GetHeight(), op});
 
-    ShaderParam *model_param = s_data.point_shadow_shader->GetParam("u_model");
     s_data.point_shadow_shader->GetParam("u_light_pos")
         ->SetAsVec3(&transform.GetPosition()[0]);
     s_data.point_shadow_shader->GetParam("u_far_z")->SetAsFloat(
@@ -338,86 +1174,225 @@ void DeferredRenderPass::RenderPointShadowMap(const Scene &scene,
     s_data.point_shadow_shader->GetParam("u_shadow_matrix[0]")
         ->SetAsMat4(&shadow_trans[0][0][0], 6);
 
-    modelView.each([&](const TransformComponent &tc, const MeshComponent &mc) {
+    const float far_z = shadow.GetFarZ();
+    std::array<Math::Frustum, 6> frustums;
+    std::array<uint64_t, 6> light_versions;
+    for (uint32_t i = 0; i < 6; ++i) {
+        frustums[i] = Math::Frustum(shadow_trans[i]);
+        light_versions[i] = HashBytes(&shadow_trans[i], sizeof(Matrix4f),
+                                      HashBytes(&far_z, sizeof(float)));
+    }
+
+    s_data.static_casters.clear();
+    s_data.dynamic_casters.clear();
+    modelView.each([&](const entt::entity &entity,
+                       const TransformComponent &tc, const MeshComponent &mc) {
+        if (!s_models->Contains(mc.model_id)) return;
+
+        auto &mesh = s_models->Get(mc.model_id)->GetMesh(mc.mesh_index);
         Matrix4f mat = tc.GetWorldTransform().GetMatrix();
-        model_param->SetAsMat4(&mat[0][0]);
-        if (s_models->Contains(mc.model_id)) {
-            auto &mesh = s_models->Get(mc.model_id)->GetMesh(mc.mesh_index);
-            Renderer3D::DrawMesh(*s_data.point_shadow_shader, mesh);
+        // Outside the light's range.
+        const Math::BoundingSphere &sphere = mesh.GetBoundingSphere();
+        if (sphere.IsValid()) {
+            const Math::BoundingSphere world = sphere.Transform(mat);
+            if (glm::distance(world.center, light_pos) - world.radius > far_z)
+                return;
         }
+        const uint32_t mask = GetShadowMask(frustums.data(), 6, mesh, mat);
+        if (mask == 0) return;
+
+        AddShadowCaster({&mesh, mat, static_cast<uint32_t>(entity), mask},
+                        entity);
     });
-    Renderer::EndRenderPass();
+
+    UpdateShadowMap(tiles, light_versions.data(), 6, ~0u,
+                    *s_data.point_shadow_shader, light_pos);
+}
+
+static Texture *GetGBufferMSAA(GeometryBufferType type)
+{
+    return s_data.gbuffer_msaa[static_cast<int>(type)];
+}
+
+// Texels of a level of a full size texture covered by the viewport.
+static int32_t GetViewportTexels(int32_t size, int32_t level)
+{
+    return std::max((size + (1 << level) - 1) >> level, 1);
+}
+
+void DeferredRenderPass::DownsampleSSAOInput()
+{
+    Shader &shader = *s_data.ssao_downsample_shader;
+    ShaderParam *depth = shader.GetParam("u_depth");
+    ShaderParam *normal = shader.GetParam("u_normal");
+    ShaderParam *level = shader.GetParam("u_level");
+    ShaderParam *out_depth = shader.GetParam("u_out_depth");
+    ShaderParam *out_normal = shader.GetParam("u_out_normal");
+    for (int i = 0; i < s_data.ssao_depth->GetMipmapLevels(); ++i) {
+        // The first level reads the G-buffer, the others the level above.
+        if (i == 0) {
+            depth->SetAsTexture(s_data.depth_resolved);
+            normal->SetAsTexture(
+                s_data.gbuffer[static_cast<int>(GeometryBufferType::Normal)]);
+        }
+        else {
+            depth->SetAsTexture(s_data.ssao_depth);
+            normal->SetAsTexture(s_data.ssao_normal);
+        }
+        level->SetAsInt(std::max(i - 1, 0));
+        out_depth->SetAsImage(s_data.ssao_depth, i, false, 0,
+                              Access::WriteOnly);
+        out_normal->SetAsImage(s_data.ssao_normal, i, false, 0,
+                               Access::WriteOnly);
+        Renderer::ComputeImage(shader,
+                               GetViewportTexels(s_data.viewport_width, i + 1),
+                               GetViewportTexels(s_data.viewport_height, i + 1),
+                               1);
+    }
 }
 
 void DeferredRenderPass::RenderSSAO()
 {
-    Texture *position =
-        s_data.gbuffer[static_cast<int>(GeometryBufferType::Position)].get();
+    Texture *depth = s_data.depth_resolved;
     Texture *normal =
-        s_data.gbuffer[static_cast<int>(GeometryBufferType::Normal)].get();
+        s_data.gbuffer[static_cast<int>(GeometryBufferType::Normal)];
+    int32_t lod = 0;
+    if (s_data.ssao_depth) {
+        depth = s_data.ssao_depth;
+        normal = s_data.ssao_normal;
+        lod = depth->GetMipmapLevels() - 1;
+    }
+    const int32_t levels = static_cast<int32_t>(s_settings.ssao_resolution);
+    const int32_t width = GetViewportTexels(s_data.viewport_width, levels);
+    const int32_t height = GetViewportTexels(s_data.viewport_height, levels);
     Renderer::BindCamera(*s_data.ssao_shader);
     s_data.ssao_shader->GetParam("u_radius")
         ->SetAsFloat(s_settings.ssao_radius);
     s_data.ssao_shader->GetParam("u_bias")->SetAsFloat(s_settings.ssao_bias);
     s_data.ssao_shader->GetParam("u_power")->SetAsUint(s_settings.ssao_power);
-    s_data.ssao_shader->GetParam("u_position")->SetAsTexture(position);
+    s_data.ssao_shader->GetParam("u_depth")->SetAsTexture(depth);
     s_data.ssao_shader->GetParam("u_normal")->SetAsTexture(normal);
+    s_data.ssao_shader->GetParam("u_lod")->SetAsInt(lod);
     s_data.ssao_shader->GetParam("u_noise")->SetAsTexture(
         s_data.ssao_noise.get());
     s_data.ssao_shader->GetParam("u_out_image")
-        ->SetAsImage(s_data.ssao_buffer.get(), 0, false, 0, Access::WriteOnly);
-    Renderer::ComputeImage(*s_data.ssao_shader, s_settings.width,
-                           s_settings.height, 1);
+        ->SetAsImage(s_data.ssao_buffer, 0, false, 0, Access::WriteOnly);
+    Renderer::ComputeImage(*s_data.ssao_shader, width, height, 1);
 
     // blur
+    GPUProfileScope scope("Blur");
     s_data.ssao_blur_shader->GetParam("u_input")->SetAsTexture(
-        s_data.ssao_buffer.get());
+        s_data.ssao_buffer);
     s_data.ssao_blur_shader->GetParam("u_out_image")
-        ->SetAsImage(s_data.ssao_blur_buffer.get(), 0, false, 0,
+        ->SetAsImage(s_data.ssao_blur_buffer, 0, false, 0,
                      Access::WriteOnly);
-    Renderer::ComputeImage(*s_data.ssao_blur_shader, s_settings.width,
-                           s_settings.height, 1);
+    Renderer::ComputeImage(*s_data.ssao_blur_shader, width, height, 1);
+}
+
+void DeferredRenderPass::UpsampleSSAO()
+{
+    Shader &shader = *s_data.ssao_upsample_shader;
+    Renderer::BindCamera(shader);
+    shader.GetParam("u_depth")->SetAsTexture(s_data.depth_resolved);
+    shader.GetParam("u_normal")->SetAsTexture(
+        s_data.gbuffer[static_cast<int>(GeometryBufferType::Normal)]);
+    shader.GetParam("u_ssao")->SetAsTexture(s_data.ssao_blur_buffer);
+    shader.GetParam("u_low_depth")->SetAsTexture(s_data.ssao_depth);
+    shader.GetParam("u_low_normal")->SetAsTexture(s_data.ssao_normal);
+    shader.GetParam("u_lod")->SetAsInt(s_data.ssao_depth->GetMipmapLevels() -
+                                       1);
+    shader.GetParam("u_out_image")
+        ->SetAsImage(s_data.ssao_result, 0, false, 0, Access::WriteOnly);
+    Renderer::ComputeImage(shader, s_data.viewport_width,
+                           s_data.viewport_height, 1);
 }
 
 void DeferredRenderPass::RenderEmissive()
 {
+    GPUProfileScope scope("Emissive");
     RenderOperation op;
     op.blend = false;
     const int buffer = 0;
     Renderer::BeginRenderSubpass(RenderSubpassInfo{&buffer, 1, op});
     s_data.emssive_shader->GetParam("u_lighting")
         ->SetAsTexture(s_data.lighting_result);
-    s_data.emssive_shader->GetParam("u_emissive")
-        ->SetAsTexture(
-            s_data.gbuffer_msaa[static_cast<int>(GeometryBufferType::Emissive)]
-                .get());
+    s_data.emssive_shader->GetParam("u_ambient_emissive")
+        ->SetAsTexture(GetGBufferMSAA(GeometryBufferType::AmbientEmissive));
     Renderer::DrawNDCQuad(*s_data.emssive_shader);
     Renderer::EndRenderSubpass();
 }
 
+uint32_t DeferredRenderPass::UpdateLightCluster(const Scene &scene,
+                                                const Camera &camera)
+{
+    auto &lights = s_data.cluster_lights;
+    auto &bounds = s_data.cluster_light_bounds;
+    lights.clear();
+    bounds.clear();
+    auto point_lights = scene.view<TransformComponent, PointLightComponent>();
+    point_lights.each([&](const entt::entity &entity,
+                          const TransformComponent &transformComp,
+                          const PointLightComponent &lightComp) {
+        // Lights without shadow tiles this frame are shaded here too.
+        if (GetPointShadowTiles(entity)) return;
+
+        const PointLight &light = lightComp.light;
+        const Vector3f pos = transformComp.GetWorldTransform().GetPosition();
+        lights.push_back({Vector4f(pos, 1.f), Vector4f(light.ambient, 0.f),
+                          Vector4f(light.diffuse, 0.f),
+                          Vector4f(light.specular, 0.f),
+                          Vector4f(light.constant, light.linear,
+                                   light.quadratic, 0.f)});
+        bounds.emplace_back(pos, light.GetRadius());
+    });
+    if (lights.empty()) return 0;
+
+    LightCluster &cluster = s_data.light_cluster;
+    cluster.SetProjection(camera.GetProjection(), camera.GetNearZ(),
+                          camera.GetFarZ());
+    cluster.Assign(camera.GetView(), bounds);
+
+    s_data.cluster_light_buffer->UpdateData(
+        lights.data(), lights.size() * sizeof(ClusterLightData));
+    s_data.cluster_grid_buffer->UpdateData(
+        cluster.GetClusters().data(),
+        cluster.GetClusters().size() * sizeof(LightCluster::Cluster));
+    const auto &indices = cluster.GetLightIndices();
+    if (!indices.empty()) {
+        s_data.cluster_index_buffer->UpdateData(
+            indices.data(), indices.size() * sizeof(uint32_t));
+    }
+
+    Shader &shader = *s_data.deferred_shader;
+    shader.SetStorageBuffer("ClusterLights", *s_data.cluster_light_buffer);
+    shader.SetStorageBuffer("ClusterGrid", *s_data.cluster_grid_buffer);
+    shader.SetStorageBuffer("ClusterIndices", *s_data.cluster_index_buffer);
+    const int size[3] = {static_cast<int>(cluster.GetSizeX()),
+                         static_cast<int>(cluster.GetSizeY()),
+                         static_cast<int>(cluster.GetSizeZ())};
+    shader.GetParam("u_cluster_size[0]")->SetAsVec(size, 3);
+    shader.GetParam("u_cluster_near_z")->SetAsFloat(cluster.GetNearZ());
+    shader.GetParam("u_cluster_far_z")->SetAsFloat(cluster.GetFarZ());
+    shader.GetParam("u_cluster_perspective")
+        ->SetAsBool(cluster.IsPerspective());
+    return lights.size();
+}
+
 void DeferredRenderPass::RenderDeferred(Scene &scene)
 {
-    s_data.deferred_shader->GetParam("u_position")
-        ->SetAsTexture(
-            s_data.gbuffer_msaa[static_cast<int>(GeometryBufferType::Position)]
-                .get());
+    s_data.deferred_shader->GetParam("u_depth")->SetAsTexture(
+        s_data.depth_buffer);
     s_data.deferred_shader->GetParam("u_normal")
-        ->SetAsTexture(
-            s_data.gbuffer_msaa[static_cast<int>(GeometryBufferType::Normal)]
-                .get());
+        ->SetAsTexture(GetGBufferMSAA(GeometryBufferType::Normal));
     s_data.deferred_shader->GetParam("u_albedo")
-        ->SetAsTexture(
-            s_data.gbuffer_msaa[static_cast<int>(GeometryBufferType::Albedo)]
-                .get());
-    s_data.deferred_shader->GetParam("u_ambient")
-        ->SetAsTexture(
-            s_data.gbuffer_msaa[static_cast<int>(GeometryBufferType::Ambient)]
-                .get());
+        ->SetAsTexture(GetGBufferMSAA(GeometryBufferType::Albedo));
+    s_data.deferred_shader->GetParam("u_ambient_emissive")
+        ->SetAsTexture(GetGBufferMSAA(GeometryBufferType::AmbientEmissive));
     s_data.deferred_shader->GetParam("u_background")
         ->SetAsTexture(
             Renderer::GetCurrentRenderPass().framebuffer->GetAttachment(0));
     s_data.deferred_shader->GetParam("u_ssao")->SetAsTexture(
-        s_data.ssao_blur_buffer.get());
+        s_data.ssao_result);
     s_data.deferred_shader->GetParam("u_ssao_state")
         ->SetAsBool(s_settings.ssao_state);
 
@@ -434,6 +1409,8 @@ void DeferredRenderPass::RenderDeferred(Scene &scene)
         s_data.deferred_shader->GetParam("u_is_directional");
     ShaderParam *is_cast_shadow =
         s_data.deferred_shader->GetParam("u_is_cast_shadow");
+    ShaderParam *is_clustered =
+        s_data.deferred_shader->GetParam("u_is_clustered");
 
     ShaderParam *cascade_map =
         s_data.deferred_shader->GetParam("u_cascade_map");
@@ -454,24 +1431,28 @@ void DeferredRenderPass::RenderDeferred(Scene &scene)
     // clear the last lighting pass' result
     const float value[]{0, 0, 0};
     s_data.lighting_target[input_id]->ClearAttachment(0, value);
+    is_clustered->SetAsBool(false);
     auto dir_lights =
         scene.view<TransformComponent, DirectionalLightComponent>();
-    dir_lights.each([&](const TransformComponent &transformComp,
+    dir_lights.each([&](const entt::entity &entity,
+                        const TransformComponent &transformComp,
                         DirectionalLightComponent &lightComp) {
+        GPUProfileScope scope(fmt::format("Directional Light {}",
+                                          static_cast<uint32_t>(entity)));
         const DirectionalLight &light = lightComp.light;
         const Transform &transform = transformComp.GetWorldTransform();
 
         RenderPassInfo info{s_data.lighting_target[output_id].get(),
-                            s_data.lighting_buffers[output_id]->GetWidth(),
-                            s_data.lighting_buffers[output_id]->GetHeight(),
+                            s_data.viewport_width,
+                            s_data.viewport_height,
                             op,
                             BufferBitMask::ColorBufferBit,
                             {0, 0, 0, 0}};
-        s_data.lighting_result = s_data.lighting_buffers[output_id].get();
+        s_data.lighting_result = s_data.lighting_buffers[output_id];
 
         Renderer::BeginRenderPass(info);
 
-        lighting->SetAsTexture(s_data.lighting_buffers[input_id].get());
+        lighting->SetAsTexture(s_data.lighting_buffers[input_id]);
         light_front->SetAsVec3(&transform.GetFront()[0]);
         ambient->SetAsVec3(&light.ambient[0]);
         diffuse->SetAsVec3(&light.diffuse[0]);
@@ -493,6 +1474,31 @@ void DeferredRenderPass::RenderDeferred(Scene &scene)
         Renderer::EndRenderPass();
     });
 
+    UpdatePointShadowTiles(scene, *camera);
+
+    // All the point lights without shadow in a single pass.
+    if (s_settings.clustered_lighting &&
+        UpdateLightCluster(scene, *camera) > 0) {
+        GPUProfileScope scope("Clustered Point Lights");
+        RenderPassInfo info{s_data.lighting_target[output_id].get(),
+                            s_data.viewport_width,
+                            s_data.viewport_height,
+                            op,
+                            BufferBitMask::ColorBufferBit,
+                            {0, 0, 0, 0}};
+        s_data.lighting_result = s_data.lighting_buffers[output_id];
+
+        Renderer::BeginRenderPass(info);
+        lighting->SetAsTexture(s_data.lighting_buffers[input_id]);
+        is_clustered->SetAsBool(true);
+        is_directional->SetAsBool(false);
+        is_cast_shadow->SetAsBool(false);
+        Renderer::DrawNDCQuad(*s_data.deferred_shader);
+        is_clustered->SetAsBool(false);
+        std::swap(input_id, output_id);
+        Renderer::EndRenderPass();
+    }
+
     ShaderParam *light_position =
         s_data.deferred_shader->GetParam("u_point_light.pos");
     ShaderParam *constant =
@@ -505,23 +1511,35 @@ void DeferredRenderPass::RenderDeferred(Scene &scene)
         s_data.deferred_shader->GetParam("u_point_shadow_map");
     ShaderParam *point_shadow_far_z =
         s_data.deferred_shader->GetParam("u_point_shadow_far_z");
+    ShaderParam *point_shadow_matrix =
+        s_data.deferred_shader->GetParam("u_point_shadow_matrix[0]");
+    ShaderParam *point_shadow_tiles =
+        s_data.deferred_shader->GetParam("u_point_shadow_tiles[0]");
+    const float atlas_size = s_data.point_shadow_atlas.GetSize();
     auto point_lights = scene.view<TransformComponent, PointLightComponent>();
-    point_lights.each([&](const TransformComponent &transformComp,
+    point_lights.each([&](const entt::entity &entity,
+                          const TransformComponent &transformComp,
                           PointLightComponent &lightComp) {
+        PointShadowTiles *tiles = GetPointShadowTiles(entity);
+        if (s_settings.clustered_lighting && tiles == nullptr) {
+            return;
+        }
+        GPUProfileScope scope(
+            fmt::format("Point Light {}", static_cast<uint32_t>(entity)));
         const PointLight &light = lightComp.light;
         const Transform &transform = transformComp.GetWorldTransform();
 
         RenderPassInfo info{s_data.lighting_target[output_id].get(),
-                            s_data.lighting_buffers[output_id]->GetWidth(),
-                            s_data.lighting_buffers[output_id]->GetHeight(),
+                            s_data.viewport_width,
+                            s_data.viewport_height,
                             op,
                             BufferBitMask::ColorBufferBit,
                             {0, 0, 0, 0}};
-        s_data.lighting_result = s_data.lighting_buffers[output_id].get();
+        s_data.lighting_result = s_data.lighting_buffers[output_id];
 
         Renderer::BeginRenderPass(info);
 
-        lighting->SetAsTexture(s_data.lighting_buffers[input_id].get());
+        lighting->SetAsTexture(s_data.lighting_buffers[input_id]);
         light_front->SetAsVec3(&transform.GetFront()[0]);
         light_position->SetAsVec3(&transform.GetPosition()[0]);
         ambient->SetAsVec3(&light.ambient[0]);
@@ -532,12 +1550,25 @@ void DeferredRenderPass::RenderDeferred(Scene &scene)
         quadratic->SetAsFloat(light.quadratic);
 
         is_directional->SetAsBool(false);
-        is_cast_shadow->SetAsBool(lightComp.is_cast_shadow);
-        if (lightComp.is_cast_shadow) {
-            RenderPointShadowMap(scene, lightComp.shadow, transform);
-
-            point_shadow_map->SetAsTexture(lightComp.shadow.GetShadowMap());
+        is_cast_shadow->SetAsBool(tiles != nullptr);
+        if (tiles) {
+            RenderPointShadowMap(scene, lightComp.shadow, *tiles, transform);
+
+            std::array<Vector4f, 6> uv_regions;
+            for (uint32_t i = 0; i < 6; ++i) {
+                const ShadowAtlas::Tile &region = tiles->regions[i];
+                uv_regions[i] = Vector4f(region.x, region.y, region.size,
+                                         region.size) /
+                                atlas_size;
+            }
+            point_shadow_map->SetAsTexture(
+                s_data.point_shadow_atlas.GetShadowMap());
             point_shadow_far_z->SetAsFloat(lightComp.shadow.GetFarZ());
+            point_shadow_matrix->SetAsMat4(
+                &lightComp.shadow.GetProjectionMatrix(
+                    transform.GetPosition())[0][0][0],
+                6);
+            point_shadow_tiles->SetAsVec4(&uv_regions[0][0], 6);
         }
 
         Renderer::DrawNDCQuad(*s_data.deferred_shader);
@@ -550,41 +1581,53 @@ void DeferredRenderPass::RenderGBuffer(const Scene &scene)
 {
     auto meshes = scene.view<TransformComponent, MeshComponent>();
 
+    // Cull against the camera and queue the visible meshes front to back
+    // before submitting anything.
+    const Camera *camera = Renderer::GetCamera();
+    const Math::Frustum frustum(camera->GetViewPorjection());
+    Renderer3D::BeginInstances(camera->GetWorldPosition());
+    meshes.each([&](const entt::entity &entity,
+                    const TransformComponent &transform,
+                    const MeshComponent &mc) {
+        if (!s_models->Contains(mc.model_id)) return;
+
+        auto &mesh = s_models->Get(mc.model_id)->GetMesh(mc.mesh_index);
+        Matrix4f mat = transform.GetWorldTransform().GetMatrix();
+        if (Renderer3D::IsVisible(frustum, mesh, mat)) {
+            Renderer3D::AddInstance(
+                mesh, &mc.material,
+                {mat, static_cast<uint32_t>(entity), ~0u});
+        }
+    });
+
     RenderPassInfo info;
     info.framebuffer = s_data.geometry_target_msaa.get();
-    info.viewport_width = s_settings.width;
-    info.viewport_height = s_settings.height;
+    info.viewport_width = s_data.viewport_width;
+    info.viewport_height = s_data.viewport_height;
     info.clear_mask =
         BufferBitMask::ColorBufferBit | BufferBitMask::DepthBufferBit;
     info.clear_value = {0, 0, 0, 0};
     info.op.blend = false;
     Renderer::BeginRenderPass(info);
     Renderer::BindCamera(*s_data.gbuffer_shader);
-    uint32_t id = static_cast<uint32_t>(entt::null);
+    Renderer3D::BindMaterials(*s_data.gbuffer_shader);
+    // Integer attachments are not cleared by the clear color.
+    const uint32_t zero = 0;
     s_data.geometry_target_msaa->ClearAttachment(
-        static_cast<int>(GeometryBufferType::EntityId), &id);
-
-    ShaderParam *entity_id = s_data.gbuffer_shader->GetParam("u_entity_id");
-    ShaderParam *model_param = s_data.gbuffer_shader->GetParam("u_model");
-    meshes.each([&](const entt::entity &entity,
-                    const TransformComponent &transform,
-                    const MeshComponent &mc) {
-        entity_id->SetAsUint(static_cast<uint32_t>(entity));
-        Matrix4f mat = transform.GetWorldTransform().GetMatrix();
-        model_param->SetAsMat4(&mat[0][0]);
+        static_cast<int>(GeometryBufferType::AmbientEmissive), &zero);
+    if (s_settings.entity_id_state) {
+        uint32_t id = static_cast<uint32_t>(entt::null);
+        s_data.geometry_target_msaa->ClearAttachment(
+            static_cast<int>(GeometryBufferType::EntityId), &id);
+    }
 
-        if (s_models->Contains(mc.model_id)) {
-            auto &mesh = s_models->Get(mc.model_id)->GetMesh(mc.mesh_index);
-            Renderer3D::SetMaterial(*s_data.gbuffer_shader, mc.material);
-            Renderer3D::DrawMesh(*s_data.gbuffer_shader, mesh);
-        }
-    });
+    Renderer3D::DrawInstances(*s_data.gbuffer_shader);
     Renderer::EndRenderPass();
 }
 
 Texture *DeferredRenderPass::GetEntityBuffer()
 {
-    return s_data.gbuffer[static_cast<int>(GeometryBufferType::EntityId)].get();
+    return s_settings.entity_id_state ? s_data.entity_buffer.get() : nullptr;
 }
 
 }  // namespace SD
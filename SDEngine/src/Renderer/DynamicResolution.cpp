@@ -0,0 +1,113 @@
+#include "Renderer/DynamicResolution.hpp"
+#include "ImGui/ImGuiWidget.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SD {
+
+// Weight of the last frame in the average frame time.
+static const float FRAME_TIME_WEIGHT = 0.25f;
+// The scale grows when the frame time is under this share of the target.
+static const float SCALE_UP_HEADROOM = 0.85f;
+static const float SCALE_UP_STEP = 0.05f;
+// Frames to wait after a change, the queries lag QUERY_COUNT frames behind.
+static const int32_t SCALE_COOLDOWN = 8;
+static const int32_t SIZE_ALIGNMENT = 8;
+
+DynamicResolution::DynamicResolution()
+    : m_query_index(0),
+      m_cpu_time(0),
+      m_gpu_time(0),
+      m_frame_time(0),
+      m_scale(1.f),
+      m_cooldown(0)
+{
+    for (auto &query : m_queries) {
+        query = TimerQuery::Create();
+    }
+    m_pending.fill(false);
+}
+
+void DynamicResolution::BeginFrame()
+{
+    // The query about to be reused was issued QUERY_COUNT frames ago and
+    // is usually done by now, if not its frame is skipped.
+    TimerQuery &query = *m_queries[m_query_index];
+    if (m_pending[m_query_index] && query.IsReady()) {
+        m_gpu_time = query.GetElapsedMS();
+    }
+    query.Begin();
+    m_clock.Restart();
+}
+
+void DynamicResolution::EndFrame()
+{
+    m_cpu_time = m_clock.GetElapsedMS();
+    m_queries[m_query_index]->End();
+    m_pending[m_query_index] = true;
+    m_query_index = (m_query_index + 1) % QUERY_COUNT;
+    Update();
+}
+
+void DynamicResolution::Update()
+{
+    const float frame_time = std::max(m_cpu_time, m_gpu_time);
+    m_frame_time += (frame_time - m_frame_time) * FRAME_TIME_WEIGHT;
+
+    const float min_scale = std::clamp(m_settings.min_scale, 0.1f, 1.f);
+    const float max_scale = std::clamp(m_settings.max_scale, min_scale, 1.f);
+    if (!m_settings.enabled) {
+        m_scale = 1.f;
+        m_cooldown = 0;
+        return;
+    }
+    if (m_cooldown > 0) {
+        --m_cooldown;
+        return;
+    }
+
+    const float target = m_settings.target_frame_time;
+    float scale = m_scale;
+    if (m_frame_time > target) {
+        // The cost follows the pixel count, the square of the scale.
+        scale *= std::sqrt(target / m_frame_time);
+    }
+    else if (m_frame_time < target * SCALE_UP_HEADROOM) {
+        scale += SCALE_UP_STEP;
+    }
+    scale = std::clamp(scale, min_scale, max_scale);
+    if (scale != m_scale) {
+        m_scale = scale;
+        m_cooldown = SCALE_COOLDOWN;
+    }
+}
+
+Vector2i DynamicResolution::GetRenderSize(int32_t width, int32_t height) const
+{
+    // Only scaled sizes are aligned, at full scale the output is rendered
+    // as is without a resample.
+    if (!m_settings.enabled || m_scale >= 1.f) {
+        return Vector2i(width, height);
+    }
+    auto scale = [this](int32_t size) {
+        const int32_t scaled =
+            static_cast<int32_t>(size * m_scale) / SIZE_ALIGNMENT *
+            SIZE_ALIGNMENT;
+        return std::clamp(scaled, std::min(size, SIZE_ALIGNMENT), size);
+    };
+    return Vector2i(scale(width), scale(height));
+}
+
+void DynamicResolution::ImGui()
+{
+    ImGui::Checkbox("Dynamic Resolution", &m_settings.enabled);
+    ImGui::SliderFloat("Target Frame Time", &m_settings.target_frame_time, 4,
+                       50, "%.1f ms");
+    ImGui::SliderFloat("Min Scale", &m_settings.min_scale, 0.1, 1.0);
+    ImGui::SliderFloat("Max Scale", &m_settings.max_scale, 0.1, 1.0);
+    ImGui::Text("CPU: %.2f ms, GPU: %.2f ms", m_cpu_time, m_gpu_time);
+    ImGui::Text("Scale: %.2f", m_scale);
+}
+
+}  // namespace SD
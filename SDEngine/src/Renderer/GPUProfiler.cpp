@@ -0,0 +1,152 @@
+#include "Renderer/GPUProfiler.hpp"
+#include "Graphics/TimerQuery.hpp"
+#include "Utility/Exception.hpp"
+#include "ImGui/ImGuiWidget.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace SD {
+
+// Frames in flight, a frame is read back FRAME_COUNT frames after it ends.
+static const int32_t FRAME_COUNT = 4;
+
+struct GPUProfilerFrame {
+    // The scope i is timed by the query i, the queries are kept for the
+    // next frames using the slot.
+    std::vector<GPUProfiler::Scope> scopes;
+    std::vector<Ref<TimerQuery>> queries;
+    bool pending{false};
+};
+
+struct GPUProfilerData {
+    bool enabled{true};
+    bool in_frame{false};
+    std::array<GPUProfilerFrame, FRAME_COUNT> frames;
+    int32_t frame_index{0};
+    // Scopes begun and not ended yet.
+    std::vector<size_t> stack;
+
+    std::vector<GPUProfiler::Scope> results;
+    uint64_t dropped_frames{0};
+};
+
+static GPUProfilerData s_data;
+
+static bool IsReady(const GPUProfilerFrame &frame)
+{
+    for (size_t i = 0; i < frame.scopes.size(); ++i) {
+        if (!frame.queries[i]->IsReady()) return false;
+    }
+    return true;
+}
+
+void GPUProfiler::BeginFrame()
+{
+    if (!s_data.enabled) return;
+
+    GPUProfilerFrame &frame = s_data.frames[s_data.frame_index];
+    if (frame.pending) {
+        if (IsReady(frame)) {
+            for (size_t i = 0; i < frame.scopes.size(); ++i) {
+                frame.scopes[i].time = frame.queries[i]->GetElapsedMS();
+            }
+            std::swap(s_data.results, frame.scopes);
+        }
+        else {
+            ++s_data.dropped_frames;
+        }
+        frame.pending = false;
+    }
+    frame.scopes.clear();
+    s_data.stack.clear();
+    s_data.in_frame = true;
+    BeginScope("Frame");
+}
+
+void GPUProfiler::EndFrame()
+{
+    if (!s_data.in_frame) return;
+
+    EndScope();
+    SD_CORE_ASSERT(s_data.stack.empty(),
+                   "GPUProfiler: BeginScope/EndScope not pair!");
+    s_data.frames[s_data.frame_index].pending = true;
+    s_data.frame_index = (s_data.frame_index + 1) % FRAME_COUNT;
+    s_data.in_frame = false;
+}
+
+void GPUProfiler::BeginScope(const std::string &name)
+{
+    if (!s_data.in_frame) return;
+
+    GPUProfilerFrame &frame = s_data.frames[s_data.frame_index];
+    const size_t index = frame.scopes.size();
+    if (index == frame.queries.size()) {
+        frame.queries.push_back(TimerQuery::Create());
+    }
+    frame.queries[index]->Begin();
+    const int32_t depth = s_data.stack.size();
+    frame.scopes.push_back({name, depth, 0});
+    s_data.stack.push_back(index);
+}
+
+void GPUProfiler::EndScope()
+{
+    if (!s_data.in_frame) return;
+
+    SD_CORE_ASSERT(!s_data.stack.empty(), "GPUProfiler: no scope to end!");
+    GPUProfilerFrame &frame = s_data.frames[s_data.frame_index];
+    frame.queries[s_data.stack.back()]->End();
+    s_data.stack.pop_back();
+}
+
+void GPUProfiler::SetEnabled(bool enabled) { s_data.enabled = enabled; }
+
+bool GPUProfiler::IsEnabled() { return s_data.enabled; }
+
+const std::vector<GPUProfiler::Scope> &GPUProfiler::GetResults()
+{
+    return s_data.results;
+}
+
+void GPUProfiler::Export(const std::string &path)
+{
+    std::ofstream file;
+    file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    try {
+        file.open(path);
+    }
+    catch (std::ofstream::failure &e) {
+        throw FileException(path, std::strerror(errno));
+    }
+    file << "depth,name,ms\n";
+    for (const Scope &scope : s_data.results) {
+        file << scope.depth << ',' << scope.name << ',' << scope.time << '\n';
+    }
+}
+
+void GPUProfiler::ImGui()
+{
+    ImGui::Checkbox("Enabled", &s_data.enabled);
+    ImGui::SameLine();
+    if (ImGui::Button("Export")) {
+        const std::string path = "gpu_profile.csv";
+        try {
+            Export(path);
+            SD_CORE_INFO("GPU profile exported to {}", path);
+        }
+        catch (const Exception &e) {
+            SD_CORE_ERROR("{}", e.what());
+        }
+    }
+    ImGui::Text("Dropped frames: %llu",
+                static_cast<unsigned long long>(s_data.dropped_frames));
+    for (const Scope &scope : s_data.results) {
+        ImGui::Text("%*s%s: %.3f ms", scope.depth * 2, "", scope.name.c_str(),
+                    scope.time);
+    }
+}
+
+}  // namespace SD
@@ -1,21 +1,35 @@
 #include "Renderer/PostProcessRenderPass.hpp"
 #include "Renderer/Renderer.hpp"
+#include "Renderer/GPUProfiler.hpp"
 #include "ImGui/ImGuiWidget.hpp"
 
 namespace SD {
 
 struct PostProcessData {
     Device *device;
+    // Region drawn to at the bottom left of the textures.
+    int32_t viewport_width;
+    int32_t viewport_height;
     ShaderHandle hdr_shader;
     ShaderHandle bloom_shader;
+    ShaderHandle bloom_downsample_shader;
 
     Ref<Framebuffer> post_target;
-    Ref<Texture> post_buffer;
 
-    Ref<Texture> upsample_buffer;
-    Ref<Texture> downsample_buffer;
+    RenderGraph::Resource post;
+    RenderGraph::Resource downsample;
+    RenderGraph::Resource upsample;
+
+    // Looked up from the graph when the passes run.
+    Texture *post_buffer;
+    Texture *upsample_buffer;
+    Texture *downsample_buffer;
 };
 
+// Mip levels of the bloom downsample chain, at most the levels the single
+// pass downsampler builds from a 64x64 tile.
+static const int32_t BLOOM_LEVELS = 7;
+
 static PostProcessData s_data;
 static PostProcessSettings s_settings;
 
@@ -24,45 +38,32 @@ void PostProcessRenderPass::Init(PostProcessSettings settings, Device *device,
 {
     s_settings = std::move(settings);
     s_data.device = device;
+    s_data.viewport_width = s_settings.width;
+    s_data.viewport_height = s_settings.height;
 
     s_data.hdr_shader =
         shaders.Load("shader/hdr", "assets/shaders/quad.vert.glsl",
                      "assets/shaders/hdr.frag.glsl");
     s_data.bloom_shader =
         shaders.Load("shader/bloom", "assets/shaders/bloom.comp.glsl");
+    s_data.bloom_downsample_shader =
+        shaders.Load("shader/bloom_downsample",
+                     "assets/shaders/bloom_downsample.comp.glsl");
 
     s_data.post_target = Framebuffer::Create();
-    InitBuffers();
 }
 
 void PostProcessRenderPass::SetRenderSize(int32_t width, int32_t height)
 {
     s_settings.width = width;
     s_settings.height = height;
-    InitBuffers();
+    SetViewportSize(width, height);
 }
 
-void PostProcessRenderPass::InitBuffers()
+void PostProcessRenderPass::SetViewportSize(int32_t width, int32_t height)
 {
-    s_data.post_buffer = Texture::Create(
-        s_settings.width, s_settings.height, 1, MultiSampleLevel::None,
-        TextureType::Normal2D, DataFormat::RGBA16F,
-        {TextureWrap::Edge, TextureMinFilter::Nearest,
-         TextureMagFilter::Nearest, MipmapMode::Linear});
-    s_data.post_target->Attach(*s_data.post_buffer, 0, 0);
-
-    s_data.downsample_buffer = Texture::Create(
-        s_settings.width, s_settings.height, 1, MultiSampleLevel::None,
-        TextureType::Normal2D, DataFormat::RGBA16F,
-        {TextureWrap::Edge, TextureMinFilter::Linear, TextureMagFilter::Linear,
-         MipmapMode::Linear},
-        7);
-    s_data.upsample_buffer = Texture::Create(
-        s_settings.width, s_settings.height, 1, MultiSampleLevel::None,
-        TextureType::Normal2D, DataFormat::RGBA16F,
-        {TextureWrap::Edge, TextureMinFilter::Linear, TextureMagFilter::Linear,
-         MipmapMode::Linear},
-        s_data.downsample_buffer->GetMipmapLevels() - 1);
+    s_data.viewport_width = std::min(width, s_settings.width);
+    s_data.viewport_height = std::min(height, s_settings.height);
 }
 
 void PostProcessRenderPass::ImGui()
@@ -74,31 +75,101 @@ void PostProcessRenderPass::ImGui()
     ImGui::SliderFloat("Bloom Threshold", &s_settings.bloom_threshold, 0, 1.0);
     ImGui::SliderFloat("Bloom Soft Threshold", &s_settings.bloom_soft_threshold,
                        0.01, 1.0f);
+    ImGui::Checkbox("Single Pass Downsample",
+                    &s_settings.bloom_single_pass_downsample);
     static int base_level = 0;
     static int buffer_index = 0;
     ImGui::SliderInt("Buffer index", &buffer_index, 0, 1);
-    Texture *buffer = buffer_index == 0 ? s_data.downsample_buffer.get()
-                                        : s_data.upsample_buffer.get();
+    Texture *buffer =
+        buffer_index == 0 ? s_data.downsample_buffer : s_data.upsample_buffer;
+    if (buffer == nullptr) return;
+
     ImGui::SliderInt("Base level", &base_level, 0,
                      buffer->GetMipmapLevels() - 1);
     buffer->SetBaseLevel(base_level);
     ImGui::DrawTexture(*buffer, ImVec2(0, 1), ImVec2(1, 0));
 }
 
-void PostProcessRenderPass::Render()
+void PostProcessRenderPass::AddPasses(RenderGraph &graph,
+                                      RenderGraph::Resource color)
 {
-    Framebuffer *fb = Renderer::GetCurrentRenderPass().framebuffer;
-    s_data.device->ReadBuffer(fb, 0);
-    s_data.device->DrawBuffer(s_data.post_target.get(), 0);
-    s_data.device->BlitFramebuffer(
-        fb, 0, 0, s_settings.width, s_settings.height, s_data.post_target.get(),
-        0, 0, s_settings.width, s_settings.height,
-        BufferBitMask::ColorBufferBit, BlitFilter::Nearest);
-
-    if (s_settings.is_bloom) {
-        RenderBloom();
-    }
-    RenderPost();
+    s_data.post_buffer = nullptr;
+    s_data.downsample_buffer = nullptr;
+    s_data.upsample_buffer = nullptr;
+
+    const int32_t width = s_settings.width;
+    const int32_t height = s_settings.height;
+    graph.AddPass(
+        "PostCopy",
+        [&](RenderGraph::PassBuilder &builder) {
+            builder.Read(color);
+            s_data.post = builder.Create(
+                "Post", {width, height, MultiSampleLevel::None,
+                         DataFormat::RGBA16F,
+                         {TextureWrap::Edge, TextureMinFilter::Nearest,
+                          TextureMagFilter::Nearest, MipmapMode::Linear}});
+        },
+        [](const RenderGraph &graph) {
+            s_data.post_buffer = graph.GetTexture(s_data.post);
+            s_data.post_target->Attach(*s_data.post_buffer, 0, 0);
+            Framebuffer *fb = Renderer::GetCurrentRenderPass().framebuffer;
+            s_data.device->ReadBuffer(fb, 0);
+            s_data.device->DrawBuffer(s_data.post_target.get(), 0);
+            s_data.device->BlitFramebuffer(
+                fb, 0, 0, s_data.viewport_width, s_data.viewport_height,
+                s_data.post_target.get(), 0, 0, s_data.viewport_width,
+                s_data.viewport_height, BufferBitMask::ColorBufferBit,
+                BlitFilter::Nearest);
+        });
+
+    // Same clamp as the texture, the upsample chain is one level shorter.
+    const int32_t max_level = static_cast<int32_t>(
+        std::floor(std::log2(std::max(width, height))));
+    const int32_t levels = std::max(std::min(BLOOM_LEVELS, max_level), 2);
+    const TextureParameter bloom_params{
+        TextureWrap::Edge, TextureMinFilter::Linear, TextureMagFilter::Linear,
+        MipmapMode::Linear};
+    graph.AddPass(
+        "BloomDownsample",
+        [&](RenderGraph::PassBuilder &builder) {
+            builder.Read(s_data.post);
+            s_data.downsample = builder.Create(
+                "BloomDownsample",
+                {width, height, MultiSampleLevel::None, DataFormat::RGBA16F,
+                 bloom_params, levels});
+        },
+        [](const RenderGraph &graph) {
+            s_data.downsample_buffer = graph.GetTexture(s_data.downsample);
+            // make sure base level is readable
+            s_data.downsample_buffer->SetBaseLevel(0);
+            Downsample(*s_data.post_buffer, *s_data.downsample_buffer);
+        });
+    graph.AddPass(
+        "BloomUpsample",
+        [&](RenderGraph::PassBuilder &builder) {
+            builder.Read(s_data.downsample);
+            s_data.upsample = builder.Create(
+                "BloomUpsample",
+                {width, height, MultiSampleLevel::None, DataFormat::RGBA16F,
+                 bloom_params, levels - 1});
+        },
+        [](const RenderGraph &graph) {
+            s_data.upsample_buffer = graph.GetTexture(s_data.upsample);
+            s_data.upsample_buffer->SetBaseLevel(0);
+            Upsample(*s_data.downsample_buffer, *s_data.upsample_buffer);
+        });
+
+    graph.AddPass(
+        "ToneMap",
+        [&](RenderGraph::PassBuilder &builder) {
+            builder.Read(s_data.post);
+            // Bloom is culled when its result is not read.
+            if (s_settings.is_bloom) {
+                builder.Read(s_data.upsample);
+            }
+            builder.Write(color);
+        },
+        [](const RenderGraph &) { RenderPost(); });
 }
 
 void PostProcessRenderPass::RenderPost()
@@ -106,12 +177,13 @@ void PostProcessRenderPass::RenderPost()
     int index = 0;
     RenderSubpassInfo info{&index, 1};
     Renderer::BeginRenderSubpass(info);
+    Renderer::BindCamera(*s_data.hdr_shader);
     s_data.hdr_shader->GetParam("u_bloom")->SetAsBool(s_settings.is_bloom);
     s_data.hdr_shader->GetParam("u_upsample_buffer")
-        ->SetAsTexture(s_data.upsample_buffer.get());
+        ->SetAsTexture(s_data.upsample_buffer);
 
     s_data.hdr_shader->GetParam("u_lighting")
-        ->SetAsTexture(s_data.post_buffer.get());
+        ->SetAsTexture(s_data.post_buffer);
     s_data.hdr_shader->GetParam("u_exposure")->SetAsFloat(s_settings.exposure);
 
     s_data.hdr_shader->GetParam("u_gamma")->SetAsFloat(
@@ -122,72 +194,136 @@ void PostProcessRenderPass::RenderPost()
     Renderer::EndRenderSubpass();
 }
 
+enum BloomParam {
+    BloomDownsample,
+    BloomThreshold,
+    BloomCurve,
+    BloomInput,
+    BloomOutImage,
+    BloomInTexture,
+    BloomDownTexture,
+    BloomLevel,
+    BloomParamCount
+};
+
+static ShaderParamBlock<BloomParamCount> s_bloom_params(
+    {"u_downsample", "u_threshold", "u_curve", "u_input", "u_out_image",
+     "u_in_texture", "u_down_texture", "u_level"});
+
 void PostProcessRenderPass::Downsample(Texture &src, Texture &dst)
 {
-    s_data.bloom_shader->GetParam("u_downsample")->SetAsBool(true);
-    s_data.bloom_shader->GetParam("u_threshold")
-        ->SetAsFloat(s_settings.bloom_threshold);
+    auto &params = s_bloom_params;
+    params.Bind(*s_data.bloom_shader);
+    params[BloomDownsample]->SetAsBool(true);
+    params[BloomThreshold]->SetAsFloat(s_settings.bloom_threshold);
     const float knee =
         s_settings.bloom_threshold * s_settings.bloom_soft_threshold;
     Vector3f filter;
     filter.x = s_settings.bloom_threshold - knee;
     filter.y = 2.f * knee;
     filter.z = 0.25f / (knee + 1e-4);
-    s_data.bloom_shader->GetParam("u_curve")->SetAsVec3(&filter[0]);
-    for (int base_level = 0; base_level < dst.GetMipmapLevels(); ++base_level) {
-        if (base_level == 0) {
-            s_data.bloom_shader->GetParam("u_input")->SetAsBool(true);
-            s_data.bloom_shader->GetParam("u_out_image")
-                ->SetAsImage(&dst, 0, false, 0, Access::WriteOnly);
-
-            s_data.bloom_shader->GetParam("u_in_texture")->SetAsTexture(&src);
-        }
-        else {
-            s_data.bloom_shader->GetParam("u_input")->SetAsBool(false);
-            s_data.bloom_shader->GetParam("u_out_image")
-                ->SetAsImage(&dst, base_level, false, 0, Access::WriteOnly);
+    params[BloomCurve]->SetAsVec3(&filter[0]);
+    params[BloomInput]->SetAsBool(true);
+    params[BloomOutImage]->SetAsImage(&dst, 0, false, 0, Access::WriteOnly);
+    params[BloomInTexture]->SetAsTexture(&src);
+    {
+        GPUProfileScope scope("Level 0");
+        ComputeMipLevel(*s_data.bloom_shader, dst, 0);
+    }
 
-            s_data.bloom_shader->GetParam("u_level")->SetAsInt(base_level - 1);
-            s_data.bloom_shader->GetParam("u_in_texture")->SetAsTexture(&dst);
-        }
-        Renderer::ComputeImage(*s_data.bloom_shader, s_settings.width,
-                               s_settings.height, 1);
+    if (s_settings.bloom_single_pass_downsample) {
+        GPUProfileScope scope("Single Pass");
+        DownsampleSinglePass(dst);
+        return;
+    }
+    params[BloomInput]->SetAsBool(false);
+    params[BloomInTexture]->SetAsTexture(&dst);
+    for (int base_level = 1; base_level < dst.GetMipmapLevels(); ++base_level) {
+        GPUProfileScope scope(fmt::format("Level {}", base_level));
+        params[BloomOutImage]->SetAsImage(&dst, base_level, false, 0,
+                                          Access::WriteOnly);
+        params[BloomLevel]->SetAsInt(base_level - 1);
+        ComputeMipLevel(*s_data.bloom_shader, dst, base_level);
     }
 }
 
+enum BloomDownsampleParam {
+    BloomMip0,
+    BloomMip1,
+    BloomMip2,
+    BloomMip3,
+    BloomMip4,
+    BloomMip5,
+    BloomMip6,
+    BloomLevels,
+    BloomDownsampleParamCount
+};
+
+static ShaderParamBlock<BloomDownsampleParamCount> s_bloom_downsample_params(
+    {"u_mip0", "u_mip1", "u_mip2", "u_mip3", "u_mip4", "u_mip5", "u_mip6",
+     "u_levels"});
+
+// Levels 1 and up from level 0 with a 2x2 box filter in one dispatch of a
+// workgroup per 64x64 tile, cheaper than the 13 tap filter level by level
+// but blockier.
+void PostProcessRenderPass::DownsampleSinglePass(Texture &dst)
+{
+    auto &params = s_bloom_downsample_params;
+    params.Bind(*s_data.bloom_downsample_shader);
+    const int levels = dst.GetMipmapLevels();
+    params[BloomMip0]->SetAsImage(&dst, 0, false, 0, Access::ReadOnly);
+    for (int level = 1; level < BLOOM_LEVELS; ++level) {
+        params[BloomMip0 + level]->SetAsImage(
+            &dst, std::min(level, levels - 1), false, 0, Access::WriteOnly);
+    }
+    params[BloomLevels]->SetAsInt(levels);
+
+    s_data.device->SetShader(s_data.bloom_downsample_shader.Get());
+    s_data.device->DispatchCompute((s_data.viewport_width + 63) / 64,
+                                   (s_data.viewport_height + 63) / 64, 1);
+    s_data.device->MemoryBarrier(BarrierBit::ImageAccess);
+}
+
+// Dispatch over the texels of one mip level the viewport covers instead of
+// the full screen.
+void PostProcessRenderPass::ComputeMipLevel(const Shader &shader,
+                                            const Texture &dst, int level)
+{
+    auto texels = [level](int32_t viewport_size, int32_t size) {
+        const int32_t covered = (viewport_size + (1 << level) - 1) >> level;
+        return std::max(std::min(covered, size >> level), 1);
+    };
+    Renderer::ComputeImage(shader,
+                           texels(s_data.viewport_width, dst.GetWidth()),
+                           texels(s_data.viewport_height, dst.GetHeight()), 1);
+}
+
 void PostProcessRenderPass::Upsample(Texture &src, Texture &dst)
 {
+    auto &params = s_bloom_params;
+    params.Bind(*s_data.bloom_shader);
     const int max_level = dst.GetMipmapLevels() - 1;
-    s_data.bloom_shader->GetParam("u_downsample")->SetAsBool(false);
+    params[BloomDownsample]->SetAsBool(false);
     for (int base_level = max_level; base_level >= 0; --base_level) {
-        s_data.bloom_shader->GetParam("u_level")->SetAsInt(base_level + 1);
+        GPUProfileScope scope(fmt::format("Level {}", base_level));
+        params[BloomLevel]->SetAsInt(base_level + 1);
         if (base_level == max_level) {
-            s_data.bloom_shader->GetParam("u_input")->SetAsBool(true);
-            s_data.bloom_shader->GetParam("u_out_image")
-                ->SetAsImage(&dst, base_level, false, 0, Access::WriteOnly);
+            params[BloomInput]->SetAsBool(true);
+            params[BloomOutImage]->SetAsImage(&dst, base_level, false, 0,
+                                              Access::WriteOnly);
 
-            s_data.bloom_shader->GetParam("u_in_texture")->SetAsTexture(&src);
+            params[BloomInTexture]->SetAsTexture(&src);
         }
         else {
-            s_data.bloom_shader->GetParam("u_input")->SetAsBool(false);
-            s_data.bloom_shader->GetParam("u_out_image")
-                ->SetAsImage(&dst, base_level, false, 0, Access::WriteOnly);
+            params[BloomInput]->SetAsBool(false);
+            params[BloomOutImage]->SetAsImage(&dst, base_level, false, 0,
+                                              Access::WriteOnly);
 
-            s_data.bloom_shader->GetParam("u_down_texture")->SetAsTexture(&src);
-            s_data.bloom_shader->GetParam("u_in_texture")->SetAsTexture(&dst);
+            params[BloomDownTexture]->SetAsTexture(&src);
+            params[BloomInTexture]->SetAsTexture(&dst);
         }
-        Renderer::ComputeImage(*s_data.bloom_shader, s_settings.width,
-                               s_settings.height, 1);
+        ComputeMipLevel(*s_data.bloom_shader, dst, base_level);
     }
 }
 
-void PostProcessRenderPass::RenderBloom()
-{
-    // make sure base level is readable
-    s_data.downsample_buffer->SetBaseLevel(0);
-    s_data.upsample_buffer->SetBaseLevel(0);
-    Downsample(*s_data.post_buffer, *s_data.downsample_buffer);
-    Upsample(*s_data.downsample_buffer, *s_data.upsample_buffer);
-}
-
 }  // namespace SD
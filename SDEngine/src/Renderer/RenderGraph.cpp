@@ -0,0 +1,239 @@
+#include "Renderer/RenderGraph.hpp"
+#include "Renderer/GPUProfiler.hpp"
+#include "Utility/Profiler.hpp"
+#include "ImGui/ImGuiWidget.hpp"
+
+namespace SD {
+
+// Pooled textures unused for this many frames are released.
+static const uint64_t POOL_KEEP_FRAMES = 8;
+
+bool RenderGraphTextureDesc::operator==(
+    const RenderGraphTextureDesc &other) const
+{
+    return width == other.width && height == other.height &&
+           samples == other.samples && format == other.format &&
+           params.wrap == other.params.wrap &&
+           params.min_filter == other.params.min_filter &&
+           params.mag_filter == other.params.mag_filter &&
+           params.mipmap == other.params.mipmap &&
+           mipmap_levels == other.mipmap_levels && type == other.type;
+}
+
+static size_t GetTextureSize(const Texture &texture)
+{
+    size_t size = texture.GetDataSize() *
+                  std::max(static_cast<int>(texture.GetSamples()), 1);
+    // A mip chain adds up to a third.
+    if (texture.GetMipmapLevels() > 1) {
+        size += size / 3;
+    }
+    return size;
+}
+
+RenderGraph::Resource RenderGraph::PassBuilder::Create(
+    const std::string &name, const RenderGraphTextureDesc &desc)
+{
+    const Resource resource = m_graph.m_resources.size();
+    m_graph.m_resources.push_back({name, desc, nullptr, false, -1, -1, -1});
+    m_graph.m_passes[m_pass].creates.push_back(resource);
+    m_graph.m_passes[m_pass].writes.push_back(resource);
+    return resource;
+}
+
+RenderGraph::Resource RenderGraph::PassBuilder::Read(Resource resource)
+{
+    m_graph.m_passes[m_pass].reads.push_back(resource);
+    return resource;
+}
+
+RenderGraph::Resource RenderGraph::PassBuilder::Write(Resource resource)
+{
+    m_graph.m_passes[m_pass].writes.push_back(resource);
+    return resource;
+}
+
+void RenderGraph::Reset()
+{
+    m_resources.clear();
+    m_passes.clear();
+}
+
+RenderGraph::Resource RenderGraph::Import(const std::string &name,
+                                          Texture *texture)
+{
+    const Resource resource = m_resources.size();
+    RenderGraphTextureDesc desc{texture->GetWidth(), texture->GetHeight(),
+                                texture->GetSamples(), texture->GetFormat()};
+    m_resources.push_back({name, desc, texture, false, -1, -1, -1});
+    return resource;
+}
+
+void RenderGraph::AddPass(const std::string &name, const SetupFunc &setup,
+                          ExecuteFunc execute)
+{
+    const int32_t pass = m_passes.size();
+    m_passes.push_back({name, std::move(execute), {}, {}, {}, false});
+    PassBuilder builder(*this, pass);
+    setup(builder);
+}
+
+void RenderGraph::MarkOutput(Resource resource)
+{
+    m_resources[resource].is_output = true;
+}
+
+void RenderGraph::Compile()
+{
+    SD_PROFILE_FUNCTION();
+    ++m_frame;
+
+    // Walk the passes backwards, a pass is kept if it writes to an imported
+    // texture, an output or a resource read by a pass kept after it.
+    std::vector<bool> needed(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        needed[i] = m_resources[i].imported || m_resources[i].is_output;
+    }
+    for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass) {
+        pass->culled = true;
+        for (Resource resource : pass->writes) {
+            if (needed[resource]) {
+                pass->culled = false;
+                break;
+            }
+        }
+        if (pass->culled) continue;
+
+        for (Resource resource : pass->reads) {
+            needed[resource] = true;
+        }
+    }
+
+    // Lifetime of the transient resources over the passes kept.
+    auto touch = [this](Resource resource, int32_t pass) {
+        ResourceNode &node = m_resources[resource];
+        if (node.imported) return;
+        if (node.first_pass < 0) {
+            node.first_pass = pass;
+        }
+        node.last_pass = pass;
+    };
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        const PassNode &pass = m_passes[i];
+        if (pass.culled) continue;
+
+        for (Resource resource : pass.reads) {
+            touch(resource, i);
+        }
+        for (Resource resource : pass.writes) {
+            touch(resource, i);
+        }
+    }
+
+    for (PooledTexture &pooled : m_pool) {
+        pooled.in_use = false;
+    }
+    for (auto iter = m_pool.begin(); iter != m_pool.end();) {
+        if (m_frame - iter->last_used_frame > POOL_KEEP_FRAMES) {
+            iter = m_pool.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+
+    // A resource takes a free pooled texture before its first pass and
+    // gives it back after its last one, for the next resources to reuse.
+    // Outputs keep theirs until the next frame.
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        if (m_passes[i].culled) continue;
+
+        for (ResourceNode &node : m_resources) {
+            if (node.first_pass == static_cast<int32_t>(i)) {
+                node.physical = Acquire(node.desc);
+            }
+        }
+        for (ResourceNode &node : m_resources) {
+            if (node.last_pass == static_cast<int32_t>(i) &&
+                !node.is_output) {
+                m_pool[node.physical].in_use = false;
+            }
+        }
+    }
+}
+
+int32_t RenderGraph::Acquire(const RenderGraphTextureDesc &desc)
+{
+    int32_t index = -1;
+    for (size_t i = 0; i < m_pool.size(); ++i) {
+        if (!m_pool[i].in_use && m_pool[i].desc == desc) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        index = m_pool.size();
+        m_pool.push_back(
+            {desc,
+             Texture::Create(desc.width, desc.height, 1, desc.samples,
+                             desc.type, desc.format, desc.params,
+                             desc.mipmap_levels),
+             false, 0});
+    }
+    m_pool[index].in_use = true;
+    m_pool[index].last_used_frame = m_frame;
+    return index;
+}
+
+void RenderGraph::Execute()
+{
+    for (PassNode &pass : m_passes) {
+        if (pass.culled) continue;
+
+        SD_PROFILE_SCOPE(pass.name);
+        GPUProfileScope scope(pass.name);
+        pass.execute(*this);
+    }
+}
+
+Texture *RenderGraph::GetTexture(Resource resource) const
+{
+    const ResourceNode &node = m_resources[resource];
+    if (node.imported) return node.imported;
+    if (node.physical < 0) return nullptr;
+
+    return m_pool[node.physical].texture.get();
+}
+
+size_t RenderGraph::GetPoolSize() const
+{
+    size_t size = 0;
+    for (const PooledTexture &pooled : m_pool) {
+        size += GetTextureSize(*pooled.texture);
+    }
+    return size;
+}
+
+size_t RenderGraph::GetTransientSize() const
+{
+    size_t size = 0;
+    for (const ResourceNode &node : m_resources) {
+        if (node.imported == nullptr && node.physical >= 0) {
+            size += GetTextureSize(*m_pool[node.physical].texture);
+        }
+    }
+    return size;
+}
+
+void RenderGraph::ImGui()
+{
+    const float mb = 1024.f * 1024.f;
+    ImGui::Text("Pool: %zu textures, %.1f MB (%.1f MB without aliasing)",
+                m_pool.size(), GetPoolSize() / mb, GetTransientSize() / mb);
+    // The GPU time of each pass is in the GPU profiler.
+    for (const PassNode &pass : m_passes) {
+        ImGui::Text("%s%s", pass.name.c_str(), pass.culled ? ": culled" : "");
+    }
+}
+
+}  // namespace SD
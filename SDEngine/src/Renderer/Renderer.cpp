@@ -163,14 +163,32 @@ void Renderer::Submit(const Shader& shader, const VertexArray& vao,
     }
 }
 
+void Renderer::SubmitInstanced(const Shader& shader, const VertexArray& vao,
+                               MeshTopology topology, size_t count,
+                               size_t offset, size_t instance_count,
+                               size_t base_instance)
+{
+    s_device->SetShader(&shader);
+    s_device->SetVertexArray(&vao);
+    s_device->DrawElementsInstanced(topology, count, offset, instance_count,
+                                    base_instance);
+}
+
 void Renderer::SetCamera(Camera& camera)
 {
     s_data.camera = &camera;
     s_data.camera_data.view = camera.GetView();
     s_data.camera_data.projection = camera.GetProjection();
+    s_data.camera_data.inv_view_projection = glm::inverse(
+        s_data.camera_data.projection * s_data.camera_data.view);
     s_data.camera_ubo->UpdateData(&s_data.camera_data, sizeof(CameraData));
 }
 
+void Renderer::SetRenderScale(const Vector2f& scale)
+{
+    s_data.camera_data.render_scale = scale;
+}
+
 Camera* Renderer::GetCamera() { return s_data.camera; }
 
 void Renderer::BindCamera(Shader& shader)
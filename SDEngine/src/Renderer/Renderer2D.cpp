@@ -1,6 +1,7 @@
 #include "Renderer/Renderer2D.hpp"
 #include "Resource/Resource.hpp"
 #include "Utility/String.hpp"
+#include "Utility/Metrics.hpp"
 
 namespace SD {
 
@@ -57,8 +58,6 @@ struct SD_RENDERER_API Renderer2DData {
 
     Ref<VertexArray> line_vao;
     size_t line_vertex_cnt{0};
-    size_t line_draw_call{0};
-    size_t line_cnt{0};
     Ref<VertexBuffer> line_vbo;
     std::array<Line, MAX_LINES> line_buffer;
     Line* line_buffer_ptr{nullptr};
@@ -67,8 +66,6 @@ struct SD_RENDERER_API Renderer2DData {
     Ref<VertexBuffer> quad_vbo;
     Ref<IndexBuffer> quad_ibo;
     size_t quad_index_cnt{0};
-    size_t quad_cnt{0};
-    size_t quad_draw_call{0};
     std::array<Quad, MAX_QUADS> quad_buffer;
     Quad* quad_buffer_ptr = nullptr;
 
@@ -78,13 +75,16 @@ struct SD_RENDERER_API Renderer2DData {
     Ref<VertexArray> circle_vao;
     Ref<VertexBuffer> circle_vbo;
     size_t circle_index_cnt{0};
-    size_t circie_cnt{0};
-    size_t circle_draw_call{0};
     std::array<Circle, MAX_QUADS> circle_buffer;
     Circle* circle_buffer_ptr{nullptr};
 
     Vector2i text_origin;
     Vector2i text_cursor;
+
+    Metrics::Id batches_metric;
+    Metrics::Id lines_metric;
+    Metrics::Id quads_metric;
+    Metrics::Id circles_metric;
 };
 
 const static std::array<Vector4f, 4> QUAD_VERTEX_POS = {
@@ -190,6 +190,11 @@ void Renderer2D::Init(ShaderCache &shaders)
     Renderer::BindCamera(*s_line_shader);
     Renderer::BindCamera(*s_cirlce_shader);
     Renderer::BindCamera(*s_texture_shader);
+
+    s_2d_data.batches_metric = Metrics::RegisterCounter("renderer2d.batches");
+    s_2d_data.lines_metric = Metrics::RegisterCounter("renderer2d.lines");
+    s_2d_data.quads_metric = Metrics::RegisterCounter("renderer2d.quads");
+    s_2d_data.circles_metric = Metrics::RegisterCounter("renderer2d.circles");
 }
 
 void Renderer2D::Begin() {}
@@ -200,29 +205,6 @@ void Renderer2D::End()
     StartBatch();
 }
 
-void Renderer2D::Reset()
-{
-    s_2d_data.line_cnt = 0;
-    s_2d_data.line_draw_call = 0;
-
-    s_2d_data.quad_cnt = 0;
-    s_2d_data.quad_draw_call = 0;
-
-    s_2d_data.circie_cnt = 0;
-    s_2d_data.circle_draw_call = 0;
-}
-
-std::string Renderer2D::GetDebugInfo()
-{
-    return fmt::format(
-        "Line: total draw counts:{}, total draw calls:{}.\n"
-        "Quad: total draw counts:{}, total draw calls:{}.\n"
-        "Cirlce: total draw counts:{}, total draw calls:{}.\n",
-        s_2d_data.line_cnt, s_2d_data.line_draw_call, s_2d_data.quad_cnt,
-        s_2d_data.quad_draw_call, s_2d_data.circie_cnt,
-        s_2d_data.circle_draw_call);
-}
-
 void Renderer2D::StartBatch()
 {
     // Reset text
@@ -285,8 +267,8 @@ void Renderer2D::FlushLines()
                                        sizeof(Line) * offset);
         Submit(*s_line_shader, *s_2d_data.line_vao, MeshTopology::Lines,
                s_2d_data.line_vertex_cnt, 0, false);
-        s_2d_data.line_cnt += offset;
-        ++s_2d_data.line_draw_call;
+        Metrics::Add(s_2d_data.lines_metric, offset);
+        Metrics::Add(s_2d_data.batches_metric);
     }
 }
 
@@ -298,14 +280,15 @@ void Renderer2D::FlushQuads()
         s_2d_data.quad_vbo->UpdateData(s_2d_data.quad_buffer.data(),
                                        offset * sizeof(Quad));
 
-        s_texture_shader->GetParam("u_textures[0]")
+        static constexpr UniformId u_textures("u_textures[0]");
+        s_texture_shader->GetParam(u_textures)
             ->SetAsTextures(s_2d_data.texture_slots.data(),
                             s_2d_data.texture_index);
 
         Submit(*s_texture_shader, *s_2d_data.quad_vao, MeshTopology::Triangles,
                s_2d_data.quad_index_cnt, 0);
-        s_2d_data.quad_cnt += offset;
-        ++s_2d_data.quad_draw_call;
+        Metrics::Add(s_2d_data.quads_metric, offset);
+        Metrics::Add(s_2d_data.batches_metric);
     }
 }
 
@@ -320,8 +303,8 @@ void Renderer2D::FlushCircles()
 
         Submit(*s_cirlce_shader, *s_2d_data.circle_vao, MeshTopology::Triangles,
                s_2d_data.circle_index_cnt, 0);
-        s_2d_data.circie_cnt += offset;
-        ++s_2d_data.circle_draw_call;
+        Metrics::Add(s_2d_data.circles_metric, offset);
+        Metrics::Add(s_2d_data.batches_metric);
     }
 }
 
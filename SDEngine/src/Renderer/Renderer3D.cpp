@@ -1,14 +1,93 @@
 #include "Renderer/Renderer3D.hpp"
+#include "Utility/Metrics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
 
 namespace SD {
 
+static const uint32_t NO_MATERIAL = std::numeric_limits<uint32_t>::max();
+
+// Draw sort key, from the most significant bits:
+// | material page (8) | texture set (16) | mesh (16) | depth (24) |
+// Each queue is drawn with a single shader within one pass, so neither needs
+// bits of its own.
+static const uint32_t DEPTH_BITS = 24;
+static const uint32_t MESH_BITS = 16;
+static const uint32_t TEXTURE_SET_BITS = 16;
+static const uint32_t PAGE_BITS = 8;
+static const uint32_t MESH_SHIFT = DEPTH_BITS;
+static const uint32_t TEXTURE_SET_SHIFT = MESH_SHIFT + MESH_BITS;
+static const uint32_t PAGE_SHIFT = TEXTURE_SET_SHIFT + TEXTURE_SET_BITS;
+
+struct MeshBatchItem {
+    uint64_t key;
+    uint32_t instance_id;
+};
+
+static uint32_t GetKeyField(uint64_t key, uint32_t shift, uint32_t bits)
+{
+    return (key >> shift) & ((1ull << bits) - 1);
+}
+
+// Hash of the values of an array, for the batch lookups by value.
+struct ArrayHash {
+    template <typename T, size_t N>
+    size_t operator()(const std::array<T, N> &array) const
+    {
+        size_t seed = 0;
+        for (const T &value : array) {
+            seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) +
+                    (seed >> 2);
+        }
+        return seed;
+    }
+};
+
+// Diffuse, ambient and emissive colors of a material.
+using MaterialColors = std::array<float, 9>;
+
 struct Renderer3DData {
     Ref<UniformBuffer> shadow_UBO;
+    Ref<UniformBuffer> material_UBO;
     Ref<VertexArray> mesh_vao;
+    Ref<VertexBuffer> instance_VBO;
     Ref<Texture> default_texture;
 
-    size_t mesh_draw_calls{0};
-    size_t mesh_vertex_cnt{0};
+    // Unique material colors and texture sets of the batch, with their ids.
+    std::vector<MaterialData> batch_materials;
+    std::unordered_map<MaterialColors, uint32_t, ArrayHash> batch_material_ids;
+    std::vector<const Material::TextureArray *> batch_texture_sets;
+    std::unordered_map<Material::TextureArray, uint32_t, ArrayHash>
+        batch_texture_set_ids;
+    // Content of the material buffer, to skip unchanged uploads.
+    std::vector<MaterialData> uploaded_materials;
+    std::vector<const Mesh *> batch_meshes;
+    std::unordered_map<const Mesh *, uint32_t> batch_mesh_ids;
+    std::vector<MeshBatchItem> batch_items;
+    std::vector<MeshBatchItem> sort_buffer;
+    bool batch_depth_sort{false};
+    Vector3f batch_eye{0};
+    std::vector<InstanceData> batch_instances;
+    std::vector<InstanceData> sorted_instances;
+    // Whether the queue is sorted and uploaded, at batch_base instances in
+    // the instance buffer.
+    bool batch_uploaded{false};
+    size_t batch_base{0};
+    // Instances the buffer holds, and where the next queue goes. Queues of
+    // a frame are appended so that none overwrites the instances of a draw
+    // still in flight.
+    size_t instance_capacity{1024};
+    size_t instance_offset{0};
+
+    Metrics::Id batches_metric;
+    Metrics::Id instances_metric;
+    Metrics::Id vertices_metric;
+    Metrics::Id visible_metric;
+    Metrics::Id culled_metric;
 };
 
 static Renderer3DData s_mesh_data;
@@ -17,6 +96,9 @@ void Renderer3D::Init()
 {
     s_mesh_data.shadow_UBO = UniformBuffer::Create(nullptr, sizeof(ShadowData),
                                                    BufferIOType::Dynamic);
+    s_mesh_data.material_UBO = UniformBuffer::Create(
+        nullptr, sizeof(MaterialData) * MAX_MATERIAL_COUNT,
+        BufferIOType::Dynamic);
     s_mesh_data.mesh_vao = VertexArray::Create();
     VertexBufferLayout layout;
     layout.Push(BufferLayoutType::Float3);
@@ -26,6 +108,17 @@ void Renderer3D::Init()
     layout.Push(BufferLayoutType::Float3);
     s_mesh_data.mesh_vao->AddBufferLayout(layout);
 
+    VertexBufferLayout instance_layout(1);
+    instance_layout.Push(BufferLayoutType::Mat4);
+    instance_layout.Push(BufferLayoutType::UInt);
+    instance_layout.Push(BufferLayoutType::UInt);
+    instance_layout.Push(BufferLayoutType::UInt);
+    s_mesh_data.mesh_vao->AddBufferLayout(instance_layout);
+    s_mesh_data.instance_VBO = VertexBuffer::Create(
+        nullptr, sizeof(InstanceData) * s_mesh_data.instance_capacity,
+        BufferIOType::Dynamic);
+    s_mesh_data.mesh_vao->BindVertexBuffer(*s_mesh_data.instance_VBO, 1);
+
     s_mesh_data.default_texture =
         Texture::Create(1, 1, 1, MultiSampleLevel::None, TextureType::Normal2D,
                         DataFormat::RGB8,
@@ -33,55 +126,291 @@ void Renderer3D::Init()
                          TextureMagFilter::Linear, MipmapMode::None});
     const uint8_t color[3] = {0xff, 0xff, 0xff};
     s_mesh_data.default_texture->SetPixels(0, 0, 0, 1, 1, 1, color);
+
+    s_mesh_data.batches_metric = Metrics::RegisterCounter("renderer3d.batches");
+    s_mesh_data.instances_metric =
+        Metrics::RegisterCounter("renderer3d.instances");
+    s_mesh_data.vertices_metric =
+        Metrics::RegisterCounter("renderer3d.vertices");
+    s_mesh_data.visible_metric = Metrics::RegisterCounter("renderer3d.visible");
+    s_mesh_data.culled_metric = Metrics::RegisterCounter("renderer3d.culled");
 }
 
-void Renderer3D::Reset()
+bool Renderer3D::IsVisible(const Math::Frustum &frustum, const Mesh &mesh,
+                           const Matrix4f &transform)
 {
-    s_mesh_data.mesh_draw_calls = 0;
-    s_mesh_data.mesh_vertex_cnt = 0;
+    bool visible = true;
+    const Math::BoundingSphere &sphere = mesh.GetBoundingSphere();
+    if (sphere.IsValid()) {
+        visible = frustum.Intersects(sphere.Transform(transform));
+    }
+    // The sphere is cheap but loose, refine with the box.
+    const Math::AABB &aabb = mesh.GetBoundingBox();
+    if (visible && aabb.IsValid()) {
+        visible = frustum.Intersects(aabb.Transform(transform));
+    }
+
+    Metrics::Add(visible ? s_mesh_data.visible_metric
+                         : s_mesh_data.culled_metric);
+    return visible;
 }
 
-std::string Renderer3D::GetDebugInfo()
+void Renderer3D::BeginInstances()
 {
-    return fmt::format("Mesh: total draw calls:{}, total vertex counts:{}.\n",
-                       s_mesh_data.mesh_draw_calls,
-                       s_mesh_data.mesh_vertex_cnt);
+    s_mesh_data.batch_materials.clear();
+    s_mesh_data.batch_material_ids.clear();
+    s_mesh_data.batch_texture_sets.clear();
+    s_mesh_data.batch_texture_set_ids.clear();
+    s_mesh_data.batch_meshes.clear();
+    s_mesh_data.batch_mesh_ids.clear();
+    s_mesh_data.batch_items.clear();
+    s_mesh_data.batch_instances.clear();
+    s_mesh_data.batch_depth_sort = false;
+    s_mesh_data.batch_uploaded = false;
 }
 
-void Renderer3D::DrawMesh(const Shader& shader, const Mesh& mesh)
+void Renderer3D::BeginInstances(const Vector3f &eye)
 {
-    s_device->SetPolygonMode(mesh.GetPolygonMode(), Face::Both);
-    s_mesh_data.mesh_vao->BindVertexBuffer(*mesh.GetVertexBuffer(), 0);
-    s_mesh_data.mesh_vao->BindIndexBuffer(*mesh.GetIndexBuffer());
-    Submit(shader, *s_mesh_data.mesh_vao, mesh.GetTopology(),
-           mesh.GetIndexBuffer()->GetCount(), 0);
+    BeginInstances();
+    s_mesh_data.batch_depth_sort = true;
+    s_mesh_data.batch_eye = eye;
+}
 
-    ++s_mesh_data.mesh_draw_calls;
-    s_mesh_data.mesh_vertex_cnt += mesh.GetVertices().size();
+static uint32_t GetMaterialId(const Material &material)
+{
+    const Vector3f &diffuse = material.GetDiffuseColor();
+    const Vector3f &ambient = material.GetAmbientColor();
+    const Vector3f &emissive = material.GetEmissiveColor();
+    const MaterialColors colors = {diffuse.x,  diffuse.y,  diffuse.z,
+                                   ambient.x,  ambient.y,  ambient.z,
+                                   emissive.x, emissive.y, emissive.z};
+    auto [iter, inserted] = s_mesh_data.batch_material_ids.try_emplace(
+        colors, s_mesh_data.batch_materials.size());
+    if (inserted) {
+        s_mesh_data.batch_materials.push_back({Vector4f(diffuse, 1.f),
+                                               Vector4f(ambient, 1.f),
+                                               Vector4f(emissive, 1.f)});
+    }
+    return iter->second;
 }
 
-void Renderer3D::SetMaterial(Shader& shader, const Material& material)
+static uint32_t GetTextureSetId(const Material::TextureArray &textures)
 {
-    const Texture* diffuse = material.GetTexture(MaterialType::Diffuse);
-    const Texture* ambient = material.GetTexture(MaterialType::Ambient);
-    const Texture* emissive = material.GetTexture(MaterialType::Emissive);
-    const Texture* default_texture = s_mesh_data.default_texture.get();
-    shader.GetParam("u_material.diffuse")
-        ->SetAsTexture(diffuse ? diffuse : default_texture);
-    shader.GetParam("u_material.ambient")
-        ->SetAsTexture(ambient ? ambient : default_texture);
-    shader.GetParam("u_material.specular")
-        ->SetAsTexture(material.GetTexture(MaterialType::Specular));
-    shader.GetParam("u_material.emissive")->SetAsTexture(emissive);
-    shader.GetParam("u_material.normal")
-        ->SetAsTexture(material.GetTexture(MaterialType::Normal));
-    // base color
-    shader.GetParam("u_material.ambient_color")
-        ->SetAsVec3(&material.GetAmbientColor()[0]);
-    shader.GetParam("u_material.diffuse_color")
-        ->SetAsVec3(&material.GetDiffuseColor()[0]);
-    shader.GetParam("u_material.emissive_color")
-        ->SetAsVec3(&material.GetEmissiveColor()[0]);
+    auto [iter, inserted] = s_mesh_data.batch_texture_set_ids.try_emplace(
+        textures, s_mesh_data.batch_texture_sets.size());
+    if (inserted) {
+        s_mesh_data.batch_texture_sets.push_back(&textures);
+    }
+    return iter->second;
+}
+
+void Renderer3D::AddInstance(const Mesh &mesh, const Material *material,
+                             const InstanceData &instance)
+{
+    // Materials are stored by value in the components, so they are looked
+    // up by value: equal colors share a material buffer entry and equal
+    // textures a texture set for this batch.
+    uint32_t material_id = 0;
+    // Untextured instances sort last.
+    uint32_t texture_set = (1u << TEXTURE_SET_BITS) - 1;
+    if (material) {
+        material_id = GetMaterialId(*material);
+        texture_set = GetTextureSetId(material->GetTextures());
+    }
+    auto [mesh_iter, inserted] = s_mesh_data.batch_mesh_ids.try_emplace(
+        &mesh, s_mesh_data.batch_meshes.size());
+    if (inserted) {
+        s_mesh_data.batch_meshes.push_back(&mesh);
+    }
+    const uint32_t mesh_id = mesh_iter->second;
+    const uint32_t page = material_id / MAX_MATERIAL_COUNT;
+    SD_CORE_ASSERT(page < (1u << PAGE_BITS) &&
+                       texture_set < (1u << TEXTURE_SET_BITS) &&
+                       mesh_id < (1u << MESH_BITS),
+                   "Too many unique materials or meshes in one batch!");
+
+    // Non-negative floats keep their order when compared as integers, the
+    // low mantissa bits are dropped.
+    uint32_t depth = 0;
+    if (s_mesh_data.batch_depth_sort) {
+        Vector3f center(instance.model[3]);
+        const Math::BoundingSphere &sphere = mesh.GetBoundingSphere();
+        if (sphere.IsValid()) {
+            center = sphere.Transform(instance.model).center;
+        }
+        const float distance = glm::distance(center, s_mesh_data.batch_eye);
+        std::memcpy(&depth, &distance, sizeof(float));
+        depth >>= 32 - DEPTH_BITS;
+    }
+    const uint64_t key = static_cast<uint64_t>(page) << PAGE_SHIFT |
+                         static_cast<uint64_t>(texture_set)
+                             << TEXTURE_SET_SHIFT |
+                         static_cast<uint64_t>(mesh_id) << MESH_SHIFT | depth;
+    s_mesh_data.batch_items.push_back(
+        {key, static_cast<uint32_t>(s_mesh_data.batch_instances.size())});
+    s_mesh_data.batch_instances.push_back(instance);
+    s_mesh_data.batch_instances.back().material_index =
+        material_id % MAX_MATERIAL_COUNT;
+    s_mesh_data.batch_uploaded = false;
+}
+
+// The material buffer holds MAX_MATERIAL_COUNT materials, a batch with more
+// unique materials is drawn page by page.
+static void UploadMaterials(uint32_t page)
+{
+    const auto &materials = s_mesh_data.batch_materials;
+    const size_t first = page * MAX_MATERIAL_COUNT;
+    const size_t last =
+        std::min<size_t>(first + MAX_MATERIAL_COUNT, materials.size());
+    if (first >= last) return;
+
+    const auto begin = materials.begin() + first;
+    const auto end = materials.begin() + last;
+    auto &uploaded = s_mesh_data.uploaded_materials;
+    if (static_cast<size_t>(end - begin) <= uploaded.size() &&
+        std::equal(begin, end, uploaded.begin(),
+                   [](const MaterialData &lhs, const MaterialData &rhs) {
+                       return lhs.diffuse_color == rhs.diffuse_color &&
+                              lhs.ambient_color == rhs.ambient_color &&
+                              lhs.emissive_color == rhs.emissive_color;
+                   })) {
+        return;
+    }
+    s_mesh_data.material_UBO->UpdateData(
+        materials.data() + first, (last - first) * sizeof(MaterialData));
+    uploaded.assign(begin, end);
+}
+
+static void SetMaterialTextures(Shader &shader,
+                                const Material::TextureArray &textures)
+{
+    enum { Diffuse, Ambient, Specular, Emissive, Normal, ParamCount };
+    static ShaderParamBlock<ParamCount> params(
+        {"u_material.diffuse", "u_material.ambient", "u_material.specular",
+         "u_material.emissive", "u_material.normal"});
+    params.Bind(shader);
+
+    auto get = [&textures](MaterialType type) -> const Texture * {
+        return textures[static_cast<size_t>(type)];
+    };
+    const Texture *diffuse = get(MaterialType::Diffuse);
+    const Texture *ambient = get(MaterialType::Ambient);
+    const Texture *default_texture = s_mesh_data.default_texture.get();
+    params[Diffuse]->SetAsTexture(diffuse ? diffuse : default_texture);
+    params[Ambient]->SetAsTexture(ambient ? ambient : default_texture);
+    params[Specular]->SetAsTexture(get(MaterialType::Specular));
+    params[Emissive]->SetAsTexture(get(MaterialType::Emissive));
+    params[Normal]->SetAsTexture(get(MaterialType::Normal));
+}
+
+// LSD radix sort on 8 bit digits, stable so equal keys keep their
+// submission order. Digits that are the same for every key are skipped,
+// which is common for the page and the high depth bits.
+static void SortItems(std::vector<MeshBatchItem> &items,
+                      std::vector<MeshBatchItem> &buffer)
+{
+    buffer.resize(items.size());
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        std::array<size_t, 256> offsets{};
+        for (const auto &item : items) {
+            ++offsets[(item.key >> shift) & 0xff];
+        }
+        if (offsets[(items.front().key >> shift) & 0xff] == items.size()) {
+            continue;
+        }
+        size_t sum = 0;
+        for (auto &offset : offsets) {
+            const size_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+        for (const auto &item : items) {
+            buffer[offsets[(item.key >> shift) & 0xff]++] = item;
+        }
+        items.swap(buffer);
+    }
+}
+
+// Sort the queue and upload its instances in draw order.
+static void UploadInstances()
+{
+    auto &items = s_mesh_data.batch_items;
+    SortItems(items, s_mesh_data.sort_buffer);
+    auto &instances = s_mesh_data.sorted_instances;
+    instances.clear();
+    for (const auto &item : items) {
+        instances.push_back(s_mesh_data.batch_instances[item.instance_id]);
+    }
+
+    auto &buffer = *s_mesh_data.instance_VBO;
+    if (s_mesh_data.instance_offset + instances.size() >
+        s_mesh_data.instance_capacity) {
+        s_mesh_data.instance_offset = 0;
+        if (instances.size() > s_mesh_data.instance_capacity) {
+            s_mesh_data.instance_capacity = std::max(
+                instances.size(), s_mesh_data.instance_capacity * 2);
+            buffer.UpdateData(
+                nullptr, s_mesh_data.instance_capacity * sizeof(InstanceData));
+        }
+    }
+    s_mesh_data.batch_base = s_mesh_data.instance_offset;
+    buffer.UpdateData(instances.data(),
+                      instances.size() * sizeof(InstanceData),
+                      s_mesh_data.batch_base * sizeof(InstanceData));
+    s_mesh_data.instance_offset += instances.size();
+    s_mesh_data.batch_uploaded = true;
+}
+
+void Renderer3D::DrawInstances(Shader &shader)
+{
+    auto &items = s_mesh_data.batch_items;
+    if (items.empty()) return;
+
+    if (!s_mesh_data.batch_uploaded) {
+        UploadInstances();
+    }
+
+    VertexArray *vao = s_mesh_data.mesh_vao.get();
+    uint32_t page = NO_MATERIAL;
+    uint32_t texture_set = NO_MATERIAL;
+    size_t first = 0;
+    while (first < items.size()) {
+        // Groups share everything but the depth.
+        const uint64_t group = items[first].key >> DEPTH_BITS;
+        size_t last = first + 1;
+        while (last < items.size() && items[last].key >> DEPTH_BITS == group) {
+            ++last;
+        }
+        const size_t count = last - first;
+        const uint64_t key = items[first].key;
+        const Mesh &mesh = *s_mesh_data.batch_meshes[GetKeyField(
+            key, MESH_SHIFT, MESH_BITS)];
+        const uint32_t item_page = GetKeyField(key, PAGE_SHIFT, PAGE_BITS);
+        if (item_page != page) {
+            page = item_page;
+            UploadMaterials(page);
+        }
+        const uint32_t item_texture_set =
+            GetKeyField(key, TEXTURE_SET_SHIFT, TEXTURE_SET_BITS);
+        if (item_texture_set != texture_set &&
+            item_texture_set < s_mesh_data.batch_texture_sets.size()) {
+            texture_set = item_texture_set;
+            SetMaterialTextures(
+                shader, *s_mesh_data.batch_texture_sets[texture_set]);
+        }
+        s_device->SetPolygonMode(mesh.GetPolygonMode(), Face::Both);
+        vao->BindVertexBuffer(*mesh.GetVertexBuffer(), 0);
+        vao->BindIndexBuffer(*mesh.GetIndexBuffer());
+        SubmitInstanced(shader, *vao, mesh.GetTopology(),
+                        mesh.GetIndexBuffer()->GetCount(), 0, count,
+                        s_mesh_data.batch_base + first);
+
+        Metrics::Add(s_mesh_data.batches_metric);
+        Metrics::Add(s_mesh_data.instances_metric, count);
+        Metrics::Add(s_mesh_data.vertices_metric,
+                     mesh.GetVertices().size() * count);
+        first = last;
+    }
 }
 
 void Renderer3D::SetCascadeShadow(const CascadeShadow& shadow)
@@ -95,4 +424,9 @@ void Renderer3D::BindCascadeShadow(Shader& shader)
     shader.SetUniformBuffer("ShadowData", *s_mesh_data.shadow_UBO);
 }
 
+void Renderer3D::BindMaterials(Shader& shader)
+{
+    shader.SetUniformBuffer("MaterialData", *s_mesh_data.material_UBO);
+}
+
 }  // namespace SD
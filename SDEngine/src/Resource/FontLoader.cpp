@@ -1,4 +1,5 @@
 #include "Resource/FontLoader.hpp"
+#include "Utility/Profiler.hpp"
 #include "Graphics/Image.hpp"
 #include "Utility/Math.hpp"
 
@@ -39,6 +40,7 @@ FontLoader::~FontLoader() { FT_Done_FreeType(m_library); }
 
 Ref<Font> FontLoader::Load(const std::string &path, int32_t pixel_height)
 {
+    SD_PROFILE_FUNCTION();
     FT_Face face;
     Ref<Font> font;
     SD_CORE_TRACE("Loading font form: {}...", path);
@@ -1,4 +1,5 @@
 #include "Resource/ImageLoader.hpp"
+#include "Utility/Profiler.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -8,6 +9,7 @@ namespace SD {
 
 Ref<ByteImage> ImageLoader::Load(const std::string_view& path)
 {
+    SD_PROFILE_FUNCTION();
     SD_CORE_TRACE("Loading image from: {}", path);
     int32_t width;
     int32_t height;
@@ -20,6 +22,7 @@ Ref<ByteImage> ImageLoader::Load(const std::string_view& path)
 
 Ref<ByteImage> ImageLoader::Load(const uint8_t* data, int32_t size)
 {
+    SD_PROFILE_FUNCTION();
     int32_t width;
     int32_t height;
     int32_t channels;
@@ -1,4 +1,5 @@
 #include "Resource/ModelLoader.hpp"
+#include "Utility/Profiler.hpp"
 #include "Resource/Resource.hpp"
 #include "Utility/Math.hpp"
 
@@ -98,9 +99,27 @@ static void ProcessAiMesh(const aiMesh *assimpMesh, Model &model)
             indices.push_back(face.mIndices[j]);
         }
     }
-    model.AddMesh(Mesh(vertices, indices,
-                       ConvertAssimpPrimitive(static_cast<aiPrimitiveType>(
-                           assimpMesh->mPrimitiveTypes))));
+    Mesh mesh(vertices, indices,
+              ConvertAssimpPrimitive(
+                  static_cast<aiPrimitiveType>(assimpMesh->mPrimitiveTypes)));
+
+    Math::AABB aabb;
+    for (const auto &vertex : vertices) {
+        aabb.Merge(vertex.position);
+    }
+    if (aabb.IsValid()) {
+        // Centered on the box, tighter than its half diagonal.
+        const Vector3f center = aabb.GetCenter();
+        float radius2 = 0;
+        for (const auto &vertex : vertices) {
+            const Vector3f offset = vertex.position - center;
+            radius2 = std::max(radius2, glm::dot(offset, offset));
+        }
+        mesh.SetBoundingBox(aabb);
+        mesh.SetBoundingSphere(
+            Math::BoundingSphere(center, std::sqrt(radius2)));
+    }
+    model.AddMesh(std::move(mesh));
 }
 
 static inline TextureWrap ConvertAssimpMapMode(aiTextureMapMode mode)
@@ -213,6 +232,7 @@ static void ProcessNode(const aiScene *scene, const aiNode *ai_node,
 
 Ref<Model> ModelLoader::Load(const std::string_view &path)
 {
+    SD_PROFILE_FUNCTION();
     Ref<Model> model;
     SD_CORE_TRACE("Loading model form: {}...", path);
 
@@ -1,4 +1,5 @@
 #include "Resource/ShaderLoader.hpp"
+#include "Utility/Profiler.hpp"
 #include "Graphics/Shader.hpp"
 #include "Utility/File.hpp"
 
@@ -39,6 +40,7 @@ static void ParseShaderCode(const std::string& path, std::string& code)
 
 Ref<Shader> ShaderLoader::Load(const std::string& comp_path)
 {
+    SD_PROFILE_FUNCTION();
     Ref<Shader> shader = Shader::Create();
     std::string comp_code;
     if (!comp_path.empty()) {
@@ -52,6 +54,7 @@ Ref<Shader> ShaderLoader::Load(const std::string& comp_path)
 Ref<Shader> ShaderLoader::Load(const std::string& vert_path,
                                const std::string& frag_path)
 {
+    SD_PROFILE_FUNCTION();
     Ref<Shader> shader = Shader::Create();
     std::string vert_code;
     std::string frag_code;
@@ -70,6 +73,7 @@ Ref<Shader> ShaderLoader::Load(const std::string& vert_path,
                                const std::string& frag_path,
                                const std::string& geo_path)
 {
+    SD_PROFILE_FUNCTION();
     Ref<Shader> shader = Shader::Create();
     std::string vert_code;
     std::string frag_code;
@@ -1,4 +1,5 @@
 #include "Resource/TextureLoader.hpp"
+#include "Utility/Profiler.hpp"
 #include "Graphics/Texture.hpp"
 #include "Resource/ImageLoader.hpp"
 
@@ -9,6 +10,7 @@ namespace SD {
 Ref<Texture> TextureLoader::Load(const std::string &path,
                                  const TextureParameter &param)
 {
+    SD_PROFILE_FUNCTION();
     ImageLoader loader;
     auto img = loader.Load(path);
     Ref<Texture> texture =
@@ -20,6 +22,7 @@ Ref<Texture> TextureLoader::Load(const std::string &path,
 
 Ref<Texture> TextureLoader::Load(const std::array<std::string_view, 6> &pathes)
 {
+    SD_PROFILE_FUNCTION();
     Ref<Texture> texture;
     TextureParameter param{TextureWrap::Edge, TextureMinFilter::Linear,
                            TextureMagFilter::Linear, MipmapMode::None};
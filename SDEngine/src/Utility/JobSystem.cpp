@@ -0,0 +1,315 @@
+#include "Utility/JobSystem.hpp"
+#include "Utility/Profiler.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SD {
+
+// Chase-Lev deque of a fixed capacity, with the memory orders of Lê et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models". Only the
+// owner pushes and pops, at the bottom; any thread steals from the top.
+class JobQueue {
+   public:
+    static const int64_t CAPACITY = 4096;
+
+    bool Push(Job *job)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= CAPACITY) return false;
+
+        // Release and acquire on the slot too, the fences alone do not
+        // publish the job to thread sanitizers.
+        m_jobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job *Pop()
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job *job =
+            m_jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // The last job, race the thieves for it.
+            if (!m_top.compare_exchange_strong(top, top + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job *Steal()
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) return nullptr;
+
+        Job *job = m_jobs[top & (CAPACITY - 1)].load(std::memory_order_acquire);
+        if (!m_top.compare_exchange_strong(top, top + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+   private:
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    std::atomic<Job *> m_jobs[CAPACITY];
+};
+
+// Failed searches for a job before an idle worker sleeps.
+static const uint32_t IDLE_SPINS = 64;
+
+struct JobSystemData {
+    std::vector<std::unique_ptr<JobQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running{false};
+    std::atomic<int32_t> sleeping{0};
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+static JobSystemData s_data;
+
+// Deque of the thread, -1 if it has none.
+static thread_local int32_t s_thread_index = -1;
+
+// Jobs of a thread, only that thread allocates from it. A job is reused
+// once it is finished and no thread waits on it; when a whole lap finds
+// none, a block is added so a job alive is never handed out again.
+class JobPool {
+   public:
+    static const uint32_t BLOCK_SIZE = JobSystem::JOB_POOL_SIZE;
+
+    JobPool() { m_blocks.emplace_back(new Job[BLOCK_SIZE]); }
+
+    Job *Acquire()
+    {
+        const uint32_t capacity = m_blocks.size() * BLOCK_SIZE;
+        for (uint32_t i = 0; i < capacity; ++i) {
+            Job *job = &m_blocks[m_next / BLOCK_SIZE][m_next % BLOCK_SIZE];
+            m_next = (m_next + 1) % capacity;
+            if (job->unfinished.load(std::memory_order_acquire) == 0 &&
+                job->waiters.load(std::memory_order_acquire) == 0) {
+                return job;
+            }
+        }
+        SD_CORE_WARN("Job pool of a thread grown to {} jobs.",
+                     capacity + BLOCK_SIZE);
+        m_blocks.emplace_back(new Job[BLOCK_SIZE]);
+        m_next = capacity + 1;
+        return &m_blocks.back()[0];
+    }
+
+   private:
+    std::vector<std::unique_ptr<Job[]>> m_blocks;
+    uint32_t m_next{0};
+};
+
+static Job *GetJob()
+{
+    const int32_t count = s_data.queues.size();
+    if (count == 0) return nullptr;
+
+    if (s_thread_index >= 0) {
+        if (Job *job = s_data.queues[s_thread_index]->Pop()) return job;
+    }
+    // Start from a different victim on each attempt.
+    thread_local uint32_t seed =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    for (int32_t i = 0; i < count; ++i) {
+        const int32_t victim = (seed + i) % count;
+        if (victim == s_thread_index) continue;
+
+        if (Job *job = s_data.queues[victim]->Steal()) return job;
+    }
+    return nullptr;
+}
+
+static void Release(Job *job);
+
+static void Finish(Job *job)
+{
+    // The job can be reused as soon as it is finished, copy what is needed
+    // after. Continuations are all added before the job runs.
+    Job *parent = job->parent;
+    const uint32_t continuation_count = job->continuation_count;
+    Job *continuations[Job::MAX_CONTINUATIONS];
+    std::copy_n(job->continuations, continuation_count, continuations);
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+    for (uint32_t i = 0; i < continuation_count; ++i) {
+        Release(continuations[i]);
+    }
+    if (parent) {
+        Finish(parent);
+    }
+}
+
+static void Execute(Job *job)
+{
+    {
+        SD_PROFILE_SCOPE("JobSystem::Job");
+        job->function(job, job->data);
+    }
+    Finish(job);
+}
+
+// Drop one pending count, and queue the job once it has none left.
+static void Release(Job *job)
+{
+    if (job->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+    if (s_thread_index < 0 || !s_data.queues[s_thread_index]->Push(job)) {
+        Execute(job);
+        return;
+    }
+    // A sleeper counts itself before its last search, and the push is
+    // checked against the count after, so one of the two sees the other.
+    // Notifying under the mutex keeps a sleeper from missing it between
+    // its search and its wait.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (s_data.sleeping.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(s_data.mutex);
+        s_data.condition.notify_one();
+    }
+}
+
+static void WorkerMain(int32_t index)
+{
+    s_thread_index = index;
+    uint32_t idle = 0;
+    while (s_data.running.load(std::memory_order_acquire)) {
+        if (Job *job = GetJob()) {
+            Execute(job);
+            idle = 0;
+        }
+        else if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+        }
+        else {
+            Job *job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(s_data.mutex);
+                ++s_data.sleeping;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                s_data.condition.wait(lock, [&] {
+                    return !s_data.running.load(std::memory_order_acquire) ||
+                           (job = GetJob()) != nullptr;
+                });
+                --s_data.sleeping;
+            }
+            if (job) {
+                Execute(job);
+            }
+            idle = 0;
+        }
+    }
+}
+
+void JobSystem::Init(uint32_t workers)
+{
+    SD_CORE_ASSERT(!s_data.running, "Job system already initialized!");
+    for (uint32_t i = 0; i <= workers; ++i) {
+        s_data.queues.push_back(std::make_unique<JobQueue>());
+    }
+    s_thread_index = 0;
+    s_data.running = true;
+    for (uint32_t i = 1; i <= workers; ++i) {
+        s_data.workers.emplace_back(WorkerMain, i);
+    }
+    SD_CORE_INFO("Job system started with {} workers.", workers);
+}
+
+void JobSystem::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_data.mutex);
+        s_data.running = false;
+    }
+    s_data.condition.notify_all();
+    for (auto &worker : s_data.workers) {
+        worker.join();
+    }
+    s_data.workers.clear();
+    s_data.queues.clear();
+    s_thread_index = -1;
+}
+
+uint32_t JobSystem::GetThreadCount()
+{
+    return std::max<uint32_t>(s_data.queues.size(), 1);
+}
+
+Job *JobSystem::Allocate(Job::Function function, Job *parent)
+{
+    thread_local JobPool pool;
+    Job *job = pool.Acquire();
+    job->function = function;
+    job->parent = parent;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    job->pending.store(1, std::memory_order_relaxed);
+    job->continuation_count = 0;
+    if (parent) {
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+void JobSystem::AddDependency(Job *job, Job *dependency)
+{
+    SD_CORE_ASSERT(dependency->continuation_count < Job::MAX_CONTINUATIONS,
+                   "Too many jobs depending on a job!");
+    job->pending.fetch_add(1, std::memory_order_relaxed);
+    dependency->continuations[dependency->continuation_count++] = job;
+}
+
+void JobSystem::Run(Job *job) { Release(job); }
+
+void JobSystem::Wait(const Job *job)
+{
+    // The jobs run meanwhile may allocate, keep this one from being reused
+    // once it finishes.
+    job->waiters.fetch_add(1, std::memory_order_relaxed);
+    while (!IsFinished(job)) {
+        if (Job *other = GetJob()) {
+            Execute(other);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    job->waiters.fetch_sub(1, std::memory_order_release);
+}
+
+bool JobSystem::IsFinished(const Job *job)
+{
+    return job->unfinished.load(std::memory_order_acquire) == 0;
+}
+
+}  // namespace SD
@@ -2,10 +2,100 @@
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 
+#include <algorithm>
+#include <limits>
+
 namespace SD {
 
 namespace Math {
 
+AABB::AABB()
+    : min(std::numeric_limits<float>::max()),
+      max(std::numeric_limits<float>::lowest())
+{
+}
+
+bool AABB::IsValid() const
+{
+    return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+void AABB::Merge(const Vector3f &point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+AABB AABB::Transform(const Matrix4f &transform) const
+{
+    // Arvo's method: transform the center and project the extent onto the
+    // absolute of the rotation part.
+    const Vector3f center(transform * Vector4f(GetCenter(), 1.f));
+    const Vector3f extent = GetExtent();
+    Vector3f new_extent(0);
+    for (glm::length_t i = 0; i < 3; ++i) {
+        new_extent += glm::abs(Vector3f(transform[i])) * extent[i];
+    }
+    return AABB(center - new_extent, center + new_extent);
+}
+
+bool AABB::Intersects(const BoundingSphere &sphere) const
+{
+    const Vector3f closest = glm::clamp(sphere.center, min, max);
+    const Vector3f offset = closest - sphere.center;
+    return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+}
+
+BoundingSphere BoundingSphere::Transform(const Matrix4f &transform) const
+{
+    const float scale = std::sqrt(std::max(
+        {glm::dot(Vector3f(transform[0]), Vector3f(transform[0])),
+         glm::dot(Vector3f(transform[1]), Vector3f(transform[1])),
+         glm::dot(Vector3f(transform[2]), Vector3f(transform[2]))}));
+    return BoundingSphere(Vector3f(transform * Vector4f(center, 1.f)),
+                          radius * scale);
+}
+
+Frustum::Frustum(const Matrix4f &projection_view)
+{
+    // Gribb-Hartmann, glm is column major so row i is m[*][i].
+    const Matrix4f m = glm::transpose(projection_view);
+    planes[Left] = m[3] + m[0];
+    planes[Right] = m[3] - m[0];
+    planes[Bottom] = m[3] + m[1];
+    planes[Top] = m[3] - m[1];
+    planes[Near] = m[3] + m[2];
+    planes[Far] = m[3] - m[2];
+    for (auto &plane : planes) {
+        plane /= glm::length(Vector3f(plane));
+    }
+}
+
+bool Frustum::Intersects(const AABB &aabb) const
+{
+    for (const auto &plane : planes) {
+        // The corner furthest along the plane normal.
+        const Vector3f p(plane.x > 0 ? aabb.max.x : aabb.min.x,
+                         plane.y > 0 ? aabb.max.y : aabb.min.y,
+                         plane.z > 0 ? aabb.max.z : aabb.min.z);
+        if (glm::dot(Vector3f(plane), p) + plane.w < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::Intersects(const BoundingSphere &sphere) const
+{
+    for (const auto &plane : planes) {
+        if (glm::dot(Vector3f(plane), sphere.center) + plane.w <
+            -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool Decompose(const Matrix4f &transform, Vector3f &translation,
                Quaternion &rotation, Vector3f &scale)
 {
@@ -90,6 +180,12 @@ bool Rect::Contains(const Rect &other) const
            y + height >= other.y + other.height;
 }
 
+bool Rect::Contains(const Vector2f &point) const
+{
+    return x <= point.x && y <= point.y && x + width >= point.x &&
+           y + height >= point.y;
+}
+
 bool Rect::Intersects(const Rect &other) const
 {
     return x <= other.x + other.width && x + width >= other.x &&
@@ -0,0 +1,246 @@
+#include "Utility/Metrics.hpp"
+#include "Utility/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace SD {
+
+// Range of the frame totals of a counter.
+static const double COUNTER_MIN = 1;
+static const double COUNTER_MAX = 1e10;
+
+Histogram::Histogram(double min, double max, int32_t buckets_per_octave)
+    : m_min(min), m_buckets_per_octave(buckets_per_octave)
+{
+    SD_CORE_ASSERT(min > 0 && max > min && buckets_per_octave > 0,
+                   "Invalid histogram range!");
+    // The underflow bucket, then the ones from min to max.
+    const size_t count =
+        std::ceil(std::log2(max / min) * m_buckets_per_octave) + 2;
+    m_buckets.resize(count);
+    Reset();
+}
+
+void Histogram::Record(double value)
+{
+    size_t bucket = 0;
+    if (value > m_min) {
+        bucket = std::min<size_t>(
+            std::log2(value / m_min) * m_buckets_per_octave + 1,
+            m_buckets.size() - 1);
+    }
+    ++m_buckets[bucket];
+    ++m_count;
+    m_sum += value;
+    m_min_value = std::min(m_min_value, value);
+    m_max_value = std::max(m_max_value, value);
+}
+
+void Histogram::Reset()
+{
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_sum = 0;
+    m_min_value = std::numeric_limits<double>::max();
+    m_max_value = std::numeric_limits<double>::lowest();
+}
+
+double Histogram::GetPercentile(double p) const
+{
+    if (m_count == 0) return 0;
+
+    const uint64_t rank =
+        std::max<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * m_count), 1);
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    for (; bucket < m_buckets.size(); ++bucket) {
+        seen += m_buckets[bucket];
+        if (seen >= rank) break;
+    }
+    if (bucket == 0) return m_min_value;
+
+    const double middle =
+        m_min * std::exp2((bucket - 0.5) / m_buckets_per_octave);
+    return std::clamp(middle, m_min_value, m_max_value);
+}
+
+double Histogram::GetMean() const
+{
+    return m_count > 0 ? m_sum / m_count : 0;
+}
+
+struct MetricsData {
+    std::vector<Metric> metrics;
+    uint32_t window{600};
+    uint32_t frame{0};
+    uint64_t window_index{0};
+    std::string dump_path;
+    MetricsFormat dump_format{MetricsFormat::CSV};
+};
+
+static MetricsData s_data;
+
+static Metrics::Id Register(const std::string &name, MetricType type,
+                            double min, double max)
+{
+    for (size_t i = 0; i < s_data.metrics.size(); ++i) {
+        if (s_data.metrics[i].name == name) {
+            SD_CORE_ASSERT(s_data.metrics[i].type == type,
+                           "Metric registered with another type!");
+            return i;
+        }
+    }
+    s_data.metrics.push_back({name, type, 0, 0, Histogram(min, max)});
+    return s_data.metrics.size() - 1;
+}
+
+static std::ofstream OpenDump(const std::string &path,
+                              std::ios::openmode mode)
+{
+    std::ofstream file;
+    file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    try {
+        file.open(path, mode);
+    }
+    catch (std::ofstream::failure &e) {
+        throw FileException(path, std::strerror(errno));
+    }
+    return file;
+}
+
+static const char *GetTypeName(MetricType type)
+{
+    switch (type) {
+        case MetricType::Counter:
+            return "counter";
+        case MetricType::Gauge:
+            return "gauge";
+        case MetricType::Histogram:
+            return "histogram";
+    }
+    return "";
+}
+
+// Append the window to the dump file.
+static void Dump()
+{
+    std::ofstream file = OpenDump(s_data.dump_path, std::ios::app);
+    const uint64_t window = s_data.window_index;
+    if (s_data.dump_format == MetricsFormat::CSV) {
+        for (const Metric &metric : s_data.metrics) {
+            const Histogram &histogram = metric.histogram;
+            file << fmt::format(
+                "{},{},{},{},{},{},{},{},{},{}\n", window, metric.name,
+                GetTypeName(metric.type), metric.value, histogram.GetCount(),
+                histogram.GetMean(), histogram.GetPercentile(0.5),
+                histogram.GetPercentile(0.95), histogram.GetPercentile(0.99),
+                histogram.GetCount() > 0 ? histogram.GetMax() : 0);
+        }
+    }
+    else {
+        file << fmt::format("{{\"window\":{},\"frames\":{},\"metrics\":{{",
+                            window, s_data.window);
+        bool first = true;
+        for (const Metric &metric : s_data.metrics) {
+            const Histogram &histogram = metric.histogram;
+            file << fmt::format(
+                "{}\"{}\":{{\"type\":\"{}\",\"value\":{},\"count\":{},"
+                "\"mean\":{},\"p50\":{},\"p95\":{},\"p99\":{},\"max\":{}}}",
+                first ? "" : ",", metric.name, GetTypeName(metric.type),
+                metric.value, histogram.GetCount(), histogram.GetMean(),
+                histogram.GetPercentile(0.5), histogram.GetPercentile(0.95),
+                histogram.GetPercentile(0.99),
+                histogram.GetCount() > 0 ? histogram.GetMax() : 0);
+            first = false;
+        }
+        file << "}}\n";
+    }
+}
+
+Metrics::Id Metrics::RegisterCounter(const std::string &name)
+{
+    return Register(name, MetricType::Counter, COUNTER_MIN, COUNTER_MAX);
+}
+
+Metrics::Id Metrics::RegisterGauge(const std::string &name)
+{
+    return Register(name, MetricType::Gauge, COUNTER_MIN, COUNTER_MAX);
+}
+
+Metrics::Id Metrics::RegisterHistogram(const std::string &name, double min,
+                                       double max)
+{
+    return Register(name, MetricType::Histogram, min, max);
+}
+
+void Metrics::Add(Id counter, uint64_t value)
+{
+    s_data.metrics[counter].frame_count += value;
+}
+
+void Metrics::Set(Id gauge, double value)
+{
+    s_data.metrics[gauge].value = value;
+}
+
+void Metrics::Record(Id histogram, double value)
+{
+    Metric &metric = s_data.metrics[histogram];
+    metric.value = value;
+    metric.histogram.Record(value);
+}
+
+void Metrics::EndFrame()
+{
+    for (Metric &metric : s_data.metrics) {
+        if (metric.type == MetricType::Counter) {
+            metric.value = metric.frame_count;
+            metric.histogram.Record(metric.value);
+            metric.frame_count = 0;
+        }
+    }
+    if (++s_data.frame < s_data.window) return;
+
+    s_data.frame = 0;
+    if (!s_data.dump_path.empty()) {
+        try {
+            Dump();
+        }
+        catch (const Exception &e) {
+            SD_CORE_ERROR("{}", e.what());
+            s_data.dump_path.clear();
+        }
+    }
+    ++s_data.window_index;
+    for (Metric &metric : s_data.metrics) {
+        metric.histogram.Reset();
+    }
+}
+
+void Metrics::SetWindow(uint32_t frames)
+{
+    s_data.window = std::max<uint32_t>(frames, 1);
+}
+
+uint32_t Metrics::GetWindow() { return s_data.window; }
+
+void Metrics::SetDump(const std::string &path, MetricsFormat format)
+{
+    s_data.dump_path.clear();
+    if (path.empty()) return;
+
+    std::ofstream file = OpenDump(path, std::ios::trunc);
+    if (format == MetricsFormat::CSV) {
+        file << "window,name,type,value,count,mean,p50,p95,p99,max\n";
+    }
+    s_data.dump_path = path;
+    s_data.dump_format = format;
+}
+
+const std::vector<Metric> &Metrics::GetMetrics() { return s_data.metrics; }
+
+}  // namespace SD
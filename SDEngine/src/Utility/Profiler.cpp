@@ -0,0 +1,238 @@
+#include "Utility/Profiler.hpp"
+#include "Utility/Exception.hpp"
+#include "Utility/Timing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace SD {
+
+// Records kept per thread.
+static const uint64_t RECORD_CAPACITY = 1 << 15;
+
+static_assert(sizeof(ProfileRecord) % sizeof(uint64_t) == 0,
+              "Profile records are copied in words!");
+
+// A ring slot under a sequence lock, 2n + 1 while the owner writes the
+// record n and 2n + 2 once written. The record is stored as relaxed atomic
+// words so that a reader racing the writer is well defined, and the copy
+// is kept only if the sequence was 2n + 2 before and after it.
+struct ProfileSlot {
+    static const size_t WORDS = sizeof(ProfileRecord) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> words[WORDS];
+
+    void Write(uint64_t index, const ProfileRecord &record)
+    {
+        uint64_t data[WORDS];
+        std::memcpy(data, &record, sizeof(record));
+        sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i].store(data[i], std::memory_order_relaxed);
+        }
+        sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    // False if the slot no longer holds the record.
+    bool Read(uint64_t index, ProfileRecord &record) const
+    {
+        const uint64_t expected = 2 * index + 2;
+        if (sequence.load(std::memory_order_acquire) != expected) {
+            return false;
+        }
+        uint64_t data[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            data[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != expected) {
+            return false;
+        }
+        std::memcpy(&record, data, sizeof(record));
+        return true;
+    }
+};
+
+struct ProfileThreadBuffer {
+    ProfileThreadBuffer(uint32_t id)
+        : slots(new ProfileSlot[RECORD_CAPACITY]), thread(id), depth(0)
+    {
+    }
+
+    std::unique_ptr<ProfileSlot[]> slots;
+    // Records written so far, the ring holds the last RECORD_CAPACITY.
+    std::atomic<uint64_t> count{0};
+    uint32_t thread;
+    // Only touched by the owning thread.
+    uint32_t depth;
+};
+
+// Buffers outlive their threads, so their records can still be exported.
+static std::mutex s_buffers_mutex;
+static std::vector<Ref<ProfileThreadBuffer>> s_buffers;
+static std::atomic<bool> s_enabled{true};
+static const ClockType::time_point s_start = ClockType::now();
+
+static ProfileThreadBuffer &GetThreadBuffer()
+{
+    thread_local Ref<ProfileThreadBuffer> buffer = [] {
+        std::lock_guard<std::mutex> lock(s_buffers_mutex);
+        auto created = CreateRef<ProfileThreadBuffer>(s_buffers.size());
+        s_buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+ProfileScope::ProfileScope(const char *name) : m_active(false), m_begin(0)
+{
+    if (!s_enabled.load(std::memory_order_relaxed)) return;
+
+    m_active = true;
+    std::strncpy(m_name, name, sizeof(m_name) - 1);
+    m_name[sizeof(m_name) - 1] = '\0';
+    ++GetThreadBuffer().depth;
+    m_begin = Profiler::Now();
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (!m_active) return;
+
+    const uint64_t end = Profiler::Now();
+    ProfileThreadBuffer &buffer = GetThreadBuffer();
+    --buffer.depth;
+    const uint64_t count = buffer.count.load(std::memory_order_relaxed);
+    ProfileRecord record;
+    record.begin = m_begin;
+    record.end = end;
+    record.thread = buffer.thread;
+    record.depth = buffer.depth;
+    std::memcpy(record.name, m_name, sizeof(record.name));
+    buffer.slots[count % RECORD_CAPACITY].Write(count, record);
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::SetEnabled(bool enabled) { s_enabled = enabled; }
+
+bool Profiler::IsEnabled() { return s_enabled; }
+
+uint64_t Profiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               ClockType::now() - s_start)
+        .count();
+}
+
+uint32_t Profiler::GetThreadId() { return GetThreadBuffer().thread; }
+
+// Append the records of the buffer ended at or after since.
+static void CopyRecords(const ProfileThreadBuffer &buffer, uint64_t since,
+                        std::vector<ProfileRecord> &records)
+{
+    const uint64_t count = buffer.count.load(std::memory_order_acquire);
+    const uint64_t first =
+        count > RECORD_CAPACITY ? count - RECORD_CAPACITY : 0;
+    // Walk back from the newest, the end times only grow so stop at since.
+    // The writer overwrites the oldest first: once a record is gone, the
+    // ones before it are too.
+    const size_t offset = records.size();
+    ProfileRecord record;
+    for (uint64_t i = count; i > first; --i) {
+        if (!buffer.slots[(i - 1) % RECORD_CAPACITY].Read(i - 1, record) ||
+            record.end < since) {
+            break;
+        }
+        records.push_back(record);
+    }
+    std::reverse(records.begin() + offset, records.end());
+}
+
+static std::vector<Ref<ProfileThreadBuffer>> GetBuffers()
+{
+    std::lock_guard<std::mutex> lock(s_buffers_mutex);
+    return s_buffers;
+}
+
+std::vector<ProfileRecord> Profiler::Collect()
+{
+    std::vector<ProfileRecord> records;
+    for (const auto &buffer : GetBuffers()) {
+        CopyRecords(*buffer, 0, records);
+    }
+    return records;
+}
+
+std::vector<ProfileRecord> Profiler::Collect(uint32_t thread, uint64_t since)
+{
+    std::vector<ProfileRecord> records;
+    for (const auto &buffer : GetBuffers()) {
+        if (buffer->thread == thread) {
+            CopyRecords(*buffer, since, records);
+        }
+    }
+    return records;
+}
+
+static void WriteJsonString(std::ostream &os, const char *str)
+{
+    os << '"';
+    for (; *str; ++str) {
+        const char c = *str;
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            os << ' ';
+        }
+        else {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+void Profiler::ExportChromeTrace(const std::string &path)
+{
+    std::ofstream file;
+    file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    try {
+        file.open(path);
+    }
+    catch (std::ofstream::failure &e) {
+        throw FileException(path, std::strerror(errno));
+    }
+    // Complete events, timestamps in microseconds.
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    for (const ProfileRecord &record : Collect()) {
+        file << (first ? "\n" : ",\n") << "{\"name\":";
+        WriteJsonString(file, record.name);
+        file << fmt::format(
+            ",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},"
+            "\"pid\":0,\"tid\":{}}}",
+            record.begin / 1e3, (record.end - record.begin) / 1e3,
+            record.thread);
+        first = false;
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+std::string Profiler::GetFunctionName(const std::string &signature)
+{
+    // Drop the parameters, then the return type and namespace.
+    std::string name = signature.substr(0, signature.find('('));
+    name = name.substr(name.rfind(' ') + 1);
+    if (name.compare(0, 4, "SD::") == 0) {
+        name.erase(0, 4);
+    }
+    return name;
+}
+
+}  // namespace SD
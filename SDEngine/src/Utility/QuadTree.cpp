@@ -1,65 +1,89 @@
 #include "Utility/QuadTree.hpp"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace SD {
 
-Collidable::Collidable() : qt(nullptr) {}
+static const int32_t INVALID_INDEX = -1;
 
-Collidable::Collidable(const Rect &rect, std::any data)
-    : bound(rect), data(data), qt(nullptr)
+static float DistanceSquared(const Rect &rect, const Vector2f &point)
 {
+    const float dx =
+        std::max({rect.x - point.x, 0.f, point.x - (rect.x + rect.width)});
+    const float dy =
+        std::max({rect.y - point.y, 0.f, point.y - (rect.y + rect.height)});
+    return dx * dx + dy * dy;
 }
 
-QuadTree::QuadTree()
-    : m_isLeaf(true),
-      m_level(0),
-      m_capacity(0),
-      m_maxLevel(0),
-      m_parent(nullptr),
-      m_children{nullptr, nullptr, nullptr, nullptr}
+// Slab test, output the entry distance along the ray.
+static bool IntersectRayRect(const Vector2f &origin, const Vector2f &direction,
+                             const Rect &rect, float max_distance, float &t)
 {
+    float t_min = 0;
+    float t_max = max_distance;
+    const float min[2] = {rect.x, rect.y};
+    const float max[2] = {rect.x + rect.width, rect.y + rect.height};
+    for (int i = 0; i < 2; ++i) {
+        if (std::fabs(direction[i]) < std::numeric_limits<float>::epsilon()) {
+            // parallel to the slab
+            if (origin[i] < min[i] || origin[i] > max[i]) return false;
+            continue;
+        }
+        const float inv = 1.f / direction[i];
+        float t1 = (min[i] - origin[i]) * inv;
+        float t2 = (max[i] - origin[i]) * inv;
+        if (t1 > t2) std::swap(t1, t2);
+        t_min = std::max(t_min, t1);
+        t_max = std::min(t_max, t2);
+        if (t_min > t_max) return false;
+    }
+    t = t_min;
+    return true;
 }
 
-QuadTree::QuadTree(const Rect &bound, uint32_t capacity, uint32_t maxLevel)
-    : m_isLeaf(true),
-      m_bound(bound),
-      m_level(0),
-      m_capacity(capacity),
-      m_maxLevel(maxLevel),
-      m_parent(nullptr),
-      m_children{nullptr, nullptr, nullptr, nullptr}
+Collidable::Collidable()
+    : qt(nullptr), node(INVALID_INDEX), element(INVALID_INDEX)
 {
-    m_objects.reserve(m_capacity);
-    m_foundObjects.reserve(m_capacity);
 }
 
-QuadTree::~QuadTree()
+Collidable::Collidable(const Rect &rect, std::any data)
+    : bound(rect),
+      data(data),
+      qt(nullptr),
+      node(INVALID_INDEX),
+      element(INVALID_INDEX)
 {
-    Clear();
-    for (int i = 0; i < 4; ++i) {
-        if (m_children[i]) {
-            delete m_children[i];
-        }
-    }
 }
 
+QuadTree::QuadTree() : QuadTree(Rect(), 0, 0) {}
+
+QuadTree::QuadTree(const Rect &bound, uint32_t capacity, uint32_t maxLevel)
+    : m_capacity(capacity),
+      m_maxLevel(maxLevel),
+      m_size(0),
+      m_free_node(INVALID_INDEX),
+      m_free_element(INVALID_INDEX)
+{
+    m_nodes.push_back(
+        {bound, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, 0, 0});
+    m_elements.reserve(m_capacity);
+}
+
+QuadTree::~QuadTree() { Clear(); }
+
 bool QuadTree::Insert(Collidable *obj)
 {
     if (obj->qt != nullptr) return false;
 
-    if (!m_isLeaf) {
-        QuadTree *child = GetChild(obj->bound);
-        if (child) {
-            return child->Insert(obj);
-        }
-    }
-    m_objects.push_back(obj);
-    obj->qt = this;
-
-    if (m_isLeaf && m_level < m_maxLevel && m_objects.size() >= m_capacity) {
-        Subdivide();
-        Update(obj);
+    int32_t node = 0;
+    while (!m_nodes[node].IsLeaf()) {
+        int32_t child = GetChild(node, obj->bound);
+        if (child == INVALID_INDEX) break;
+        node = child;
     }
+    InsertAt(node, obj);
+    ++m_size;
     return true;
 }
 
@@ -68,110 +92,355 @@ bool QuadTree::Remove(Collidable *obj)
     if (obj->qt == nullptr) return false;
     if (obj->qt != this) return obj->qt->Remove(obj);
 
-    auto iter = std::find(m_objects.begin(), m_objects.end(), obj);
-    if (iter != m_objects.end()) {
-        m_objects.erase(iter);
-        obj->qt = nullptr;
-        DiscardEmptyBuckets();
+    const int32_t node = obj->node;
+    Unlink(node, obj->element);
+    FreeElement(obj->element);
+    obj->qt = nullptr;
+    obj->node = INVALID_INDEX;
+    obj->element = INVALID_INDEX;
+    --m_size;
+    DiscardEmptyBuckets(node);
+    return true;
+}
+
+bool QuadTree::Update(Collidable *obj)
+{
+    if (obj->qt == nullptr) return false;
+    if (obj->qt != this) return obj->qt->Update(obj);
+
+    // Still in the tightest node, nothing to do.
+    const Node &node = m_nodes[obj->node];
+    const bool fit = node.parent == INVALID_INDEX ||
+                     node.bound.Contains(obj->bound);
+    if (fit && (node.IsLeaf() ||
+                GetChild(obj->node, obj->bound) == INVALID_INDEX)) {
         return true;
     }
-    return false;
+    Remove(obj);
+    return Insert(obj);
 }
 
-bool QuadTree::Update(Collidable *obj)
+void QuadTree::Clear()
+{
+    for (auto &element : m_elements) {
+        if (element.obj) {
+            element.obj->qt = nullptr;
+            element.obj->node = INVALID_INDEX;
+            element.obj->element = INVALID_INDEX;
+        }
+    }
+    m_elements.clear();
+    m_free_element = INVALID_INDEX;
+
+    Node &root = m_nodes.front();
+    root.first_child = INVALID_INDEX;
+    root.first_element = INVALID_INDEX;
+    root.count = 0;
+    m_nodes.resize(1);
+    m_free_node = INVALID_INDEX;
+    m_size = 0;
+}
+
+void QuadTree::InsertAt(int32_t node, Collidable *obj)
+{
+    Link(node, AllocateElement(obj));
+    obj->qt = this;
+
+    const Node &n = m_nodes[node];
+    if (n.IsLeaf() && n.level < m_maxLevel && n.count >= m_capacity) {
+        Subdivide(node);
+    }
+}
+
+void QuadTree::Subdivide(int32_t node)
 {
-    if (!Remove(obj)) return false;
+    const int32_t first = AllocateChildren();
+    const Rect bound = m_nodes[node].bound;
+    const uint32_t level = m_nodes[node].level + 1;
+    const float width = bound.width * 0.5f;
+    const float height = bound.height * 0.5f;
+    const Rect bounds[4] = {
+        {bound.x + width, bound.y, width, height},           // Top right
+        {bound.x, bound.y, width, height},                   // Top left
+        {bound.x, bound.y + height, width, height},          // Bottom left
+        {bound.x + width, bound.y + height, width, height},  // Bottom right
+    };
+    for (int i = 0; i < 4; ++i) {
+        m_nodes[first + i] = {bounds[i],     node, INVALID_INDEX,
+                              INVALID_INDEX, 0,    level};
+    }
+    m_nodes[node].first_child = first;
+
+    // Push down every object that fits in a child.
+    int32_t element = m_nodes[node].first_element;
+    while (element != INVALID_INDEX) {
+        const int32_t next = m_elements[element].next;
+        const int32_t child =
+            GetChild(node, m_elements[element].obj->bound);
+        if (child != INVALID_INDEX) {
+            Unlink(node, element);
+            Link(child, element);
+        }
+        element = next;
+    }
+}
 
-    if (m_parent != nullptr && !m_bound.Contains(obj->bound)) {
-        return m_parent->Insert(obj);
+void QuadTree::DiscardEmptyBuckets(int32_t node)
+{
+    if (m_nodes[node].IsLeaf()) {
+        node = m_nodes[node].parent;
     }
-    if (!m_isLeaf) {
-        QuadTree *child = GetChild(obj->bound);
-        if (child) {
-            return child->Insert(obj);
+    while (node != INVALID_INDEX) {
+        const int32_t first = m_nodes[node].first_child;
+        for (int i = 0; i < 4; ++i) {
+            const Node &child = m_nodes[first + i];
+            if (!child.IsLeaf() || child.count) return;
         }
+        FreeChildren(node);
+        if (m_nodes[node].count) return;
+        node = m_nodes[node].parent;
     }
-    return Insert(obj);
 }
 
-void QuadTree::Clear()
+int32_t QuadTree::GetChild(int32_t node, const Rect &bound) const
+{
+    const Node &n = m_nodes[node];
+    const float mid_x = n.bound.x + n.bound.width * 0.5f;
+    const float mid_y = n.bound.y + n.bound.height * 0.5f;
+    const bool left = bound.x + bound.width < mid_x;
+    const bool right = bound.x > mid_x;
+
+    if (bound.y + bound.height < mid_y) {
+        if (left) return n.first_child + 1;   // Top left
+        if (right) return n.first_child + 0;  // Top right
+    }
+    else if (bound.y > mid_y) {
+        if (left) return n.first_child + 2;   // Bottom left
+        if (right) return n.first_child + 3;  // Bottom right
+    }
+    return INVALID_INDEX;  // Cannot contain boundary -- too large
+}
+
+int32_t QuadTree::AllocateChildren()
+{
+    if (m_free_node != INVALID_INDEX) {
+        const int32_t first = m_free_node;
+        m_free_node = m_nodes[first].first_child;
+        return first;
+    }
+    const int32_t first = m_nodes.size();
+    m_nodes.resize(m_nodes.size() + 4);
+    return first;
+}
+
+void QuadTree::FreeChildren(int32_t node)
+{
+    const int32_t first = m_nodes[node].first_child;
+    m_nodes[first].first_child = m_free_node;
+    m_free_node = first;
+    m_nodes[node].first_child = INVALID_INDEX;
+}
+
+int32_t QuadTree::AllocateElement(Collidable *obj)
+{
+    int32_t element;
+    if (m_free_element != INVALID_INDEX) {
+        element = m_free_element;
+        m_free_element = m_elements[element].next;
+    }
+    else {
+        element = m_elements.size();
+        m_elements.emplace_back();
+    }
+    m_elements[element] = {obj, INVALID_INDEX, INVALID_INDEX};
+    obj->element = element;
+    return element;
+}
+
+void QuadTree::FreeElement(int32_t element)
 {
-    for (auto &obj : m_objects) {
-        obj->qt = nullptr;
+    m_elements[element] = {nullptr, INVALID_INDEX, m_free_element};
+    m_free_element = element;
+}
+
+void QuadTree::Link(int32_t node, int32_t element)
+{
+    Node &n = m_nodes[node];
+    Element &e = m_elements[element];
+    e.prev = INVALID_INDEX;
+    e.next = n.first_element;
+    if (n.first_element != INVALID_INDEX) {
+        m_elements[n.first_element].prev = element;
+    }
+    n.first_element = element;
+    ++n.count;
+    e.obj->node = node;
+}
+
+void QuadTree::Unlink(int32_t node, int32_t element)
+{
+    Node &n = m_nodes[node];
+    Element &e = m_elements[element];
+    if (e.prev != INVALID_INDEX) {
+        m_elements[e.prev].next = e.next;
     }
-    m_objects.clear();
-    if (!m_isLeaf) {
-        for (QuadTree *child : m_children) {
-            child->Clear();
+    else {
+        n.first_element = e.next;
+    }
+    if (e.next != INVALID_INDEX) {
+        m_elements[e.next].prev = e.prev;
+    }
+    e.prev = INVALID_INDEX;
+    e.next = INVALID_INDEX;
+    --n.count;
+}
+
+void QuadTree::QueryRange(const Rect &range,
+                          std::vector<Collidable *> &result) const
+{
+    result.clear();
+    QueryRange(0, range, result);
+}
+
+void QuadTree::QueryRange(int32_t node, const Rect &range,
+                          std::vector<Collidable *> &result) const
+{
+    const Node &n = m_nodes[node];
+    for (int32_t e = n.first_element; e != INVALID_INDEX;
+         e = m_elements[e].next) {
+        Collidable *obj = m_elements[e].obj;
+        if (obj->bound.Intersects(range)) {
+            result.push_back(obj);
         }
-        m_isLeaf = true;
-    }
-}
-
-void QuadTree::Subdivide()
-{
-    float width = m_bound.width * 0.5f;
-    float height = m_bound.height * 0.5f;
-    float x = 0, y = 0;
-    for (unsigned i = 0; i < 4; ++i) {
-        switch (i) {
-            case 0:
-                x = m_bound.x + width;
-                y = m_bound.y;
-                break;  // Top right
-            case 1:
-                x = m_bound.x;
-                y = m_bound.y;
-                break;  // Top left
-            case 2:
-                x = m_bound.x;
-                y = m_bound.y + height;
-                break;  // Bottom left
-            case 3:
-                x = m_bound.x + width;
-                y = m_bound.y + height;
-                break;  // Bottom right
+    }
+    if (n.IsLeaf()) return;
+
+    for (int32_t i = 0; i < 4; ++i) {
+        const int32_t child = n.first_child + i;
+        if (m_nodes[child].count || !m_nodes[child].IsLeaf()) {
+            if (m_nodes[child].bound.Intersects(range)) {
+                QueryRange(child, range, result);
+            }
         }
-        m_children[i] =
-            new QuadTree({x, y, width, height}, m_capacity, m_maxLevel);
-        m_children[i]->m_level = m_level + 1;
-        m_children[i]->m_parent = this;
     }
-    m_isLeaf = false;
 }
 
-void QuadTree::DiscardEmptyBuckets()
+void QuadTree::QueryPoint(const Vector2f &point,
+                          std::vector<Collidable *> &result) const
 {
-    if (m_objects.size()) return;
-    if (!m_isLeaf) {
-        for (QuadTree *child : m_children)
-            if (!child->m_isLeaf || child->m_objects.size()) return;
+    result.clear();
+    QueryPoint(0, point, result);
+}
+
+void QuadTree::QueryPoint(int32_t node, const Vector2f &point,
+                          std::vector<Collidable *> &result) const
+{
+    const Node &n = m_nodes[node];
+    for (int32_t e = n.first_element; e != INVALID_INDEX;
+         e = m_elements[e].next) {
+        Collidable *obj = m_elements[e].obj;
+        if (obj->bound.Contains(point)) {
+            result.push_back(obj);
+        }
+    }
+    if (n.IsLeaf()) return;
+
+    for (int32_t i = 0; i < 4; ++i) {
+        const int32_t child = n.first_child + i;
+        if (m_nodes[child].bound.Contains(point)) {
+            QueryPoint(child, point, result);
+        }
     }
-    Clear();
-    if (m_parent != nullptr) m_parent->DiscardEmptyBuckets();
 }
 
-QuadTree *QuadTree::GetChild(const Rect &bound) const
+void QuadTree::QueryRay(const Vector2f &origin, const Vector2f &direction,
+                        float max_distance, std::vector<RayHit> &result) const
 {
-    bool left = bound.x + bound.width < m_bound.GetRight();
-    bool right = bound.x > m_bound.GetRight();
+    result.clear();
+    QueryRay(0, origin, direction, max_distance, result);
+    std::sort(result.begin(), result.end(),
+              [](const RayHit &lhs, const RayHit &rhs) {
+                  return lhs.distance < rhs.distance;
+              });
+}
 
-    if (bound.y + bound.height < m_bound.GetTop()) {
-        if (left) return m_children[1];   // Top left
-        if (right) return m_children[0];  // Top right
+void QuadTree::QueryRay(int32_t node, const Vector2f &origin,
+                        const Vector2f &direction, float max_distance,
+                        std::vector<RayHit> &result) const
+{
+    const Node &n = m_nodes[node];
+    float t = 0;
+    for (int32_t e = n.first_element; e != INVALID_INDEX;
+         e = m_elements[e].next) {
+        Collidable *obj = m_elements[e].obj;
+        if (IntersectRayRect(origin, direction, obj->bound, max_distance, t)) {
+            result.push_back({obj, t});
+        }
     }
-    else if (bound.y > m_bound.GetTop()) {
-        if (left) return m_children[2];   // Bottom left
-        if (right) return m_children[3];  // Bottom right
+    if (n.IsLeaf()) return;
+
+    for (int32_t i = 0; i < 4; ++i) {
+        const int32_t child = n.first_child + i;
+        if (IntersectRayRect(origin, direction, m_nodes[child].bound,
+                             max_distance, t)) {
+            QueryRay(child, origin, direction, max_distance, result);
+        }
     }
-    return nullptr;  // Cannot contain boundary -- too large
 }
 
-bool QuadTree::IsLeaf() const { return m_isLeaf; }
+void QuadTree::QueryNearest(const Vector2f &point, uint32_t k,
+                            std::vector<Collidable *> &result) const
+{
+    result.clear();
+    if (k == 0) return;
+
+    m_foundObjects.clear();
+    m_foundObjects.reserve(k);
+    QueryNearest(0, point, k);
 
-const std::array<QuadTree *, 4> &QuadTree::GetChildren() const
+    std::sort_heap(m_foundObjects.begin(), m_foundObjects.end());
+    for (const auto &[_, obj] : m_foundObjects) {
+        result.push_back(obj);
+    }
+}
+
+void QuadTree::QueryNearest(int32_t node, const Vector2f &point,
+                            uint32_t k) const
 {
-    return m_children;
+    const Node &n = m_nodes[node];
+    for (int32_t e = n.first_element; e != INVALID_INDEX;
+         e = m_elements[e].next) {
+        Collidable *obj = m_elements[e].obj;
+        const float dist = DistanceSquared(obj->bound, point);
+        if (m_foundObjects.size() < k) {
+            m_foundObjects.emplace_back(dist, obj);
+            std::push_heap(m_foundObjects.begin(), m_foundObjects.end());
+        }
+        else if (dist < m_foundObjects.front().first) {
+            std::pop_heap(m_foundObjects.begin(), m_foundObjects.end());
+            m_foundObjects.back() = {dist, obj};
+            std::push_heap(m_foundObjects.begin(), m_foundObjects.end());
+        }
+    }
+    if (n.IsLeaf()) return;
+
+    // Visit the closest child first so the later ones are more likely to be
+    // pruned.
+    std::array<std::pair<float, int32_t>, 4> children;
+    for (int32_t i = 0; i < 4; ++i) {
+        const int32_t child = n.first_child + i;
+        children[i] = {DistanceSquared(m_nodes[child].bound, point), child};
+    }
+    std::sort(children.begin(), children.end());
+    for (const auto &[dist, child] : children) {
+        if (m_foundObjects.size() == k && dist >= m_foundObjects.front().first)
+            break;
+        if (m_nodes[child].count || !m_nodes[child].IsLeaf()) {
+            QueryNearest(child, point, k);
+        }
+    }
 }
 
+bool QuadTree::IsLeaf() const { return m_nodes.front().IsLeaf(); }
+
 }  // namespace SD
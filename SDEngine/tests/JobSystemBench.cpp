@@ -0,0 +1,190 @@
+#include "Utility/JobSystem.hpp"
+#include "Utility/Log.hpp"
+#include "Utility/Timing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace SD;
+
+// The thread pool the job system replaced: one locked queue of packaged
+// tasks, a future per task.
+class LegacyThreadPool {
+   public:
+    LegacyThreadPool(uint32_t threads)
+    {
+        for (uint32_t i = 0; i < threads; ++i) {
+            m_workers.emplace_back([this] {
+                while (true) {
+                    std::packaged_task<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_condition.wait(lock, [this] {
+                            return m_stop || !m_tasks.empty();
+                        });
+                        if (m_stop && m_tasks.empty()) {
+                            return;
+                        }
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~LegacyThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        for (auto &worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    template <typename F>
+    std::future<void> Queue(F &&f)
+    {
+        std::packaged_task<void()> task(std::forward<F>(f));
+        std::future<void> res = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace(std::move(task));
+        }
+        m_condition.notify_one();
+        return res;
+    }
+
+   private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::packaged_task<void()>> m_tasks;
+    std::mutex m_mutex;
+    bool m_stop{false};
+    std::condition_variable m_condition;
+};
+
+static const uint32_t TASK_COUNT = 100000;
+static const uint32_t FRAME_COUNT = 1000;
+static const uint32_t FRAME_TASKS = 64;
+static const uint32_t ELEMENT_COUNT = 4000000;
+
+// A few hundred nanoseconds of work.
+static float Work(uint32_t seed)
+{
+    float sum = 0;
+    for (uint32_t i = 0; i < 64; ++i) {
+        sum += std::sqrt(static_cast<float>(seed + i));
+    }
+    return sum;
+}
+
+static std::vector<float> s_results(TASK_COUNT);
+
+static void Report(const char *name, float legacy_ms, float job_ms)
+{
+    std::printf("%-28s legacy %9.2f ms | jobs %9.2f ms | x%.2f\n", name,
+                legacy_ms, job_ms, legacy_ms / job_ms);
+}
+
+// Many small independent tasks, all waited for at the end.
+static void RunTasks(LegacyThreadPool &pool)
+{
+    Clock clock;
+    std::vector<std::future<void>> futures;
+    futures.reserve(TASK_COUNT);
+    for (uint32_t i = 0; i < TASK_COUNT; ++i) {
+        futures.push_back(pool.Queue([i] { s_results[i] = Work(i); }));
+    }
+    for (auto &future : futures) {
+        future.wait();
+    }
+    const float legacy_ms = clock.Restart();
+
+    Job *root = JobSystem::CreateJob([] {});
+    for (uint32_t i = 0; i < TASK_COUNT; ++i) {
+        JobSystem::Run(JobSystem::CreateChildJob(
+            root, [i] { s_results[i] = Work(i); }));
+    }
+    JobSystem::Run(root);
+    JobSystem::Wait(root);
+    Report("100k small tasks", legacy_ms, clock.Restart());
+}
+
+// A frame forks a few tasks and joins them before the next one.
+static void RunFrames(LegacyThreadPool &pool)
+{
+    Clock clock;
+    std::vector<std::future<void>> futures;
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        futures.clear();
+        for (uint32_t i = 0; i < FRAME_TASKS; ++i) {
+            futures.push_back(pool.Queue([i] { s_results[i] = Work(i); }));
+        }
+        for (auto &future : futures) {
+            future.wait();
+        }
+    }
+    const float legacy_ms = clock.Restart();
+
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        JobSystem::ParallelFor(
+            FRAME_TASKS, [](uint32_t i) { s_results[i] = Work(i); }, 1);
+    }
+    Report("1000 frames of 64 tasks", legacy_ms, clock.Restart());
+}
+
+// A large loop, split in even chunks for the pool.
+static void RunLoop(LegacyThreadPool &pool, uint32_t threads)
+{
+    std::vector<float> data(ELEMENT_COUNT);
+    const uint32_t chunks = threads * 4;
+    const uint32_t chunk = (ELEMENT_COUNT + chunks - 1) / chunks;
+
+    Clock clock;
+    std::vector<std::future<void>> futures;
+    for (uint32_t begin = 0; begin < ELEMENT_COUNT; begin += chunk) {
+        const uint32_t end = std::min(begin + chunk, ELEMENT_COUNT);
+        futures.push_back(pool.Queue([&data, begin, end] {
+            for (uint32_t i = begin; i < end; ++i) {
+                data[i] = std::sqrt(static_cast<float>(i));
+            }
+        }));
+    }
+    for (auto &future : futures) {
+        future.wait();
+    }
+    const float legacy_ms = clock.Restart();
+
+    JobSystem::ParallelFor(ELEMENT_COUNT, [&data](uint32_t i) {
+        data[i] = std::sqrt(static_cast<float>(i));
+    });
+    Report("4M element loop", legacy_ms, clock.Restart());
+}
+
+int main()
+{
+    Log::Init("JobSystemBench.log");
+    const uint32_t threads = std::max(std::thread::hardware_concurrency(), 2u);
+    // Both use every core: the job system counts the calling thread.
+    LegacyThreadPool pool(threads);
+    JobSystem::Init(threads - 1);
+    std::printf("%u threads\n", threads);
+    for (uint32_t i = 0; i < 3; ++i) {
+        RunTasks(pool);
+        RunFrames(pool);
+        RunLoop(pool, threads);
+    }
+    JobSystem::Shutdown();
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "Test.hpp"
+#include "Utility/JobSystem.hpp"
+#include "Utility/Log.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace SD;
+
+static const uint32_t WORKERS = 3;
+static const uint32_t REPEATS = 200;
+
+// Every index is called exactly once, also with chunks small enough that
+// the split alone would outgrow a job pool.
+static void CheckParallelFor(uint32_t count, uint32_t chunk)
+{
+    std::unique_ptr<std::atomic<uint32_t>[]> calls(
+        new std::atomic<uint32_t>[count]);
+    for (uint32_t i = 0; i < count; ++i) {
+        calls[i] = 0;
+    }
+    JobSystem::ParallelFor(
+        count,
+        [&](uint32_t i) { calls[i].fetch_add(1, std::memory_order_relaxed); },
+        chunk);
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        wrong += calls[i] != 1;
+    }
+    SD_CHECK(wrong == 0);
+}
+
+static void CheckNestedParallelFor()
+{
+    const uint32_t outer = 64;
+    const uint32_t inner = 1000;
+    std::atomic<uint32_t> calls{0};
+    JobSystem::ParallelFor(
+        outer,
+        [&](uint32_t) {
+            JobSystem::ParallelFor(
+                inner,
+                [&](uint32_t) {
+                    calls.fetch_add(1, std::memory_order_relaxed);
+                },
+                1);
+        },
+        1);
+    SD_CHECK(calls == outer * inner);
+}
+
+// A diamond run in reverse order: b and c start after a, d after both.
+static void CheckDependencies()
+{
+    for (uint32_t r = 0; r < REPEATS; ++r) {
+        std::atomic<uint32_t> stamp{0};
+        uint32_t a_stamp = 0;
+        uint32_t b_stamp = 0;
+        uint32_t c_stamp = 0;
+        uint32_t d_stamp = 0;
+        Job *a = JobSystem::CreateJob([&] { a_stamp = ++stamp; });
+        Job *b = JobSystem::CreateJob([&] { b_stamp = ++stamp; });
+        Job *c = JobSystem::CreateJob([&] { c_stamp = ++stamp; });
+        Job *d = JobSystem::CreateJob([&] { d_stamp = ++stamp; });
+        JobSystem::AddDependency(b, a);
+        JobSystem::AddDependency(c, a);
+        JobSystem::AddDependency(d, b);
+        JobSystem::AddDependency(d, c);
+        JobSystem::Run(d);
+        JobSystem::Run(c);
+        JobSystem::Run(b);
+        SD_CHECK(!JobSystem::IsFinished(d));
+        JobSystem::Run(a);
+        JobSystem::Wait(d);
+        SD_CHECK(a_stamp == 1);
+        SD_CHECK(b_stamp > a_stamp && c_stamp > a_stamp);
+        SD_CHECK(d_stamp == 4);
+    }
+}
+
+static void CheckChildren()
+{
+    // The parent is not finished while a child still runs.
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    Job *parent = JobSystem::CreateJob([] {});
+    Job *child = JobSystem::CreateChildJob(parent, [&] {
+        started = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    JobSystem::Run(child);
+    JobSystem::Run(parent);
+    while (!started) {
+        std::this_thread::yield();
+    }
+    SD_CHECK(!JobSystem::IsFinished(parent));
+    release = true;
+    JobSystem::Wait(parent);
+    SD_CHECK(JobSystem::IsFinished(child));
+
+    // More children alive at once than a pool holds: the pool grows rather
+    // than handing out a job not yet run.
+    const uint32_t count = JobSystem::JOB_POOL_SIZE * 3;
+    std::atomic<uint32_t> calls{0};
+    parent = JobSystem::CreateJob([] {});
+    std::vector<Job *> children;
+    for (uint32_t i = 0; i < count; ++i) {
+        children.push_back(JobSystem::CreateChildJob(
+            parent, [&] { calls.fetch_add(1, std::memory_order_relaxed); }));
+    }
+    SD_CHECK(calls == 0);
+    for (Job *job : children) {
+        JobSystem::Run(job);
+    }
+    JobSystem::Run(parent);
+    JobSystem::Wait(parent);
+    SD_CHECK(calls == count);
+}
+
+// Jobs pushed while the workers sleep wake one up: the pushing thread only
+// spins, so a missed wake up hangs.
+static void CheckWakeUp()
+{
+    using namespace std::chrono_literals;
+    for (uint32_t r = 0; r < 20; ++r) {
+        std::this_thread::sleep_for(5ms);
+        std::atomic<bool> done{false};
+        JobSystem::Run(JobSystem::CreateJob([&] { done = true; }));
+        while (!done) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// A thread without a deque runs its jobs right away and steals meanwhile.
+static void CheckOtherThread()
+{
+    std::thread thread([] {
+        CheckParallelFor(20000, 1);
+        CheckDependencies();
+    });
+    thread.join();
+}
+
+int main()
+{
+    Log::Init("JobSystemTest.log");
+    JobSystem::Init(WORKERS);
+    for (uint32_t r = 0; r < 10; ++r) {
+        CheckParallelFor(20000, 1);
+        CheckParallelFor(1000000, 0);
+        CheckParallelFor(JobSystem::JOB_POOL_SIZE * 4, 2);
+    }
+    CheckParallelFor(1, 0);
+    CheckParallelFor(0, 0);
+    CheckNestedParallelFor();
+    CheckDependencies();
+    CheckChildren();
+    CheckWakeUp();
+    CheckOtherThread();
+    JobSystem::Shutdown();
+    return SD_TEST_RESULT();
+}
@@ -0,0 +1,115 @@
+#include "Test.hpp"
+#include "Graphics/LightCluster.hpp"
+#include "Utility/Random.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace SD;
+
+static const uint32_t LIGHT_COUNT = 500;
+// Lights within this fraction of their radius from a cluster may go either
+// way, the float error of the two tests differs.
+static const float TOLERANCE = 1e-3f;
+
+// Squared distance from the point to the box, 0 inside of it.
+static float DistanceSquared(const Math::AABB &box, const Vector3f &point)
+{
+    float distance = 0;
+    for (int i = 0; i < 3; ++i) {
+        const float d = std::max({box.min[i] - point[i], 0.f,
+                                  point[i] - box.max[i]});
+        distance += d * d;
+    }
+    return distance;
+}
+
+// Lights spread over the view volume and a bit past it, some large, some
+// outside of it, some invalid.
+static std::vector<Math::BoundingSphere> CreateLights(
+    const Matrix4f &projection, const Matrix4f &view)
+{
+    const Matrix4f inv_projection_view = glm::inverse(projection * view);
+    std::vector<Math::BoundingSphere> lights;
+    for (uint32_t i = 0; i < LIGHT_COUNT; ++i) {
+        const Vector4f ndc(Random::Rnd(-1.2f, 1.2f), Random::Rnd(-1.2f, 1.2f),
+                           Random::Rnd(-1.1f, 1.1f), 1.f);
+        const Vector4f pos = inv_projection_view * ndc;
+        float radius = Random::Rnd(0.1f, 4.f);
+        if (i % 10 == 0) {
+            radius *= 10;
+        }
+        else if (i % 50 == 1) {
+            radius = -1;
+        }
+        lights.emplace_back(Vector3f(pos) / pos.w, radius);
+    }
+    return lights;
+}
+
+static void Check(const Matrix4f &projection, float near_z, float far_z,
+                  bool perspective)
+{
+    const Matrix4f view =
+        glm::lookAt(Vector3f(3, 2, 10), Vector3f(0, 0, 0), Vector3f(0, 1, 0));
+    const std::vector<Math::BoundingSphere> lights =
+        CreateLights(projection, view);
+
+    LightCluster cluster;
+    cluster.SetProjection(projection, near_z, far_z);
+    SD_CHECK(cluster.IsPerspective() == perspective);
+    cluster.Assign(view, lights);
+
+    const auto &clusters = cluster.GetClusters();
+    const auto &indices = cluster.GetLightIndices();
+    const uint32_t count =
+        cluster.GetSizeX() * cluster.GetSizeY() * cluster.GetSizeZ();
+    SD_CHECK(clusters.size() == count);
+    uint32_t offset = 0;
+    uint32_t assigned = 0;
+    for (uint32_t c = 0; c < count; ++c) {
+        SD_CHECK(clusters[c].offset == offset);
+        offset += clusters[c].count;
+
+        std::vector<bool> found(lights.size(), false);
+        for (uint32_t i = 0; i < clusters[c].count; ++i) {
+            const uint32_t light = indices[clusters[c].offset + i];
+            SD_CHECK(light < lights.size() && !found[light]);
+            found[light] = true;
+        }
+        // Brute force: every light against the cluster bound.
+        const Math::AABB &bound = cluster.GetBound(c);
+        for (uint32_t i = 0; i < lights.size(); ++i) {
+            if (!lights[i].IsValid()) {
+                SD_CHECK(!found[i]);
+                continue;
+            }
+            const Vector3f center(view * Vector4f(lights[i].center, 1.f));
+            const float distance = DistanceSquared(bound, center);
+            const float radius = lights[i].radius * lights[i].radius;
+            if (distance < radius * (1 - TOLERANCE)) {
+                SD_CHECK(found[i]);
+            }
+            else if (distance > radius * (1 + TOLERANCE)) {
+                SD_CHECK(!found[i]);
+            }
+        }
+        assigned += clusters[c].count;
+    }
+    SD_CHECK(offset == indices.size());
+    // The test means nothing if no light lands anywhere.
+    SD_CHECK(assigned > LIGHT_COUNT);
+}
+
+int main()
+{
+    Random::Init(42);
+    Check(glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f), 0.1f,
+          100.f, true);
+    Check(glm::perspective(glm::radians(90.f), 1.f, 1.f, 30.f), 1.f, 30.f,
+          true);
+    Check(glm::ortho(-20.f, 20.f, -10.f, 10.f, 0.1f, 50.f), 0.1f, 50.f,
+          false);
+    Check(glm::ortho(-5.f, 15.f, -5.f, 5.f, -10.f, 10.f), -10.f, 10.f, false);
+    return SD_TEST_RESULT();
+}
@@ -0,0 +1,157 @@
+#include "Utility/MPMCQueue.hpp"
+#include "Utility/Timing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace SD;
+
+static const uint32_t ITEM_COUNT = 1 << 21;
+static const size_t CAPACITY = 1024;
+static const size_t BATCH = 16;
+
+// A std::queue under a mutex, for reference.
+class LockedQueue {
+   public:
+    bool TryPush(uint64_t item)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.size() >= CAPACITY) return false;
+
+        m_items.push(item);
+        return true;
+    }
+
+    bool TryPop(uint64_t &item)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.empty()) return false;
+
+        item = m_items.front();
+        m_items.pop();
+        return true;
+    }
+
+   private:
+    std::mutex m_mutex;
+    std::queue<uint64_t> m_items;
+};
+
+// Time threads producers and as many consumers moving ITEM_COUNT items,
+// return millions of items per second.
+template <typename Push, typename Pop>
+static float Measure(uint32_t threads, Push push, Pop pop)
+{
+    const uint32_t per_thread = ITEM_COUNT / threads;
+    std::atomic<uint64_t> checksum{0};
+    std::vector<std::thread> workers;
+    Clock clock;
+    for (uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (uint32_t i = 0; i < per_thread;) {
+                i += push(i, per_thread - i);
+            }
+        });
+        workers.emplace_back([&] {
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < per_thread;) {
+                i += pop(sum, per_thread - i);
+            }
+            checksum += sum;
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    const float ms = clock.GetElapsedMS();
+    const uint64_t expected =
+        static_cast<uint64_t>(per_thread) * (per_thread - 1) / 2 * threads;
+    if (checksum != expected) {
+        std::printf("checksum mismatch!\n");
+    }
+    return per_thread * threads / (ms * 1000.f);
+}
+
+// A thread that finds the queue full or empty yields and tries again.
+static uint32_t Yield(size_t count)
+{
+    if (count == 0) {
+        std::this_thread::yield();
+    }
+    return count;
+}
+
+static void Run(uint32_t threads)
+{
+    MPMCQueue<uint64_t, false> queue(CAPACITY);
+    const float single = Measure(
+        threads, [&](uint32_t i, uint32_t) { return Yield(queue.TryPush(i)); },
+        [&](uint64_t &sum, uint32_t) {
+            uint64_t item;
+            const bool popped = queue.TryPop(item);
+            sum += popped ? item : 0;
+            return Yield(popped);
+        });
+
+    const float batch = Measure(
+        threads,
+        [&](uint32_t i, uint32_t left) {
+            uint64_t items[BATCH];
+            const size_t count = std::min<size_t>(BATCH, left);
+            for (size_t j = 0; j < count; ++j) {
+                items[j] = i + j;
+            }
+            return Yield(queue.TryPush(items, count));
+        },
+        [&](uint64_t &sum, uint32_t left) {
+            uint64_t items[BATCH];
+            const size_t count =
+                queue.TryPop(items, std::min<size_t>(BATCH, left));
+            for (size_t j = 0; j < count; ++j) {
+                sum += items[j];
+            }
+            return Yield(count);
+        });
+
+    MPMCQueue<uint64_t> blocking_queue(CAPACITY);
+    const float blocking = Measure(
+        threads,
+        [&](uint32_t i, uint32_t) {
+            blocking_queue.Push(i);
+            return 1u;
+        },
+        [&](uint64_t &sum, uint32_t) {
+            sum += blocking_queue.Pop();
+            return 1u;
+        });
+
+    LockedQueue locked_queue;
+    const float locked = Measure(
+        threads,
+        [&](uint32_t i, uint32_t) { return Yield(locked_queue.TryPush(i)); },
+        [&](uint64_t &sum, uint32_t) {
+            uint64_t item;
+            const bool popped = locked_queue.TryPop(item);
+            sum += popped ? item : 0;
+            return Yield(popped);
+        });
+
+    std::printf(
+        "%2u producers %2u consumers: try %7.2f | batch %7.2f | blocking "
+        "%7.2f | mutex %7.2f Mitems/s\n",
+        threads, threads, single, batch, blocking, locked);
+}
+
+int main()
+{
+    for (uint32_t threads : {1u, 2u, 4u, 8u, 16u, 32u}) {
+        Run(threads);
+    }
+    return 0;
+}
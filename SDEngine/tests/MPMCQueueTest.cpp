@@ -0,0 +1,235 @@
+#include "Test.hpp"
+#include "Utility/MPMCQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace SD;
+
+enum class Mode { SINGLE, BATCH, BLOCKING };
+
+static const size_t MAX_BATCH = 16;
+
+// The producer in the high bits, its sequence number in the low ones.
+static uint64_t MakeItem(uint32_t producer, uint32_t sequence)
+{
+    return (static_cast<uint64_t>(producer) << 32) | sequence;
+}
+
+static void CheckBasics()
+{
+    MPMCQueue<int> queue(5);
+    SD_CHECK(queue.GetCapacity() == 8);
+    int item = 0;
+    SD_CHECK(!queue.TryPop(item));
+    for (int i = 0; i < 8; ++i) {
+        SD_CHECK(queue.TryPush(i));
+    }
+    SD_CHECK(!queue.TryPush(8));
+    SD_CHECK(queue.GetSize() == 8);
+    // Many laps over the ring, in order.
+    for (int i = 0; i < 1000; ++i) {
+        SD_CHECK(queue.TryPop(item) && item == i);
+        SD_CHECK(queue.TryPush(i + 8));
+    }
+
+    // Batches stop at the first full or empty cell.
+    int items[MAX_BATCH];
+    SD_CHECK(queue.TryPop(items, 3) == 3);
+    SD_CHECK(items[0] == 1000 && items[2] == 1002);
+    for (int i = 0; i < 4; ++i) {
+        items[i] = -i;
+    }
+    SD_CHECK(queue.TryPush(items, 4) == 3);
+    SD_CHECK(queue.TryPush(items, 4) == 0);
+    SD_CHECK(queue.TryPop(items, MAX_BATCH) == 8);
+    SD_CHECK(items[4] == 1007 && items[5] == 0 && items[7] == -2);
+    SD_CHECK(queue.TryPop(items, MAX_BATCH) == 0);
+    SD_CHECK(queue.GetSize() == 0);
+}
+
+// Items left in the queue are destroyed with it, moved out ones once.
+static void CheckLifetime()
+{
+    static std::atomic<int32_t> s_alive{0};
+    struct Counted {
+        Counted() { ++s_alive; }
+        Counted(const Counted &) { ++s_alive; }
+        Counted(Counted &&) { ++s_alive; }
+        Counted &operator=(const Counted &) = default;
+        Counted &operator=(Counted &&) = default;
+        ~Counted() { --s_alive; }
+    };
+    {
+        MPMCQueue<Counted> queue(16);
+        for (int i = 0; i < 10; ++i) {
+            queue.TryPush(Counted());
+        }
+        Counted item;
+        queue.TryPop(item);
+        SD_CHECK(s_alive == 10);
+    }
+    SD_CHECK(s_alive == 0);
+}
+
+// Each producer pushes its sequence in order. Every item comes out exactly
+// once, and each consumer sees the items of a producer in order.
+static void CheckStress(uint32_t producers, uint32_t consumers, Mode mode,
+                        size_t capacity, uint32_t per_producer)
+{
+    MPMCQueue<uint64_t> queue(capacity);
+    const uint32_t total = producers * per_producer;
+    std::vector<std::vector<uint64_t>> received(consumers);
+    std::atomic<uint32_t> popped{0};
+    std::vector<std::thread> threads;
+
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            uint64_t items[MAX_BATCH];
+            uint32_t sequence = 0;
+            while (sequence < per_producer) {
+                if (mode == Mode::BLOCKING) {
+                    queue.Push(MakeItem(p, sequence++));
+                    continue;
+                }
+                const size_t count =
+                    mode == Mode::BATCH
+                        ? std::min<size_t>(1 + sequence % MAX_BATCH,
+                                           per_producer - sequence)
+                        : 1;
+                for (size_t i = 0; i < count; ++i) {
+                    items[i] = MakeItem(p, sequence + i);
+                }
+                const size_t pushed = mode == Mode::BATCH
+                                          ? queue.TryPush(items, count)
+                                          : queue.TryPush(items[0]);
+                sequence += pushed;
+                if (pushed == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (uint32_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            std::vector<uint64_t> &out = received[c];
+            uint64_t items[MAX_BATCH];
+            if (mode == Mode::BLOCKING) {
+                // Pop blocks, so split the total exactly.
+                const uint32_t count =
+                    total / consumers + (c < total % consumers ? 1 : 0);
+                for (uint32_t i = 0; i < count; ++i) {
+                    out.push_back(queue.Pop());
+                }
+                return;
+            }
+            while (popped.load(std::memory_order_relaxed) < total) {
+                const size_t count =
+                    mode == Mode::BATCH
+                        ? queue.TryPop(items, 1 + out.size() % MAX_BATCH)
+                        : queue.TryPop(items[0]);
+                out.insert(out.end(), items, items + count);
+                popped.fetch_add(count, std::memory_order_relaxed);
+                if (count == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::vector<uint32_t> seen(total, 0);
+    bool ordered = true;
+    for (const auto &out : received) {
+        std::vector<int64_t> last(producers, -1);
+        for (uint64_t item : out) {
+            const uint32_t producer = item >> 32;
+            const uint32_t sequence = item & 0xffffffff;
+            if (producer >= producers || sequence >= per_producer) {
+                ordered = false;
+                continue;
+            }
+            ordered &= sequence > last[producer];
+            last[producer] = sequence;
+            ++seen[producer * per_producer + sequence];
+        }
+    }
+    SD_CHECK(ordered);
+    SD_CHECK(std::all_of(seen.begin(), seen.end(),
+                         [](uint32_t count) { return count == 1; }));
+    SD_CHECK(queue.GetSize() == 0);
+}
+
+// A Pop on an empty queue and a Push on a full one sleep past their spins,
+// and wake up on the other side's change.
+static void CheckWakeUp()
+{
+    using namespace std::chrono_literals;
+    MPMCQueue<int> queue(2);
+    std::atomic<bool> done{false};
+    int item = 0;
+    std::thread consumer([&] {
+        item = queue.Pop();
+        done = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    SD_CHECK(!done);
+    queue.Push(42);
+    consumer.join();
+    SD_CHECK(done && item == 42);
+
+    done = false;
+    queue.Push(1);
+    queue.Push(2);
+    std::thread producer([&] {
+        queue.Push(3);
+        done = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    SD_CHECK(!done);
+    SD_CHECK(queue.TryPop(item) && item == 1);
+    producer.join();
+    SD_CHECK(done);
+    SD_CHECK(queue.Pop() == 2 && queue.Pop() == 3);
+
+    // Several sleepers at once, all woken by pushes of other threads.
+    const uint32_t sleepers = 8;
+    std::atomic<int32_t> sum{0};
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < sleepers; ++i) {
+        threads.emplace_back([&] { sum += queue.Pop(); });
+    }
+    std::this_thread::sleep_for(50ms);
+    for (uint32_t i = 0; i < sleepers; ++i) {
+        threads.emplace_back([&, i] { queue.Push(static_cast<int>(i)); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    SD_CHECK(sum == static_cast<int32_t>(sleepers * (sleepers - 1) / 2));
+}
+
+int main()
+{
+    CheckBasics();
+    CheckLifetime();
+    CheckWakeUp();
+    const uint32_t counts[] = {1, 2, 4, 8, 16, 32};
+    for (Mode mode : {Mode::SINGLE, Mode::BATCH, Mode::BLOCKING}) {
+        for (uint32_t producers : counts) {
+            for (uint32_t consumers : counts) {
+                // Small queues keep both the full and the empty paths busy.
+                CheckStress(producers, consumers, mode, 64,
+                            64000 / producers);
+            }
+        }
+        CheckStress(4, 4, mode, 2, 10000);
+    }
+    return SD_TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+#include "Test.hpp"
+#include "Utility/Metrics.hpp"
+
+#include <cmath>
+
+using namespace SD;
+
+// Half a bucket of 8 per octave, the most a percentile can be off by.
+static const double BUCKET_ERROR = std::exp2(1.0 / 16) - 1;
+
+static bool IsNear(double value, double expected)
+{
+    return std::abs(value - expected) <= expected * BUCKET_ERROR;
+}
+
+static void CheckPercentiles()
+{
+    Histogram histogram(1e-2, 1e4);
+    SD_CHECK(histogram.GetCount() == 0);
+    SD_CHECK(histogram.GetPercentile(0.5) == 0);
+
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.Record(i);
+    }
+    SD_CHECK(histogram.GetCount() == 1000);
+    SD_CHECK(histogram.GetMean() == 500.5);
+    SD_CHECK(histogram.GetMin() == 1 && histogram.GetMax() == 1000);
+    SD_CHECK(IsNear(histogram.GetPercentile(0.5), 500));
+    SD_CHECK(IsNear(histogram.GetPercentile(0.95), 950));
+    SD_CHECK(IsNear(histogram.GetPercentile(0.99), 990));
+    // The ends are clamped to the values recorded.
+    SD_CHECK(IsNear(histogram.GetPercentile(0), 1));
+    SD_CHECK(histogram.GetPercentile(0) >= 1);
+    SD_CHECK(histogram.GetPercentile(1) <= 1000);
+
+    // A single value is exact, also out of the range.
+    histogram.Reset();
+    SD_CHECK(histogram.GetCount() == 0);
+    histogram.Record(7);
+    SD_CHECK(histogram.GetPercentile(0.5) == 7);
+    histogram.Reset();
+    histogram.Record(1e6);
+    SD_CHECK(histogram.GetPercentile(0.99) == 1e6);
+
+    // Values up to the minimum report the smallest one.
+    histogram.Reset();
+    for (int i = 0; i < 90; ++i) {
+        histogram.Record(0);
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.Record(50);
+    }
+    SD_CHECK(histogram.GetPercentile(0.5) == 0);
+    SD_CHECK(histogram.GetPercentile(0.9) == 0);
+    SD_CHECK(IsNear(histogram.GetPercentile(0.95), 50));
+    SD_CHECK(histogram.GetPercentile(0.99) <= 50);
+}
+
+// A counter left at 0 on most frames has its low percentiles at 0.
+static void CheckCounter()
+{
+    Metrics::SetWindow(1000);
+    const Metrics::Id culled = Metrics::RegisterCounter("test.culled");
+    SD_CHECK(Metrics::RegisterCounter("test.culled") == culled);
+    for (int frame = 0; frame < 100; ++frame) {
+        if (frame % 10 == 0) {
+            Metrics::Add(culled, 3);
+            Metrics::Add(culled);
+        }
+        Metrics::EndFrame();
+    }
+    const Metric &metric = Metrics::GetMetrics()[culled];
+    SD_CHECK(metric.value == 0);
+    SD_CHECK(metric.histogram.GetCount() == 100);
+    SD_CHECK(metric.histogram.GetMean() == 0.4);
+    SD_CHECK(metric.histogram.GetPercentile(0.5) == 0);
+    SD_CHECK(metric.histogram.GetPercentile(0.9) == 0);
+    SD_CHECK(IsNear(metric.histogram.GetPercentile(0.95), 4));
+    SD_CHECK(metric.histogram.GetMax() == 4);
+}
+
+int main()
+{
+    CheckPercentiles();
+    CheckCounter();
+    return SD_TEST_RESULT();
+}
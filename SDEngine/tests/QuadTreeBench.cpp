@@ -0,0 +1,135 @@
+#include "Utility/QuadTree.hpp"
+#include "Utility/Random.hpp"
+#include "Utility/Timing.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace SD;
+
+static const Rect WORLD(0, 0, 10000, 10000);
+static const uint32_t QUERY_COUNT = 1000;
+// The linear scans are slow on the large sets, time fewer of them.
+static const uint32_t LINEAR_QUERY_COUNT = 100;
+static const uint32_t NEAREST_K = 8;
+
+static Rect RandomRect(float max_size)
+{
+    const float width = Random::Rnd(0.f, max_size);
+    const float height = Random::Rnd(0.f, max_size);
+    return Rect(Random::Rnd(WORLD.x, WORLD.x + WORLD.width - width),
+                Random::Rnd(WORLD.y, WORLD.y + WORLD.height - height), width,
+                height);
+}
+
+static Vector2f RandomPoint()
+{
+    return Vector2f(Random::Rnd(WORLD.x, WORLD.x + WORLD.width),
+                    Random::Rnd(WORLD.y, WORLD.y + WORLD.height));
+}
+
+static float DistanceSquared(const Rect &rect, const Vector2f &point)
+{
+    const float dx =
+        std::max({rect.x - point.x, 0.f, point.x - (rect.x + rect.width)});
+    const float dy =
+        std::max({rect.y - point.y, 0.f, point.y - (rect.y + rect.height)});
+    return dx * dx + dy * dy;
+}
+
+static void Run(uint32_t count)
+{
+    Random::Init(count);
+    std::vector<Collidable> objects(count);
+    for (Collidable &obj : objects) {
+        obj.bound = RandomRect(20);
+    }
+    QuadTree tree(WORLD, 16, 10);
+    std::vector<Collidable *> result;
+    size_t found = 0;
+
+    Clock clock;
+    for (Collidable &obj : objects) {
+        tree.Insert(&obj);
+    }
+    const float insert_ms = clock.Restart();
+
+    for (uint32_t i = 0; i < QUERY_COUNT; ++i) {
+        tree.QueryRange(RandomRect(200), result);
+        found += result.size();
+    }
+    const float range_ms = clock.Restart();
+    for (uint32_t i = 0; i < LINEAR_QUERY_COUNT; ++i) {
+        const Rect range = RandomRect(200);
+        result.clear();
+        for (Collidable &obj : objects) {
+            if (obj.bound.Intersects(range)) {
+                result.push_back(&obj);
+            }
+        }
+        found += result.size();
+    }
+    const float linear_range_ms = clock.Restart();
+
+    for (uint32_t i = 0; i < QUERY_COUNT; ++i) {
+        tree.QueryNearest(RandomPoint(), NEAREST_K, result);
+        found += result.size();
+    }
+    const float nearest_ms = clock.Restart();
+    std::vector<float> distances(count);
+    for (uint32_t i = 0; i < LINEAR_QUERY_COUNT; ++i) {
+        const Vector2f point = RandomPoint();
+        for (uint32_t j = 0; j < count; ++j) {
+            distances[j] = DistanceSquared(objects[j].bound, point);
+        }
+        std::nth_element(distances.begin(), distances.begin() + NEAREST_K,
+                         distances.end());
+        found += NEAREST_K;
+    }
+    const float linear_nearest_ms = clock.Restart();
+
+    // Most objects take a small step, one in ten jumps anywhere.
+    for (Collidable &obj : objects) {
+        if (Random::Rnd(0, 10) == 0) {
+            obj.bound = RandomRect(20);
+        }
+        else {
+            obj.bound.x = std::clamp(obj.bound.x + Random::Rnd(-5.f, 5.f),
+                                     WORLD.x,
+                                     WORLD.x + WORLD.width - obj.bound.width);
+            obj.bound.y = std::clamp(obj.bound.y + Random::Rnd(-5.f, 5.f),
+                                     WORLD.y,
+                                     WORLD.y + WORLD.height - obj.bound.height);
+        }
+    }
+    clock.Restart();
+    for (Collidable &obj : objects) {
+        tree.Update(&obj);
+    }
+    const float update_ms = clock.Restart();
+    tree.Clear();
+    for (Collidable &obj : objects) {
+        tree.Insert(&obj);
+    }
+    const float rebuild_ms = clock.Restart();
+
+    const float us = 1000.f;
+    std::printf(
+        "%8u objects: insert %8.2f ms | range %8.2f us/query (linear %9.2f) "
+        "| nearest %8.2f us/query (linear %9.2f) | update %8.2f ms "
+        "(rebuild %8.2f) [%zu]\n",
+        count, insert_ms, range_ms * us / QUERY_COUNT,
+        linear_range_ms * us / LINEAR_QUERY_COUNT,
+        nearest_ms * us / QUERY_COUNT,
+        linear_nearest_ms * us / LINEAR_QUERY_COUNT, update_ms, rebuild_ms,
+        found);
+}
+
+int main()
+{
+    for (uint32_t count : {10000u, 100000u, 1000000u}) {
+        Run(count);
+    }
+    return 0;
+}
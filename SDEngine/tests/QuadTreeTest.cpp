@@ -0,0 +1,148 @@
+#include "Test.hpp"
+#include "Utility/QuadTree.hpp"
+#include "Utility/Random.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace SD;
+
+static const Rect WORLD(0, 0, 1000, 1000);
+static const uint32_t OBJECT_COUNT = 5000;
+static const uint32_t QUERY_COUNT = 200;
+
+static Rect RandomRect(float max_size)
+{
+    const float width = Random::Rnd(0.f, max_size);
+    const float height = Random::Rnd(0.f, max_size);
+    return Rect(Random::Rnd(WORLD.x, WORLD.x + WORLD.width - width),
+                Random::Rnd(WORLD.y, WORLD.y + WORLD.height - height), width,
+                height);
+}
+
+static float DistanceSquared(const Rect &rect, const Vector2f &point)
+{
+    const float dx =
+        std::max({rect.x - point.x, 0.f, point.x - (rect.x + rect.width)});
+    const float dy =
+        std::max({rect.y - point.y, 0.f, point.y - (rect.y + rect.height)});
+    return dx * dx + dy * dy;
+}
+
+static void CheckRange(const QuadTree &tree,
+                       const std::vector<Collidable *> &objects)
+{
+    std::vector<Collidable *> result;
+    for (uint32_t i = 0; i < QUERY_COUNT; ++i) {
+        const Rect range = RandomRect(100);
+        tree.QueryRange(range, result);
+
+        std::vector<Collidable *> expected;
+        for (Collidable *obj : objects) {
+            if (obj->bound.Intersects(range)) {
+                expected.push_back(obj);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(result.begin(), result.end());
+        SD_CHECK(result == expected);
+    }
+}
+
+static void CheckNearest(const QuadTree &tree,
+                         const std::vector<Collidable *> &objects, uint32_t k)
+{
+    std::vector<Collidable *> result;
+    std::vector<float> expected(objects.size());
+    for (uint32_t i = 0; i < QUERY_COUNT; ++i) {
+        const Vector2f point(Random::Rnd(WORLD.x, WORLD.x + WORLD.width),
+                             Random::Rnd(WORLD.y, WORLD.y + WORLD.height));
+        tree.QueryNearest(point, k, result);
+
+        // Objects at the same distance can come in any order, compare the
+        // distances only.
+        for (size_t j = 0; j < objects.size(); ++j) {
+            expected[j] = DistanceSquared(objects[j]->bound, point);
+        }
+        std::sort(expected.begin(), expected.end());
+        SD_CHECK(result.size() == std::min<size_t>(k, objects.size()));
+        for (size_t j = 0; j < result.size(); ++j) {
+            SD_CHECK(DistanceSquared(result[j]->bound, point) == expected[j]);
+        }
+    }
+}
+
+int main()
+{
+    Random::Init(42);
+    std::vector<Collidable> storage(OBJECT_COUNT);
+    QuadTree tree(WORLD, 8, 8);
+    std::vector<Collidable *> objects;
+    for (Collidable &obj : storage) {
+        obj.bound = RandomRect(20);
+        SD_CHECK(tree.Insert(&obj));
+        SD_CHECK(!tree.Insert(&obj));
+        objects.push_back(&obj);
+    }
+    SD_CHECK(tree.Size() == OBJECT_COUNT);
+    SD_CHECK(!tree.IsLeaf());
+    CheckRange(tree, objects);
+    CheckNearest(tree, objects, 1);
+    CheckNearest(tree, objects, 16);
+
+    // Move every object, small steps and jumps across the world.
+    for (uint32_t step = 0; step < 4; ++step) {
+        for (Collidable *obj : objects) {
+            if (Random::Rnd(0, 10) == 0) {
+                obj->bound = RandomRect(20);
+            }
+            else {
+                const float max_x = WORLD.x + WORLD.width - obj->bound.width;
+                const float max_y = WORLD.y + WORLD.height - obj->bound.height;
+                obj->bound.x = std::clamp(
+                    obj->bound.x + Random::Rnd(-5.f, 5.f), WORLD.x, max_x);
+                obj->bound.y = std::clamp(
+                    obj->bound.y + Random::Rnd(-5.f, 5.f), WORLD.y, max_y);
+            }
+            SD_CHECK(tree.Update(obj));
+        }
+        SD_CHECK(tree.Size() == OBJECT_COUNT);
+        CheckRange(tree, objects);
+        CheckNearest(tree, objects, 8);
+    }
+
+    // Remove half, the freed nodes and elements are then reused.
+    for (uint32_t i = 0; i < OBJECT_COUNT; i += 2) {
+        SD_CHECK(tree.Remove(objects[i]));
+        SD_CHECK(!tree.Remove(objects[i]));
+        SD_CHECK(!tree.Update(objects[i]));
+    }
+    std::vector<Collidable *> rest;
+    for (uint32_t i = 1; i < OBJECT_COUNT; i += 2) {
+        rest.push_back(objects[i]);
+    }
+    SD_CHECK(tree.Size() == rest.size());
+    CheckRange(tree, rest);
+    CheckNearest(tree, rest, 4);
+
+    for (uint32_t i = 0; i < OBJECT_COUNT; i += 2) {
+        objects[i]->bound = RandomRect(20);
+        SD_CHECK(tree.Insert(objects[i]));
+    }
+    CheckRange(tree, objects);
+
+    for (Collidable *obj : objects) {
+        SD_CHECK(tree.Remove(obj));
+    }
+    SD_CHECK(tree.Size() == 0);
+    SD_CHECK(tree.IsLeaf());
+
+    for (Collidable *obj : objects) {
+        tree.Insert(obj);
+    }
+    tree.Clear();
+    SD_CHECK(tree.Size() == 0);
+    SD_CHECK(tree.IsLeaf());
+    SD_CHECK(tree.Insert(objects.front()));
+    return SD_TEST_RESULT();
+}
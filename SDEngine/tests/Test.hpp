@@ -0,0 +1,25 @@
+#ifndef SD_TEST_HPP
+#define SD_TEST_HPP
+
+#include <cstdio>
+
+namespace SD {
+
+// Failed checks of the test executable, returned by main.
+inline int s_test_failures = 0;
+
+}  // namespace SD
+
+// Print the check if it fails and go on, so one run reports every failure.
+#define SD_CHECK(check)                                                  \
+    {                                                                    \
+        if (!(check)) {                                                  \
+            std::fprintf(stderr, "%s:%d: check '%s' failed\n", __FILE__, \
+                         __LINE__, #check);                              \
+            ++::SD::s_test_failures;                                     \
+        }                                                                \
+    }
+
+#define SD_TEST_RESULT() (::SD::s_test_failures > 0 ? 1 : 0)
+
+#endif /* SD_TEST_HPP */
@@ -0,0 +1,84 @@
+#version 450 core
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// Build mip levels 1 to 6 of the bloom downsample chain from level 0 in one
+// dispatch. A workgroup reduces a 64x64 tile of level 0 down to one texel
+// of level 6, so no workgroup waits on another.
+
+layout(rgba16f) readonly uniform image2D u_mip0;
+layout(rgba16f) writeonly uniform image2D u_mip1;
+layout(rgba16f) writeonly uniform image2D u_mip2;
+layout(rgba16f) writeonly uniform image2D u_mip3;
+layout(rgba16f) writeonly uniform image2D u_mip4;
+layout(rgba16f) writeonly uniform image2D u_mip5;
+layout(rgba16f) writeonly uniform image2D u_mip6;
+
+// Mip levels of the chain, the levels past it are not written.
+uniform int u_levels;
+
+shared vec4 s_tile[16][16];
+
+vec4 Load(ivec2 pos)
+{
+    return imageLoad(u_mip0, min(pos, imageSize(u_mip0) - 1));
+}
+
+void Store(int level, ivec2 pos, vec4 value)
+{
+    if (level >= u_levels) {
+        return;
+    }
+    switch (level) {
+        case 1: imageStore(u_mip1, pos, value); break;
+        case 2: imageStore(u_mip2, pos, value); break;
+        case 3: imageStore(u_mip3, pos, value); break;
+        case 4: imageStore(u_mip4, pos, value); break;
+        case 5: imageStore(u_mip5, pos, value); break;
+        case 6: imageStore(u_mip6, pos, value); break;
+    }
+}
+
+void main()
+{
+    ivec2 tile = ivec2(gl_WorkGroupID.xy) * 64;
+    ivec2 id = ivec2(gl_LocalInvocationID.xy);
+
+    // Each invocation reduces a 4x4 block of level 0 to a 2x2 block of
+    // level 1 and one texel of level 2.
+    vec4 sum = vec4(0);
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            ivec2 pos = (tile >> 1) + id * 2 + ivec2(x, y);
+            ivec2 src = pos * 2;
+            vec4 value = (Load(src) + Load(src + ivec2(1, 0)) +
+                          Load(src + ivec2(0, 1)) + Load(src + ivec2(1, 1))) *
+                         0.25;
+            Store(1, pos, value);
+            sum += value;
+        }
+    }
+    sum *= 0.25;
+    Store(2, (tile >> 2) + id, sum);
+    s_tile[id.y][id.x] = sum;
+    barrier();
+
+    // The rest in shared memory, a quarter of the invocations each level.
+    int size = 8;
+    for (int level = 3; level <= 6; ++level) {
+        bool active = id.x < size && id.y < size;
+        vec4 value;
+        if (active) {
+            ivec2 src = id * 2;
+            value = (s_tile[src.y][src.x] + s_tile[src.y][src.x + 1] +
+                     s_tile[src.y + 1][src.x] + s_tile[src.y + 1][src.x + 1]) *
+                    0.25;
+        }
+        barrier();
+        if (active) {
+            s_tile[id.y][id.x] = value;
+            Store(level, (tile >> level) + id, value);
+        }
+        barrier();
+        size >>= 1;
+    }
+}
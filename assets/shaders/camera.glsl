@@ -2,4 +2,8 @@ layout(std140) uniform Camera
 {
     mat4 u_projection;
     mat4 u_view;
+    mat4 u_inv_view_projection;
+    // Render size over texture size, the frame covers the bottom left of
+    // its textures. Screen uv times this is texture uv.
+    vec2 u_render_scale;
 };
@@ -0,0 +1,36 @@
+// see LightCluster and ClusterLightData in DeferredRenderPass.cpp
+struct ClusterLight {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    // constant, linear, quadratic
+    vec4 attenuation;
+};
+
+layout(std430) readonly buffer ClusterLights { ClusterLight u_cluster_lights[]; };
+// offset and count in u_cluster_indices
+layout(std430) readonly buffer ClusterGrid { uvec2 u_clusters[]; };
+layout(std430) readonly buffer ClusterIndices { uint u_cluster_indices[]; };
+
+uniform int u_cluster_size[3];
+uniform float u_cluster_near_z;
+uniform float u_cluster_far_z;
+uniform bool u_cluster_perspective;
+
+uint GetClusterIndex(vec2 uv, float depth)
+{
+    float t = 0;
+    if (u_cluster_perspective) {
+        t = log(depth / u_cluster_near_z) /
+            log(u_cluster_far_z / u_cluster_near_z);
+    }
+    else {
+        t = (depth - u_cluster_near_z) / (u_cluster_far_z - u_cluster_near_z);
+    }
+    const ivec3 size = ivec3(u_cluster_size[0], u_cluster_size[1],
+                             u_cluster_size[2]);
+    const ivec3 cluster =
+        clamp(ivec3(vec3(uv, t) * vec3(size)), ivec3(0), size - 1);
+    return (cluster.z * size.y + cluster.y) * size.x + cluster.x;
+}
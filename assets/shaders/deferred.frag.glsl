@@ -1,8 +1,10 @@
 #version 450 core
 
 #include camera.glsl
+#include gbuffer.glsl
 #include light.glsl
 #include shadow.glsl
+#include cluster.glsl
 
 layout(location = 0) out vec3 frag_color;
 
@@ -11,15 +13,17 @@ layout(location = 0) in vec2 in_uv;
 uniform LightColor u_light_color;
 uniform PointLight u_point_light;
 uniform bool u_is_directional;
+// shade all the point lights of the fragment's cluster
+uniform bool u_is_clustered;
 uniform vec3 u_light_front;
 
 uniform bool u_is_cast_shadow;
 
 uniform sampler2DMS u_lighting;
-uniform sampler2DMS u_position;
+uniform sampler2DMS u_depth;
 uniform sampler2DMS u_normal;
 uniform sampler2DMS u_albedo;
-uniform sampler2DMS u_ambient;
+uniform usampler2DMS u_ambient_emissive;
 uniform sampler2DMS u_background;
 uniform sampler2D u_ssao;
 uniform bool u_ssao_state;
@@ -27,24 +31,48 @@ uniform bool u_ssao_state;
 void main()
 {
     vec3 color = vec3(0);
-    const int samples = textureSamples(u_position);
-    const float ambient_occlusion = u_ssao_state ? texture(u_ssao, in_uv).r : 1;
+    const int samples = textureSamples(u_depth);
+    const float ambient_occlusion =
+        u_ssao_state ? texture(u_ssao, in_uv * u_render_scale).r : 1;
 
-    const ivec2 uv = ivec2(in_uv * textureSize(u_position));
+    // The quad covers the viewport, the texels are fetched by pixel.
+    const ivec2 uv = ivec2(gl_FragCoord.xy);
+    const vec2 pixel_uv =
+        gl_FragCoord.xy / (textureSize(u_depth) * u_render_scale);
 
     for (int i = 0; i < samples; ++i) {
-        vec3 normal = texelFetch(u_normal, uv, i).rgb;
-        if (normal != vec3(0)) {
+        const float depth = texelFetch(u_depth, uv, i).r;
+        if (!IsBackground(depth)) {
             // Fragment is not a background,
             // calculate the lighting result
-            const vec3 pos = texelFetch(u_position, uv, i).rgb;
+            const vec3 pos = GetWorldPosition(pixel_uv, depth);
+            const vec3 normal = DecodeNormal(texelFetch(u_normal, uv, i).rg);
             const vec3 last = texelFetch(u_lighting, uv, i).rgb;
             const vec4 albedo = texelFetch(u_albedo, uv, i);
             const vec3 ambient =
-                texelFetch(u_ambient, uv, i).rgb * ambient_occlusion;
+                UnpackAmbient(texelFetch(u_ambient_emissive, uv, i).r) *
+                ambient_occlusion;
             const vec3 view_dir = normalize(u_view[3].xyz - pos);
             vec3 result = vec3(0);
-            if (u_is_directional) {
+            if (u_is_clustered) {
+                const float view_depth = -(u_view * vec4(pos, 1.0f)).z;
+                const uvec2 cluster =
+                    u_clusters[GetClusterIndex(in_uv, view_depth)];
+                for (uint j = 0; j < cluster.y; ++j) {
+                    const ClusterLight light =
+                        u_cluster_lights[u_cluster_indices[cluster.x + j]];
+                    const PointLight point_light =
+                        PointLight(light.position.xyz, light.attenuation.x,
+                                   light.attenuation.y, light.attenuation.z);
+                    const LightColor light_color =
+                        LightColor(light.ambient.rgb, light.diffuse.rgb,
+                                   light.specular.rgb);
+                    result += CalcPointLight(point_light, light_color, pos,
+                                             normal, view_dir, ambient, albedo,
+                                             0.f);
+                }
+            }
+            else if (u_is_directional) {
                 // DirectionalLight
                 float shadow = 0.f;
                 const vec3 light_dir = normalize(-u_light_front);
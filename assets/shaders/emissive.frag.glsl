@@ -1,21 +1,24 @@
 #version 450 core
 
+#include camera.glsl
+#include gbuffer.glsl
+
 layout(location = 0) out vec4 frag_color;
 
 layout(location = 0) in vec2 in_uv;
 
 uniform sampler2DMS u_lighting;
-uniform sampler2DMS u_emissive;
+uniform usampler2DMS u_ambient_emissive;
 
 void main()
 {
     vec3 color = vec3(0);
 
     const int samples = textureSamples(u_lighting);
-    const ivec2 uv = ivec2(in_uv * textureSize(u_lighting));
+    const ivec2 uv = ivec2(gl_FragCoord.xy);
     for (int i = 0; i < samples; ++i) {
         color += texelFetch(u_lighting, uv, i).rgb;
-        color += texelFetch(u_emissive, uv, i).rgb;
+        color += UnpackEmissive(texelFetch(u_ambient_emissive, uv, i).r);
     }
     frag_color = vec4(color / samples, 1.0f);
 }
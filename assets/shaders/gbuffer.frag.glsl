@@ -1,6 +1,8 @@
 #version 450 core
 
+#include camera.glsl
 #include material.glsl
+#include gbuffer.glsl
 
 struct VertexOutput {
     vec3 position;
@@ -11,35 +13,39 @@ struct VertexOutput {
 };
 
 uniform Material u_material;
-uniform uint u_entity_id;
 
-layout(location = 0) out vec3 g_position;
-layout(location = 1) out vec3 g_normal;
-layout(location = 2) out vec4 g_albedo;
-layout(location = 3) out vec3 g_ambient;
-layout(location = 4) out vec3 g_emissive;
-layout(location = 5) out uint g_entity_id;
+layout(location = 0) out vec2 g_normal;
+layout(location = 1) out vec4 g_albedo;
+layout(location = 2) out uint g_ambient_emissive;
+// Dropped when the attachment is detached.
+layout(location = 3) out uint g_entity_id;
 
 layout(location = 0) in VertexOutput in_vertex;
+layout(location = 5) flat in uint in_entity_id;
+layout(location = 6) flat in uint in_material_index;
 
 void main()
 {
-    g_position = in_vertex.position;
-    g_normal = normalize(in_vertex.normal);
+    vec3 normal = normalize(in_vertex.normal);
     const vec3 normal_map = texture(u_material.normal, in_vertex.uv).rgb;
     if (normal_map != vec3(0)) {
         vec3 tangent = normalize(in_vertex.tangent);
-        tangent = normalize(tangent - dot(tangent, g_normal) * g_normal);
+        tangent = normalize(tangent - dot(tangent, normal) * normal);
         vec3 bi_tangent = normalize(in_vertex.bi_tangent);
-        mat3 tbn = mat3(tangent, bi_tangent, g_normal);
+        mat3 tbn = mat3(tangent, bi_tangent, normal);
         const vec3 height = normalize(normal_map * 2.0f - 1.0f);
-        g_normal = tbn * height;
+        normal = normalize(tbn * height);
     }
+    g_normal = EncodeNormal(normal);
 
-    g_albedo.rgb = texture(u_material.diffuse, in_vertex.uv).rgb * u_material.diffuse_color;
+    const MaterialColor color = u_material_colors[in_material_index];
+    g_albedo.rgb = texture(u_material.diffuse, in_vertex.uv).rgb * color.diffuse.rgb;
     g_albedo.a = texture(u_material.specular, in_vertex.uv).r;
-    g_ambient = texture(u_material.ambient, in_vertex.uv).rgb * u_material.ambient_color;
-    g_emissive = texture(u_material.emissive, in_vertex.uv).rgb + u_material.emissive_color;
+    const vec3 ambient =
+        texture(u_material.ambient, in_vertex.uv).rgb * color.ambient.rgb;
+    const vec3 emissive =
+        texture(u_material.emissive, in_vertex.uv).rgb + color.emissive.rgb;
+    g_ambient_emissive = PackAmbientEmissive(ambient, emissive);
 
-    g_entity_id = u_entity_id;
+    g_entity_id = in_entity_id;
 }
@@ -0,0 +1,54 @@
+// Encoding of the G-buffer, see GeometryBufferType. Positions are rebuilt
+// from the depth buffer, include camera.glsl before this file.
+
+// Octahedral normal, two components in [-1, 1].
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if (n.z < 0) {
+        vec2 signs = vec2(n.x >= 0 ? 1 : -1, n.y >= 0 ? 1 : -1);
+        e = (1.0 - abs(n.yx)) * signs;
+    }
+    return e;
+}
+
+vec3 DecodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+uint PackRGB565(vec3 color)
+{
+    uvec3 q = uvec3(round(clamp(color, 0.0, 1.0) * vec3(31, 63, 31)));
+    return (q.r << 11) | (q.g << 5) | q.b;
+}
+
+vec3 UnpackRGB565(uint value)
+{
+    return vec3((value >> 11) & 31u, (value >> 5) & 63u, value & 31u) /
+           vec3(31, 63, 31);
+}
+
+// Ambient in the high half, emissive in the low half.
+uint PackAmbientEmissive(vec3 ambient, vec3 emissive)
+{
+    return (PackRGB565(ambient) << 16) | PackRGB565(emissive);
+}
+
+vec3 UnpackAmbient(uint value) { return UnpackRGB565(value >> 16); }
+
+vec3 UnpackEmissive(uint value) { return UnpackRGB565(value & 0xffffu); }
+
+// The depth buffer is cleared to 1 where nothing is drawn.
+bool IsBackground(float depth) { return depth >= 1.0; }
+
+vec3 GetWorldPosition(vec2 uv, float depth)
+{
+    vec4 pos = u_inv_view_projection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    return pos.xyz / pos.w;
+}
@@ -1,5 +1,7 @@
 #version 450 core
 
+#include camera.glsl
+
 layout(location = 0) out vec4 frag_color;
 
 layout(location = 0) in vec2 in_tex_coord;
@@ -27,11 +29,12 @@ vec3 ACESToneMapping(vec3 color, float adapted_lum)
 
 void main()
 {
-    vec3 result = texture(u_lighting, in_tex_coord).rgb;
+    vec2 uv = in_tex_coord * u_render_scale;
+    vec3 result = texture(u_lighting, uv).rgb;
 
     // bloom
     if (u_bloom) {
-        result += texture(u_upsample_buffer, in_tex_coord).rgb;
+        result += texture(u_upsample_buffer, uv).rgb;
     }
 
     // hdr
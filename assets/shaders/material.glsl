@@ -4,8 +4,13 @@ struct Material {
     sampler2D ambient;
     sampler2D emissive;
     sampler2D normal;
+};
 
-    vec3 diffuse_color;
-    vec3 ambient_color;
-    vec3 emissive_color;
+struct MaterialColor {
+    vec4 diffuse;
+    vec4 ambient;
+    vec4 emissive;
 };
+
+// see MaterialData and MAX_MATERIAL_COUNT in Renderer3D.hpp
+layout(std140) uniform MaterialData { MaterialColor u_material_colors[256]; };
@@ -7,6 +7,10 @@ layout(location = 1) in vec2 a_uv;
 layout(location = 2) in vec3 a_normal;
 layout(location = 3) in vec3 a_tangent;
 layout(location = 4) in vec3 a_bi_tangent;
+// per instance
+layout(location = 5) in mat4 a_model;
+layout(location = 9) in uint a_entity_id;
+layout(location = 11) in uint a_material_index;
 
 struct VertexOutput {
     vec3 position;
@@ -17,19 +21,21 @@ struct VertexOutput {
 };
 
 layout(location = 0) out VertexOutput out_vertex;
-
-uniform mat4 u_model;
+layout(location = 5) flat out uint out_entity_id;
+layout(location = 6) flat out uint out_material_index;
 
 void main()
 {
-    vec3 fragPos = (u_model * vec4(a_pos, 1.0f)).xyz;
+    vec3 fragPos = (a_model * vec4(a_pos, 1.0f)).xyz;
     gl_Position = u_projection * u_view * vec4(fragPos, 1.0f);
 
-    mat3 normal_matrix = transpose(inverse(mat3(u_model)));
+    mat3 normal_matrix = transpose(inverse(mat3(a_model)));
     out_vertex.position = fragPos;
     out_vertex.normal = normal_matrix * a_normal;
     out_vertex.tangent = normal_matrix * a_tangent;
     out_vertex.bi_tangent = normal_matrix * a_bi_tangent;
 
     out_vertex.uv = a_uv;
+    out_entity_id = a_entity_id;
+    out_material_index = a_material_index;
 }
@@ -3,6 +3,7 @@ layout (triangles) in;
 layout (triangle_strip, max_vertices=18) out;
 
 uniform mat4 u_shadow_matrix[6];
+layout(location = 0) flat in uint in_layer_mask[]; // faces the mesh overlaps
 
 layout(location = 0) out vec4 frag_pos; // frag_pos from GS (output per emitvertex)
 
@@ -10,7 +11,9 @@ void main()
 {
     for(int face = 0; face < 6; ++face)
     {
-        gl_Layer = face; // built-in variable that specifies to which face we render.
+        if ((in_layer_mask[0] & (1u << face)) == 0u) continue;
+
+        gl_ViewportIndex = face; // each face has its own tile of the atlas
         for(int i = 0; i < 3; ++i) // for each triangle's vertices
         {
             frag_pos = gl_in[i].gl_Position;
@@ -5,8 +5,12 @@ layout(triangle_strip, max_vertices = 3) out;
 
 #include shadow.glsl
 
+layout(location = 0) flat in uint in_layer_mask[];
+
 void main()
 {
+    if ((in_layer_mask[0] & (1u << gl_InvocationID)) == 0u) return;
+
     for (int i = 0; i < 3; ++i) {
         gl_Position = u_light_matrix[gl_InvocationID] * gl_in[i].gl_Position;
         gl_Layer = gl_InvocationID;
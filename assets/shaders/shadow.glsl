@@ -49,8 +49,36 @@ float DirShadowCalculation(vec3 light_dir, vec3 frag_pos, vec3 normal, mat4 view
     return shadow;
 }
 
-uniform samplerCube u_point_shadow_map;
+// The cube faces are tiles of a shared 2D atlas.
+uniform sampler2D u_point_shadow_map;
 uniform float u_point_shadow_far_z;
+uniform mat4 u_point_shadow_matrix[6];
+// Atlas region of each face: offset in xy, size in zw, in uv units.
+uniform vec4 u_point_shadow_tiles[6];
+
+// Face of the cube map a direction falls on, in the order of the face
+// matrices.
+int GetCubeFace(vec3 dir)
+{
+    vec3 a = abs(dir);
+    if (a.x >= a.y && a.x >= a.z) return dir.x > 0.0 ? 0 : 1;
+    if (a.y >= a.z) return dir.y > 0.0 ? 2 : 3;
+    return dir.z > 0.0 ? 4 : 5;
+}
+
+float SamplePointShadow(vec3 light_pos, vec3 dir)
+{
+    int face = GetCubeFace(dir);
+    vec4 clip = u_point_shadow_matrix[face] * vec4(light_pos + dir, 1.0);
+    vec2 uv = clip.xy / clip.w * 0.5 + 0.5;
+    vec4 tile = u_point_shadow_tiles[face];
+    // Stay half a texel inside the tile, the neighbours belong to other
+    // faces or lights.
+    vec2 half_texel = 0.5 / vec2(textureSize(u_point_shadow_map, 0));
+    uv = clamp(tile.xy + uv * tile.zw, tile.xy + half_texel,
+               tile.xy + tile.zw - half_texel);
+    return texture(u_point_shadow_map, uv).r;
+}
 
 // array of offset direction for sampling
 vec3 sample_disk[20] = vec3[]
@@ -76,8 +104,8 @@ float CubeShadowCalculation(vec3 frag_pos, vec3 light_pos, vec3 view_pos)
     float disk_r = (1.0 + (view_dist / u_point_shadow_far_z)) / 25.0;
     for(int i = 0; i < samples; ++i)
     {
-        float closest = texture(u_point_shadow_map,
-                                    frag_to_light + sample_disk[i] * disk_r).r;
+        float closest = SamplePointShadow(light_pos,
+                                          frag_to_light + sample_disk[i] * disk_r);
         closest *= u_point_shadow_far_z;   // undo mapping [0;1]
         if(current_depth - bias > closest) 
             shadow += 1.0;
@@ -5,7 +5,16 @@ layout(location = 1) in vec2 a_texCoord;
 layout(location = 2) in vec3 a_normal;
 layout(location = 3) in vec3 a_tangent;
 layout(location = 4) in vec3 a_biTangent;
+// per instance
+layout(location = 5) in mat4 a_model;
+layout(location = 9) in uint a_entity_id;
+layout(location = 10) in uint a_layer_mask;
 
-uniform mat4 u_model;
+// shadow layers the instance overlaps
+layout(location = 0) flat out uint out_layer_mask;
 
-void main() { gl_Position = u_model * vec4(a_pos, 1.0f); }
+void main()
+{
+    gl_Position = a_model * vec4(a_pos, 1.0f);
+    out_layer_mask = a_layer_mask;
+}
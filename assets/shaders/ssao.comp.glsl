@@ -3,9 +3,13 @@ layout(local_size_x = 25, local_size_y = 25) in;
 layout(r16f) uniform image2D u_out_image;
 
 #include camera.glsl
+#include gbuffer.glsl
 
-uniform sampler2D u_position;
+uniform sampler2D u_depth;
 uniform sampler2D u_normal;
+// Level of the inputs, the full resolution G-buffer or the level of the
+// downsampled pyramid matching the output.
+uniform int u_lod = 0;
 
 const uint KERNEL_SIZE = 64;
 uniform uint u_kernel_size = KERNEL_SIZE;
@@ -16,12 +20,16 @@ uniform float u_radius;
 uniform float u_bias;
 uniform uint u_power;
 
+// uv is in screen space, the inputs are sampled at uv * u_render_scale.
 float ComputeOcclusion(vec3 random_vec, vec2 uv)
 {
     // get input for SSAO algorithm
-    vec3 frag_pos = texture(u_position, uv).xyz;
-    vec3 normal = texture(u_normal, uv).xyz;
-    if (normal == vec3(0)) return 1;
+    vec2 texture_uv = uv * u_render_scale;
+    float depth = textureLod(u_depth, texture_uv, u_lod).r;
+    if (IsBackground(depth)) return 1;
+
+    vec3 frag_pos = GetWorldPosition(uv, depth);
+    vec3 normal = DecodeNormal(textureLod(u_normal, texture_uv, u_lod).rg);
 
     frag_pos = (u_view * vec4(frag_pos, 1.0f)).xyz;
     mat3 normal_matrix = transpose(inverse(mat3(u_view)));
@@ -52,11 +60,13 @@ float ComputeOcclusion(vec3 random_vec, vec2 uv)
             continue;
         }
         // get sample depth
-        float sample_depth =
-            (u_view * vec4(texture(u_position, offset.xy).xyz, 1.0f)).z;
-        if ((normal_matrix * texture(u_normal, offset.xy).xyz) == vec3(0)) {
+        float sample_ndc =
+            textureLod(u_depth, offset.xy * u_render_scale, u_lod).r;
+        if (IsBackground(sample_ndc)) {
             continue;
         }
+        vec3 sample_world = GetWorldPosition(offset.xy, sample_ndc);
+        float sample_depth = (u_view * vec4(sample_world, 1.0f)).z;
 
         // range check & accumulate
         float factor = u_radius / abs(frag_pos.z - sample_depth);
@@ -70,12 +80,13 @@ float ComputeOcclusion(vec3 random_vec, vec2 uv)
 void main()
 {
     ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
-    ivec2 size = imageSize(u_out_image);
-    if (pos.x >= size.x || pos.y >= size.y) {
+    // Texels of the output covered by the viewport.
+    vec2 size = imageSize(u_out_image) * u_render_scale;
+    if (pos.x >= ceil(size.x) || pos.y >= ceil(size.y)) {
         return;
     }
     vec2 uv = vec2(pos) / size;
-    vec2 random_scale = vec2(size) / 4.f;
+    vec2 random_scale = size / 4.f;
     vec3 random_vec = normalize(texture(u_noise, uv * random_scale).xyz);
     float occlusion = ComputeOcclusion(random_vec, uv);
     imageStore(u_out_image, pos, vec4(pow(occlusion, u_power)));
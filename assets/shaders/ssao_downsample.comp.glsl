@@ -0,0 +1,37 @@
+#version 450 core
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// One level of the depth and normal pyramid SSAO reads at reduced
+// resolution. Each texel keeps the 2x2 source texel closest to the camera,
+// not their average, so the depth edges stay sharp.
+
+layout(r32f) writeonly uniform image2D u_out_depth;
+layout(rg16f) writeonly uniform image2D u_out_normal;
+
+uniform sampler2D u_depth;
+uniform sampler2D u_normal;
+uniform int u_level;
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(u_out_depth);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+    ivec2 src_size = textureSize(u_depth, u_level);
+    ivec2 nearest = min(pos * 2, src_size - 1);
+    float nearest_depth = texelFetch(u_depth, nearest, u_level).r;
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            ivec2 src = min(pos * 2 + ivec2(x, y), src_size - 1);
+            float depth = texelFetch(u_depth, src, u_level).r;
+            if (depth < nearest_depth) {
+                nearest_depth = depth;
+                nearest = src;
+            }
+        }
+    }
+    imageStore(u_out_depth, pos, vec4(nearest_depth));
+    imageStore(u_out_normal, pos, texelFetch(u_normal, nearest, u_level));
+}
@@ -0,0 +1,78 @@
+#version 450 core
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// Bilateral upsample of the reduced resolution SSAO: the bilinear weights
+// of the four nearest texels are scaled down by their depth and normal
+// difference from the full resolution pixel, so occlusion does not bleed
+// across edges. Both resolutions cover u_render_scale of their textures.
+
+layout(r16f) uniform image2D u_out_image;
+
+#include camera.glsl
+#include gbuffer.glsl
+
+uniform sampler2D u_depth;
+uniform sampler2D u_normal;
+
+uniform sampler2D u_ssao;
+uniform sampler2D u_low_depth;
+uniform sampler2D u_low_normal;
+uniform int u_lod;
+
+float GetViewDepth(vec2 uv, float depth)
+{
+    return (u_view * vec4(GetWorldPosition(uv, depth), 1.0)).z;
+}
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    vec2 size = imageSize(u_out_image) * u_render_scale;
+    if (pos.x >= ceil(size.x) || pos.y >= ceil(size.y)) {
+        return;
+    }
+    vec2 uv = (pos + vec2(0.5)) / size;
+    vec2 texture_uv = uv * u_render_scale;
+    float ndc_depth = texture(u_depth, texture_uv).r;
+    if (IsBackground(ndc_depth)) {
+        imageStore(u_out_image, pos, vec4(1));
+        return;
+    }
+    float depth = GetViewDepth(uv, ndc_depth);
+    vec3 normal = DecodeNormal(texture(u_normal, texture_uv).rg);
+
+    vec2 low_size = textureSize(u_ssao, 0) * u_render_scale;
+    ivec2 low_max = ivec2(ceil(low_size)) - 1;
+    vec2 low_coord = uv * low_size - 0.5;
+    ivec2 base = ivec2(floor(low_coord));
+    vec2 f = low_coord - base;
+    float occlusion = 0;
+    float weight_sum = 0;
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            ivec2 src = clamp(base + ivec2(x, y), ivec2(0), low_max);
+            vec2 src_uv = (src + vec2(0.5)) / low_size;
+            float low_ndc = texelFetch(u_low_depth, src, u_lod).r;
+            float low_depth = GetViewDepth(src_uv, low_ndc);
+            vec3 low_normal =
+                DecodeNormal(texelFetch(u_low_normal, src, u_lod).rg);
+
+            float bilinear =
+                (x == 0 ? 1 - f.x : f.x) * (y == 0 ? 1 - f.y : f.y);
+            float normal_weight = pow(max(dot(normal, low_normal), 0.0), 8.0);
+            float depth_weight = 1.0 / (1e-3 + abs(depth - low_depth));
+            float weight = bilinear * normal_weight * depth_weight;
+            occlusion += texelFetch(u_ssao, src, 0).r * weight;
+            weight_sum += weight;
+        }
+    }
+    // No texel on the same surface, fall back to the nearest one.
+    if (weight_sum < 1e-4) {
+        ivec2 src = clamp(ivec2(uv * low_size), ivec2(0), low_max);
+        occlusion = texelFetch(u_ssao, src, 0).r;
+    }
+    else {
+        occlusion /= weight_sum;
+    }
+    imageStore(u_out_image, pos, vec4(occlusion));
+}